@@ -27,6 +27,81 @@
 #include "canard_internals.h"
 #include <string.h>
 
+/*
+ * Hardware float16 conversion of arrays, if the target has it and the compiler is allowed to use it
+ * (e.g. GCC flag -mf16c on AMD64, -mfpu=neon-fp16 on ARMv7; always available on AArch64).
+ */
+#if !defined(CANARD_USE_FLOAT16_CAST) && defined(__F16C__) && defined(__AVX__)
+# include <immintrin.h>
+# define FLOAT16_SIMD_F16C                          1
+#elif !defined(CANARD_USE_FLOAT16_CAST) && defined(__ARM_NEON) && defined(__ARM_FP) && ((__ARM_FP & 2) != 0)
+# include <arm_neon.h>
+# define FLOAT16_SIMD_NEON                          1
+#endif
+#ifndef FLOAT16_SIMD_F16C
+# define FLOAT16_SIMD_F16C                          0
+#endif
+#ifndef FLOAT16_SIMD_NEON
+# define FLOAT16_SIMD_NEON                          0
+#endif
+
+
+#if CANARD_ENABLE_RX_RING
+# if (CANARD_RX_RING_CAPACITY & (CANARD_RX_RING_CAPACITY - 1U)) != 0 || CANARD_RX_RING_CAPACITY > 32768U
+#  error "CANARD_RX_RING_CAPACITY must be a power of two not greater than 32768"
+# endif
+#endif
+#if CANARD_ENABLE_TX_STAGING
+# if (CANARD_TX_STAGING_CAPACITY & (CANARD_TX_STAGING_CAPACITY - 1U)) != 0 || CANARD_TX_STAGING_CAPACITY > 32768U
+#  error "CANARD_TX_STAGING_CAPACITY must be a power of two not greater than 32768"
+# endif
+# if CANARD_TX_STAGING_MAX_PAYLOAD_SIZE > 65535U
+#  error "CANARD_TX_STAGING_MAX_PAYLOAD_SIZE must fit in uint16_t"
+# endif
+#endif
+#if CANARD_ENABLE_LOCK_FREE_POOL
+# if (CANARD_POOL_MAGAZINE_SIZE % 2U) != 0 || CANARD_POOL_MAGAZINE_SIZE < 2U || CANARD_POOL_MAGAZINE_SIZE > 254U
+#  error "CANARD_POOL_MAGAZINE_SIZE must be an even number from 2 to 254"
+# endif
+#endif
+#if CANARD_ENABLE_RX_RING || CANARD_ENABLE_TX_STAGING || CANARD_ENABLE_LOCK_FREE_POOL
+/// The queue indices are shared between the producers and the consumer with these.
+# ifndef CANARD_ATOMIC_LOAD_ACQUIRE
+#  define CANARD_ATOMIC_LOAD_ACQUIRE(ptr)           __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+# endif
+# ifndef CANARD_ATOMIC_STORE_RELEASE
+#  define CANARD_ATOMIC_STORE_RELEASE(ptr, value)   __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+# endif
+#endif
+#if CANARD_ENABLE_TX_STAGING || CANARD_ENABLE_LOCK_FREE_POOL
+/// Evaluates to true if *ptr was equal to *expected_ptr and has been replaced with desired;
+/// otherwise *expected_ptr is updated with the current value. Spurious failures are allowed.
+# ifndef CANARD_ATOMIC_COMPARE_EXCHANGE
+#  define CANARD_ATOMIC_COMPARE_EXCHANGE(ptr, expected_ptr, desired) \
+    __atomic_compare_exchange_n((ptr), (expected_ptr), (desired), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+# endif
+# ifndef CANARD_ATOMIC_FETCH_ADD
+#  define CANARD_ATOMIC_FETCH_ADD(ptr, value)       __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+# endif
+#endif
+#if CANARD_ENABLE_LOCK_FREE_POOL
+/// Same as CANARD_ATOMIC_COMPARE_EXCHANGE(), but publishes the block links written before it and makes the links
+/// written before the exchange that stored the observed value visible.
+# ifndef CANARD_ATOMIC_COMPARE_EXCHANGE_ACQ_REL
+#  define CANARD_ATOMIC_COMPARE_EXCHANGE_ACQ_REL(ptr, expected_ptr, desired) \
+    __atomic_compare_exchange_n((ptr), (expected_ptr), (desired), true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+# endif
+# ifndef CANARD_ATOMIC_FETCH_SUB
+#  define CANARD_ATOMIC_FETCH_SUB(ptr, value)       __atomic_fetch_sub((ptr), (value), __ATOMIC_RELAXED)
+# endif
+
+/// The free list head keeps the block index plus one in its low half, and the tag in its high half.
+# define LOCK_FREE_INDEX_BITS                       (sizeof(CanardPoolLockFreeHead) * 4U)
+# define LOCK_FREE_HEAD_INDEX(head)                 ((CanardPoolBlockCount)((head) & CANARD_POOL_MAX_BLOCKS))
+# define MAKE_LOCK_FREE_HEAD(previous_head, index)  ((CanardPoolLockFreeHead) \
+    (((((previous_head) >> LOCK_FREE_INDEX_BITS) + 1U) << LOCK_FREE_INDEX_BITS) | (CanardPoolLockFreeHead)(index)))
+#endif
+
 
 #undef MIN
 #undef MAX
@@ -34,8 +109,6 @@
 #define MAX(a, b)   (((a) > (b)) ? (a) : (b))
 
 
-#define TRANSFER_TIMEOUT_USEC                       2000000
-#define IFACE_SWITCH_DELAY_USEC                     1000000
 
 #define TRANSFER_ID_BIT_LEN                         5U
 #define ANON_MSG_DATA_TYPE_ID_BIT_LEN               2U
@@ -48,6 +121,14 @@
 #define MSG_TYPE_FROM_ID(x)                         ((uint16_t)(((x) >> 8U)  & 0xFFFFU))
 #define SRV_TYPE_FROM_ID(x)                         ((uint8_t) (((x) >> 16U) & 0xFFU))
 
+#define SOURCE_ID_MASK                              (0x7FUL << 0U)
+#define SERVICE_NOT_MSG_MASK                        (1UL << 7U)
+#define REQUEST_NOT_RESPONSE_MASK                   (1UL << 15U)
+#define DEST_ID_MASK                                (0x7FUL << 8U)
+#define MSG_TYPE_MASK                               (0xFFFFUL << 8U)
+#define ANON_MSG_TYPE_MASK                          (0x3UL << 8U)
+#define SRV_TYPE_MASK                               (0xFFUL << 16U)
+
 #define MAKE_TRANSFER_DESCRIPTOR(data_type_id, transfer_type, src_node_id, dst_node_id)             \
     (((uint32_t)(data_type_id)) | (((uint32_t)(transfer_type)) << 16U) |                            \
     (((uint32_t)(src_node_id)) << 18U) | (((uint32_t)(dst_node_id)) << 25U))
@@ -65,6 +146,10 @@ struct CanardTxQueueItem
     CanardTxQueueItem* next;
     CanardCANFrame frame;
 };
+CANARD_STATIC_ASSERT(sizeof(CanardTxQueueItem) <= CANARD_MEM_BLOCK_SIZE, "Invalid memory layout");
+#if CANARD_ENABLE_LOCK_FREE_POOL
+CANARD_STATIC_ASSERT(sizeof(CanardPoolLockFreeHead) >= 2U * sizeof(CanardPoolBlockCount), "Invalid free list head");
+#endif
 
 
 /*
@@ -79,14 +164,6 @@ void canardInit(CanardInstance* out_ins,
 {
     CANARD_ASSERT(out_ins != NULL);
 
-    /*
-     * Checking memory layout.
-     * This condition is supposed to be true for all 32-bit and smaller platforms.
-     * If your application fails here, make sure it's not built in 64-bit mode.
-     * Refer to the design documentation for more info.
-     */
-    CANARD_ASSERT(CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE >= 6);
-
     memset(out_ins, 0, sizeof(*out_ins));
 
     out_ins->node_id = CANARD_BROADCAST_NODE_ID;
@@ -98,14 +175,31 @@ void canardInit(CanardInstance* out_ins,
 #if CANARD_ENABLE_TAO_OPTION
     out_ins->tao_disabled = false;
 #endif
-    size_t pool_capacity = mem_arena_size / CANARD_MEM_BLOCK_SIZE;
-    if (pool_capacity > 0xFFFFU)
-    {
-        pool_capacity = 0xFFFFU;
-    }
+#if CANARD_ENABLE_CANFD
+    out_ins->brs_disabled = false;
+#endif
+    out_ins->rx_timeouts.transfer_timeout_usec = CANARD_DEFAULT_TRANSFER_TIMEOUT_USEC;
+    out_ins->rx_timeouts.iface_switch_delay_usec = CANARD_DEFAULT_IFACE_SWITCH_DELAY_USEC;
+    out_ins->get_rx_timeouts = NULL;
+    initPool(&out_ins->allocator, mem_arena, mem_arena_size);
+}
 
-    initPoolAllocator(&out_ins->allocator, mem_arena, (uint16_t)pool_capacity);
+void canardSetRxTimeouts(CanardInstance* ins,
+                         CanardRxTimeouts timeouts,
+                         CanardGetRxTimeouts get_subscription_timeouts)
+{
+    CANARD_ASSERT(ins != NULL);
+    ins->rx_timeouts = timeouts;
+    ins->get_rx_timeouts = get_subscription_timeouts;
+}
+
+#if CANARD_ENABLE_CANFD
+void canardSetCanFdBitRateSwitch(CanardInstance* ins, bool enabled)
+{
+    CANARD_ASSERT(ins != NULL);
+    ins->brs_disabled = !enabled;
 }
+#endif
 
 void* canardGetUserReference(CanardInstance* ins)
 {
@@ -226,8 +320,8 @@ CANARD_INTERNAL uint16_t calculateCRC(const void* payload, uint16_t payload_len,
 #if CANARD_ENABLE_CANFD
         if (payload_len > 63 && canfd) {
             uint8_t empty = 0;
-            uint8_t padding = dlcToDataLength(dataLengthToDlc(((payload_len+2) % 63)+1))-1;
-            padding-=((payload_len+2) % 63);
+            uint8_t padding = (uint8_t)(dlcToDataLength(dataLengthToDlc((uint8_t)(((payload_len+2U) % 63U)+1U)))-1U);
+            padding = (uint8_t)(padding - ((payload_len+2U) % 63U));
             for (uint8_t i=0; i<padding; i++) {
                 crc = crcAddByte(crc, empty);
             }
@@ -301,14 +395,21 @@ const CanardCANFrame* canardPeekTxQueue(const CanardInstance* ins)
     {
         return NULL;
     }
+#if CANARD_ENABLE_SIZE_CLASSES
+    return &ins->tx_head_frame;
+#else
     return &ins->tx_queue->frame;
+#endif
 }
 
 void canardPopTxQueue(CanardInstance* ins)
 {
     CanardTxQueueItem* item = ins->tx_queue;
     ins->tx_queue = item->next;
-    freeBlock(&ins->allocator, item);
+    freePoolBlock(&ins->allocator, CanardPoolCategoryTx, item);
+#if CANARD_ENABLE_SIZE_CLASSES
+    copyTxQueueHead(ins);
+#endif
 }
 
 int16_t canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, uint64_t timestamp_usec)
@@ -351,6 +452,12 @@ int16_t canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, ui
         if (ins->should_accept(ins, &data_type_signature, data_type_id, transfer_type, source_node_id))
         {
             rx_state = traverseRxStates(ins, transfer_descriptor);
+#if CANARD_ENABLE_RX_STATE_EVICTION
+            if ((rx_state == NULL) && evictRxState(ins, priority))
+            {
+                rx_state = traverseRxStates(ins, transfer_descriptor);
+            }
+#endif
 
             if(rx_state == NULL)
             {
@@ -375,13 +482,14 @@ int16_t canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, ui
     CANARD_ASSERT(rx_state != NULL);    // All paths that lead to NULL should be terminated with return above
 
     // Resolving the state flags:
+    const CanardRxTimeouts timeouts = getRxTimeouts(ins, transfer_descriptor);
     const bool not_initialized = rx_state->timestamp_usec == 0;
-    const bool tid_timed_out = (timestamp_usec - rx_state->timestamp_usec) > TRANSFER_TIMEOUT_USEC;
+    const bool tid_timed_out = (timestamp_usec - rx_state->timestamp_usec) > timeouts.transfer_timeout_usec;
     const bool same_iface = frame->iface_id == rx_state->iface_id;
     const bool first_frame = IS_START_OF_TRANSFER(tail_byte);
     const bool not_previous_tid =
         computeTransferIDForwardDistance((uint8_t) rx_state->transfer_id, TRANSFER_ID_FROM_TAIL_BYTE(tail_byte)) > 1;
-    const bool iface_switch_allowed = (timestamp_usec - rx_state->timestamp_usec) > IFACE_SWITCH_DELAY_USEC;
+    const bool iface_switch_allowed = (timestamp_usec - rx_state->timestamp_usec) > timeouts.iface_switch_delay_usec;
     const bool non_wrapped_tid = computeTransferIDForwardDistance(TRANSFER_ID_FROM_TAIL_BYTE(tail_byte), (uint8_t) rx_state->transfer_id) < (1 << (TRANSFER_ID_BIT_LEN-1));
 
     const bool need_restart =
@@ -454,6 +562,9 @@ int16_t canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, ui
 
         // take off the crc and store the payload
         rx_state->timestamp_usec = timestamp_usec;
+#if CANARD_ENABLE_RX_STATE_EVICTION
+        rx_state->priority = priority;
+#endif
         const int16_t ret = bufferBlockPushBytes(&ins->allocator, rx_state, frame->data + 2,
                                                  (uint8_t) (frame->data_len - 3));
         if (ret < 0)
@@ -569,19 +680,45 @@ int16_t canardHandleRxFrame(CanardInstance* ins, const CanardCANFrame* frame, ui
     return CANARD_OK;
 }
 
+uint64_t canardGetNextDeadline(const CanardInstance* ins)
+{
+    CANARD_ASSERT(ins != NULL);
+    uint64_t out = UINT64_MAX;
+    for (const CanardRxState* state = ins->rx_states; state != NULL; state = state->next)
+    {
+        // The state is removed once it was last updated more than the timeout ago
+        const uint64_t expires_at =
+            state->timestamp_usec + getRxTimeouts(ins, state->dtid_tt_snid_dnid).transfer_timeout_usec + 1U;
+        if (expires_at < out)
+        {
+            out = expires_at;
+        }
+    }
+    return out;
+}
+
+#if CANARD_ENABLE_RX_STATE_EVICTION
+CanardRxEvictionStatistics canardGetRxEvictionStatistics(const CanardInstance* ins)
+{
+    CANARD_ASSERT(ins != NULL);
+    return ins->rx_evictions;
+}
+#endif
+
 void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec)
 {
     CanardRxState* prev = ins->rx_states, * state = ins->rx_states;
 
     while (state != NULL)
     {
-        if ((current_time_usec - state->timestamp_usec) > TRANSFER_TIMEOUT_USEC)
+        if ((current_time_usec - state->timestamp_usec) >
+            getRxTimeouts(ins, state->dtid_tt_snid_dnid).transfer_timeout_usec)
         {
             if (state == ins->rx_states)
             {
                 releaseStatePayload(ins, state);
                 ins->rx_states = ins->rx_states->next;
-                freeBlock(&ins->allocator, state);
+                freePoolBlock(&ins->allocator, CanardPoolCategoryRxState, state);
                 state = ins->rx_states;
                 prev = state;
             }
@@ -589,7 +726,7 @@ void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec
             {
                 releaseStatePayload(ins, state);
                 prev->next = state->next;
-                freeBlock(&ins->allocator, state);
+                freePoolBlock(&ins->allocator, CanardPoolCategoryRxState, state);
                 state = prev->next;
             }
         }
@@ -601,6 +738,328 @@ void canardCleanupStaleTransfers(CanardInstance* ins, uint64_t current_time_usec
     }
 }
 
+#if CANARD_ENABLE_RX_RING
+void canardRxRingInit(CanardRxRing* ring)
+{
+    CANARD_ASSERT(ring != NULL);
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overflow_count = 0;
+}
+
+bool canardRxRingPush(CanardRxRing* ring, const CanardCANFrame* frame, uint64_t timestamp_usec)
+{
+    CANARD_ASSERT((ring != NULL) && (frame != NULL));
+
+    // Only the producer writes the head, so it is read without synchronization
+    const uint16_t head = ring->head;
+    if ((uint16_t)(head - CANARD_ATOMIC_LOAD_ACQUIRE(&ring->tail)) >= CANARD_RX_RING_CAPACITY)
+    {
+        CANARD_ATOMIC_STORE_RELEASE(&ring->overflow_count, ring->overflow_count + 1U);
+        return false;
+    }
+
+    CanardRxRingEntry* const entry = &ring->entries[head & (CANARD_RX_RING_CAPACITY - 1U)];
+    entry->frame = *frame;
+    entry->timestamp_usec = timestamp_usec;
+
+    // Publishing the entry; the consumer reads it only after it has seen the new head
+    CANARD_ATOMIC_STORE_RELEASE(&ring->head, (uint16_t)(head + 1U));
+    return true;
+}
+
+bool canardRxRingPop(CanardRxRing* ring, CanardCANFrame* out_frame, uint64_t* out_timestamp_usec)
+{
+    CANARD_ASSERT((ring != NULL) && (out_frame != NULL) && (out_timestamp_usec != NULL));
+
+    const uint16_t tail = ring->tail;
+    if (tail == CANARD_ATOMIC_LOAD_ACQUIRE(&ring->head))
+    {
+        return false;
+    }
+
+    const CanardRxRingEntry* const entry = &ring->entries[tail & (CANARD_RX_RING_CAPACITY - 1U)];
+    *out_frame = entry->frame;
+    *out_timestamp_usec = entry->timestamp_usec;
+
+    // Releasing the entry; the producer overwrites it only after it has seen the new tail
+    CANARD_ATOMIC_STORE_RELEASE(&ring->tail, (uint16_t)(tail + 1U));
+    return true;
+}
+
+uint16_t canardRxRingDrain(CanardRxRing* ring, CanardInstance* ins, uint16_t max_frames)
+{
+    CANARD_ASSERT((ring != NULL) && (ins != NULL));
+
+    // The frames pushed while draining are left for the next call, which bounds the time spent here
+    uint16_t tail = ring->tail;
+    const uint16_t num_available = (uint16_t)(CANARD_ATOMIC_LOAD_ACQUIRE(&ring->head) - tail);
+    const uint16_t num_frames = MIN(num_available, max_frames);
+
+    for (uint16_t i = 0; i < num_frames; i++)
+    {
+        const CanardRxRingEntry* const entry = &ring->entries[tail & (CANARD_RX_RING_CAPACITY - 1U)];
+        (void)canardHandleRxFrame(ins, &entry->frame, entry->timestamp_usec);
+        tail++;
+        CANARD_ATOMIC_STORE_RELEASE(&ring->tail, tail);
+    }
+    return num_frames;
+}
+
+uint32_t canardRxRingGetOverflowCount(const CanardRxRing* ring)
+{
+    CANARD_ASSERT(ring != NULL);
+    return CANARD_ATOMIC_LOAD_ACQUIRE(&ring->overflow_count);
+}
+#endif
+
+#if CANARD_ENABLE_TX_STAGING
+void canardTxStagingInit(CanardTxStaging* staging)
+{
+    CANARD_ASSERT(staging != NULL);
+    staging->enqueue_pos = 0;
+    staging->dequeue_pos = 0;
+    staging->overflow_count = 0;
+    for (uint32_t i = 0; i < CANARD_TX_STAGING_CAPACITY; i++)
+    {
+        staging->slots[i].sequence = i;         // Free, to be filled at enqueue position i
+    }
+}
+
+int16_t canardTxStagingBroadcast(CanardTxStaging* staging,
+                                 uint64_t data_type_signature,
+                                 uint16_t data_type_id,
+                                 uint8_t* inout_transfer_id,
+                                 uint8_t priority,
+                                 const void* payload,
+                                 uint16_t payload_len
+#if CANARD_MULTI_IFACE
+                                 ,uint8_t iface_mask
+#endif
+#if CANARD_ENABLE_CANFD
+                                 ,bool canfd
+#endif
+)
+{
+    CANARD_ASSERT(inout_transfer_id != NULL);
+
+    CanardTxStagingSlot* const slot = acquireTxStagingSlot(staging, payload, payload_len);
+    if (slot == NULL)
+    {
+        return (payload_len > CANARD_TX_STAGING_MAX_PAYLOAD_SIZE) ?
+            -CANARD_ERROR_INVALID_ARGUMENT : -CANARD_ERROR_OUT_OF_MEMORY;
+    }
+
+    slot->data_type_signature = data_type_signature;
+    slot->data_type_id = data_type_id;
+    slot->transfer_id = *inout_transfer_id;
+    slot->priority = priority;
+    slot->destination_node_id = CANARD_BROADCAST_NODE_ID;
+    slot->request_response = (uint8_t) CanardRequest;
+#if CANARD_MULTI_IFACE
+    slot->iface_mask = iface_mask;
+#endif
+#if CANARD_ENABLE_CANFD
+    slot->canfd = canfd;
+#endif
+    commitTxStagingSlot(slot);
+
+    incrementTransferID(inout_transfer_id);
+    return 0;
+}
+
+int16_t canardTxStagingRequestOrRespond(CanardTxStaging* staging,
+                                        uint8_t destination_node_id,
+                                        uint64_t data_type_signature,
+                                        uint8_t data_type_id,
+                                        uint8_t* inout_transfer_id,
+                                        uint8_t priority,
+                                        CanardRequestResponse kind,
+                                        const void* payload,
+                                        uint16_t payload_len
+#if CANARD_MULTI_IFACE
+                                        ,uint8_t iface_mask
+#endif
+#if CANARD_ENABLE_CANFD
+                                        ,bool canfd
+#endif
+)
+{
+    CANARD_ASSERT(inout_transfer_id != NULL);
+
+    if (destination_node_id == CANARD_BROADCAST_NODE_ID)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    CanardTxStagingSlot* const slot = acquireTxStagingSlot(staging, payload, payload_len);
+    if (slot == NULL)
+    {
+        return (payload_len > CANARD_TX_STAGING_MAX_PAYLOAD_SIZE) ?
+            -CANARD_ERROR_INVALID_ARGUMENT : -CANARD_ERROR_OUT_OF_MEMORY;
+    }
+
+    slot->data_type_signature = data_type_signature;
+    slot->data_type_id = data_type_id;
+    slot->transfer_id = *inout_transfer_id;
+    slot->priority = priority;
+    slot->destination_node_id = destination_node_id;
+    slot->request_response = (uint8_t) kind;
+#if CANARD_MULTI_IFACE
+    slot->iface_mask = iface_mask;
+#endif
+#if CANARD_ENABLE_CANFD
+    slot->canfd = canfd;
+#endif
+    commitTxStagingSlot(slot);
+
+    if (kind == CanardRequest)                      // Response Transfer ID must not be altered
+    {
+        incrementTransferID(inout_transfer_id);
+    }
+    return 0;
+}
+
+int16_t canardTxStagingDrain(CanardTxStaging* staging,
+                             CanardInstance* ins,
+                             uint16_t max_transfers)
+{
+    CANARD_ASSERT((staging != NULL) && (ins != NULL));
+
+    // The transfers staged while draining may be moved as well, the limit bounds the time spent here
+    const uint16_t limit = MIN(max_transfers, (uint16_t) INT16_MAX);
+    int16_t num_moved = 0;
+    while ((uint16_t) num_moved < limit)
+    {
+        const uint32_t pos = staging->dequeue_pos;
+        CanardTxStagingSlot* const slot = &staging->slots[pos & (CANARD_TX_STAGING_CAPACITY - 1U)];
+        if (CANARD_ATOMIC_LOAD_ACQUIRE(&slot->sequence) != pos + 1U)
+        {
+            break;                              // Empty, or the producer has not finished filling the slot yet
+        }
+
+        uint8_t transfer_id = slot->transfer_id;
+        int16_t result = 0;
+        if (slot->destination_node_id == CANARD_BROADCAST_NODE_ID)
+        {
+            result = canardBroadcast(ins, slot->data_type_signature, slot->data_type_id, &transfer_id,
+                                     slot->priority, slot->payload, slot->payload_len
+#if CANARD_MULTI_IFACE
+                                     , slot->iface_mask
+#endif
+#if CANARD_ENABLE_CANFD
+                                     , slot->canfd
+#endif
+            );
+        }
+        else
+        {
+            result = canardRequestOrRespond(ins, slot->destination_node_id, slot->data_type_signature,
+                                            (uint8_t) slot->data_type_id, &transfer_id, slot->priority,
+                                            (CanardRequestResponse) slot->request_response,
+                                            slot->payload, slot->payload_len
+#if CANARD_MULTI_IFACE
+                                            , slot->iface_mask
+#endif
+#if CANARD_ENABLE_CANFD
+                                            , slot->canfd
+#endif
+            );
+        }
+
+        // Handing the slot back to the producers for the next lap around the queue
+        CANARD_ATOMIC_STORE_RELEASE(&slot->sequence, pos + CANARD_TX_STAGING_CAPACITY);
+        staging->dequeue_pos = pos + 1U;
+
+        if (result < 0)
+        {
+            return result;
+        }
+        num_moved++;
+    }
+    return num_moved;
+}
+
+uint32_t canardTxStagingGetOverflowCount(const CanardTxStaging* staging)
+{
+    CANARD_ASSERT(staging != NULL);
+    return CANARD_ATOMIC_LOAD_ACQUIRE(&staging->overflow_count);
+}
+#endif
+
+int16_t canardComputeAcceptanceFilters(const CanardAcceptedTransfer* accepted_transfers,
+                                       uint16_t num_accepted_transfers,
+                                       uint8_t local_node_id,
+                                       CanardAcceptanceFilter* out_filters,
+                                       uint8_t max_filters)
+{
+    if ((num_accepted_transfers > 0) &&
+        ((accepted_transfers == NULL) || (out_filters == NULL) || (max_filters == 0)))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+    if (local_node_id > CANARD_MAX_NODE_ID)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Only extended data frames are accepted, the priority is ignored
+    const uint32_t frame_type_id = CANARD_CAN_FRAME_EFF;
+    const uint32_t frame_type_mask = CANARD_CAN_FRAME_EFF | CANARD_CAN_FRAME_RTR;
+
+    uint8_t num_filters = 0;
+    for (uint16_t i = 0; i < num_accepted_transfers; i++)
+    {
+        const uint32_t data_type_id = accepted_transfers[i].data_type_id;
+        CanardAcceptanceFilter filter;
+
+        switch (accepted_transfers[i].transfer_type)
+        {
+        case CanardTransferTypeBroadcast:
+        {
+            filter.id = frame_type_id | (data_type_id << 8U);
+            filter.mask = frame_type_mask | MSG_TYPE_MASK | SERVICE_NOT_MSG_MASK;
+            addAcceptanceFilter(out_filters, &num_filters, max_filters, filter);
+
+            // Anonymous transfers carry only the lowest bits of the data type ID, and the source node ID is zero
+            if (data_type_id < (1U << ANON_MSG_DATA_TYPE_ID_BIT_LEN))
+            {
+                filter.mask = frame_type_mask | ANON_MSG_TYPE_MASK | SERVICE_NOT_MSG_MASK | SOURCE_ID_MASK;
+                addAcceptanceFilter(out_filters, &num_filters, max_filters, filter);
+            }
+            break;
+        }
+        case CanardTransferTypeRequest:
+        case CanardTransferTypeResponse:
+        {
+            if (data_type_id > (SRV_TYPE_MASK >> 16U))
+            {
+                return -CANARD_ERROR_INVALID_ARGUMENT;
+            }
+            if (local_node_id == CANARD_BROADCAST_NODE_ID)
+            {
+                break;                  // Anonymous nodes cannot receive service transfers
+            }
+            filter.id = frame_type_id | (data_type_id << 16U) | ((uint32_t)local_node_id << 8U) | SERVICE_NOT_MSG_MASK;
+            if (accepted_transfers[i].transfer_type == CanardTransferTypeRequest)
+            {
+                filter.id |= REQUEST_NOT_RESPONSE_MASK;
+            }
+            filter.mask = frame_type_mask | SRV_TYPE_MASK | REQUEST_NOT_RESPONSE_MASK | DEST_ID_MASK |
+                          SERVICE_NOT_MSG_MASK;
+            addAcceptanceFilter(out_filters, &num_filters, max_filters, filter);
+            break;
+        }
+        default:
+        {
+            return -CANARD_ERROR_INVALID_ARGUMENT;
+        }
+        }
+    }
+
+    return num_filters;
+}
+
 int16_t canardDecodeScalar(const CanardRxTransfer* transfer,
                            uint32_t bit_offset,
                            uint8_t bit_length,
@@ -762,6 +1221,87 @@ int16_t canardDecodeScalar(const CanardRxTransfer* transfer,
     return result;
 }
 
+int32_t canardDecodeByteArray(const CanardRxTransfer* transfer,
+                              uint32_t bit_offset,
+                              uint16_t len,
+                              bool zero_copy,
+                              uint8_t** out_data,
+                              uint8_t** inout_arena,
+                              const uint8_t* arena_end)
+{
+    if (transfer == NULL || out_data == NULL)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (bit_offset + len * 8U > transfer->payload_len * 8U)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;          // Out of range
+    }
+
+    const bool byte_aligned = (bit_offset % 8U) == 0U;
+
+    if (zero_copy && byte_aligned && (len > 0))
+    {
+        const uint8_t* segment = NULL;
+        const uint16_t segment_len = getTransferPayloadSegment(transfer, (uint16_t)(bit_offset / 8U), &segment);
+        if (segment_len >= len)
+        {
+            *out_data = (uint8_t*) segment;             // Cast away const, the view is read-only by contract
+            return (int32_t) len * 8;
+        }
+    }
+
+    if (inout_arena == NULL || *inout_arena == NULL)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    if ((arena_end != NULL) && ((size_t)(arena_end - *inout_arena) < len))
+    {
+        return -CANARD_ERROR_OUT_OF_MEMORY;
+    }
+
+    uint8_t* const output = *inout_arena;
+
+    if (byte_aligned)
+    {
+        // Copying whole contiguous segments at once
+        uint16_t byte_offset = (uint16_t)(bit_offset / 8U);
+        uint16_t copied = 0;
+        while (copied < len)
+        {
+            const uint8_t* segment = NULL;
+            const uint16_t segment_len = getTransferPayloadSegment(transfer, byte_offset, &segment);
+            CANARD_ASSERT(segment_len > 0);
+            const uint16_t amount = (uint16_t) MIN(segment_len, (uint16_t)(len - copied));
+            memcpy(&output[copied], segment, amount);
+            copied = (uint16_t)(copied + amount);
+            byte_offset = (uint16_t)(byte_offset + amount);
+        }
+    }
+    else
+    {
+        // Unaligned, going through the bit copy algorithm in chunks of 8 bytes
+        uint16_t copied = 0;
+        while (copied < len)
+        {
+            const uint8_t amount = (uint8_t) MIN(8U, (uint16_t)(len - copied));
+            const int16_t result = descatterTransferPayload(transfer, bit_offset + copied * 8U,
+                                                            (uint8_t)(amount * 8U), &output[copied]);
+            if (result != amount * 8)
+            {
+                return (result < 0) ? result : -CANARD_ERROR_INTERNAL;
+            }
+            copied = (uint16_t)(copied + amount);
+        }
+    }
+
+    *out_data = output;
+    *inout_arena += len;
+    return (int32_t) len * 8;
+}
+
 void canardEncodeScalar(void* destination,
                         uint32_t bit_offset,
                         uint8_t bit_length,
@@ -846,7 +1386,7 @@ void canardReleaseRxTransferPayload(CanardInstance* ins, CanardRxTransfer* trans
     while (transfer->payload_middle != NULL)
     {
         CanardBufferBlock* const temp = transfer->payload_middle->next;
-        freeBlock(&ins->allocator, transfer->payload_middle);
+        freePoolBlock(&ins->allocator, CanardPoolCategoryRxPayload, transfer->payload_middle);
         transfer->payload_middle = temp;
     }
 
@@ -861,32 +1401,274 @@ CanardPoolAllocatorStatistics canardGetPoolAllocatorStatistics(CanardInstance* i
     return ins->allocator.statistics;
 }
 
-uint16_t canardConvertNativeFloatToFloat16(float value)
+#if CANARD_ENABLE_POOL_QUOTAS
+int16_t canardSetPoolQuota(CanardInstance* ins,
+                           CanardPoolCategory category,
+                           CanardPoolBlockCount reserved_blocks,
+                           CanardPoolBlockCount max_blocks)
 {
-    CANARD_ASSERT(sizeof(float) == 4);
+    CANARD_ASSERT(ins != NULL);
 
-    union FP32
+    if (((size_t)category >= CANARD_POOL_NUM_CATEGORIES) || (reserved_blocks > max_blocks))
     {
-        uint32_t u;
-        float f;
-    };
-
-    const union FP32 f32inf = { 255UL << 23U };
-    const union FP32 f16inf = { 31UL << 23U };
-    const union FP32 magic = { 15UL << 23U };
-    const uint32_t sign_mask = 0x80000000UL;
-    const uint32_t round_mask = ~0xFFFUL;
-
-    union FP32 in;
-    in.f = value;
-    uint32_t sign = in.u & sign_mask;
-    in.u ^= sign;
-
-    uint16_t out = 0;
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
 
-    if (in.u >= f32inf.u)
+    uint64_t total_reserved = reserved_blocks;
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_CATEGORIES; i++)
     {
-        out = (in.u > f32inf.u) ? (uint16_t)0x7FFFU : (uint16_t)0x7C00U;
+        if (i != (uint8_t)category)
+        {
+            total_reserved += ins->allocator.quotas[i].reserved_blocks;
+        }
+    }
+    if (total_reserved > ins->allocator.statistics.capacity_blocks)
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    ins->allocator.quotas[category].reserved_blocks = reserved_blocks;
+    ins->allocator.quotas[category].max_blocks = max_blocks;
+    return CANARD_OK;
+}
+#endif
+
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+int16_t canardSetMemoryAllocator(CanardInstance* ins,
+                                 CanardMemoryAllocator* allocator)
+{
+    CANARD_ASSERT(ins != NULL);
+
+    if ((allocator == NULL) || (allocator->allocate == NULL) || (allocator->deallocate == NULL) ||
+        (ins->allocator.statistics.current_usage_blocks > 0))
+    {
+        return -CANARD_ERROR_INVALID_ARGUMENT;
+    }
+
+    ins->allocator.custom = allocator;
+    ins->allocator.statistics.capacity_blocks = (CanardPoolBlockCount) CANARD_POOL_MAX_BLOCKS;
+    return CANARD_OK;
+}
+#endif
+
+#if CANARD_ENABLE_SHARED_POOL
+void canardInitSharedPool(CanardSharedPool* out_pool,
+                          void* mem_arena,
+                          size_t mem_arena_size)
+{
+    CANARD_ASSERT(out_pool != NULL);
+
+    memset(out_pool, 0, sizeof(*out_pool));
+    out_pool->base.allocate = allocateSharedPoolBlock;
+    out_pool->base.deallocate = freeSharedPoolBlock;
+#if CANARD_ENABLE_LOCK_FREE_POOL
+    initLockFreePool(out_pool, mem_arena, mem_arena_size);
+#else
+    initPool(&out_pool->pool, mem_arena, mem_arena_size);
+#endif
+}
+
+int16_t canardAttachSharedPool(CanardInstance* ins,
+                               CanardSharedPool* pool,
+                               CanardPoolBlockCount max_blocks)
+{
+    CANARD_ASSERT(pool != NULL);
+    return attachSharedPoolAllocator(ins, &pool->base, canardGetSharedPoolStatistics(pool).capacity_blocks,
+                                     max_blocks);
+}
+
+CanardPoolAllocatorStatistics canardGetSharedPoolStatistics(const CanardSharedPool* pool)
+{
+    CANARD_ASSERT(pool != NULL);
+#if CANARD_ENABLE_LOCK_FREE_POOL
+    CanardPoolAllocatorStatistics statistics;
+    memset(&statistics, 0, sizeof(statistics));
+    statistics.capacity_blocks = pool->statistics.capacity_blocks;
+    statistics.current_usage_blocks = CANARD_ATOMIC_LOAD_ACQUIRE(&pool->statistics.current_usage_blocks);
+    statistics.peak_usage_blocks = CANARD_ATOMIC_LOAD_ACQUIRE(&pool->statistics.peak_usage_blocks);
+    return statistics;
+#else
+    return pool->pool.statistics;
+#endif
+}
+#endif
+
+#if CANARD_ENABLE_LOCK_FREE_POOL
+void canardInitSharedPoolContext(CanardSharedPoolContext* out_context,
+                                 CanardSharedPool* pool)
+{
+    CANARD_ASSERT(out_context != NULL);
+    CANARD_ASSERT(pool != NULL);
+
+    out_context->base.allocate = allocateSharedPoolContextBlock;
+    out_context->base.deallocate = freeSharedPoolContextBlock;
+    out_context->pool = pool;
+    out_context->magazine = NULL;
+    out_context->magazine_size = 0;
+}
+
+int16_t canardAttachSharedPoolContext(CanardInstance* ins,
+                                      CanardSharedPoolContext* context,
+                                      CanardPoolBlockCount max_blocks)
+{
+    CANARD_ASSERT(context != NULL);
+    return attachSharedPoolAllocator(ins, &context->base, context->pool->statistics.capacity_blocks, max_blocks);
+}
+
+void canardFlushSharedPoolContext(CanardSharedPoolContext* context)
+{
+    CANARD_ASSERT(context != NULL);
+    flushSharedPoolContext(context, context->magazine_size);
+}
+#endif
+
+#if CANARD_ENABLE_SIZE_CLASSES
+CanardPoolAllocatorStatistics canardGetPoolSizeClassStatistics(CanardInstance* ins, uint8_t size_class)
+{
+    CANARD_ASSERT(size_class < CANARD_POOL_NUM_SIZE_CLASSES);
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+    if (ins->allocator.custom != NULL)
+    {
+        CanardPoolAllocatorStatistics none;
+        memset(&none, 0, sizeof(none));
+        return none;
+    }
+#endif
+    return ins->allocator.size_classes[size_class].statistics;
+}
+#endif
+
+#if CANARD_ENABLE_FLOAT16_LUT
+/*
+ * Float32 exponents from FLOAT16_LUT_MIN_EXPONENT (and below) to FLOAT16_LUT_MAX_EXPONENT (and above) map to the
+ * float16 exponent (plus mantissa, for subnormals) and the shift of the float32 mantissa with the implicit bit.
+ */
+#define FLOAT16_LUT_MIN_EXPONENT                    101U
+#define FLOAT16_LUT_MAX_EXPONENT                    143U
+
+static const uint16_t Float16LutBase[FLOAT16_LUT_MAX_EXPONENT - FLOAT16_LUT_MIN_EXPONENT + 1U] =
+{
+    0x0000U, 0x0000U, 0x0000U, 0x0000U, 0x0000U, 0x0000U, 0x0000U, 0x0000U, 0x0000U, 0x0000U, 0x0000U,
+    0x0000U, 0x0000U, 0x0400U, 0x0800U, 0x0C00U, 0x1000U, 0x1400U, 0x1800U, 0x1C00U, 0x2000U, 0x2400U,
+    0x2800U, 0x2C00U, 0x3000U, 0x3400U, 0x3800U, 0x3C00U, 0x4000U, 0x4400U, 0x4800U, 0x4C00U, 0x5000U,
+    0x5400U, 0x5800U, 0x5C00U, 0x6000U, 0x6400U, 0x6800U, 0x6C00U, 0x7000U, 0x7400U, 0x7C00U
+};
+
+static const uint8_t Float16LutShift[FLOAT16_LUT_MAX_EXPONENT - FLOAT16_LUT_MIN_EXPONENT + 1U] =
+{
+    25U, 24U, 23U, 22U, 21U, 20U, 19U, 18U, 17U, 16U, 15U,
+    14U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U,
+    13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U,
+    13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U, 25U
+};
+
+uint16_t canardConvertNativeFloatToFloat16(float value)
+{
+    CANARD_ASSERT(sizeof(float) == 4);
+
+    union FP32
+    {
+        uint32_t u;
+        float f;
+    };
+
+    union FP32 in;
+    in.f = value;
+    const uint16_t sign = (uint16_t)((in.u >> 16U) & 0x8000U);
+    const uint32_t exponent = (in.u >> 23U) & 0xFFU;
+    const uint32_t mantissa = in.u & 0x7FFFFFUL;
+
+    if ((exponent == 0xFFU) && (mantissa != 0U))
+    {
+        return (uint16_t)(sign | 0x7FFFU);
+    }
+
+    const uint32_t index = MIN(MAX(exponent, FLOAT16_LUT_MIN_EXPONENT), FLOAT16_LUT_MAX_EXPONENT) -
+                           FLOAT16_LUT_MIN_EXPONENT;
+    const uint32_t shift = Float16LutShift[index];
+    const uint32_t significand = mantissa | 0x800000UL;
+    uint32_t out = Float16LutBase[index] + (significand >> shift);
+
+    // Round to nearest even; a carry into the exponent is correct, up to infinity
+    const uint32_t round_bit = 1UL << (shift - 1U);
+    if (((significand & round_bit) != 0U) && ((significand & ((round_bit << 1U) | (round_bit - 1U))) != 0U))
+    {
+        out++;
+    }
+
+    return (uint16_t)(sign | out);
+}
+
+float canardConvertFloat16ToNativeFloat(uint16_t value)
+{
+    CANARD_ASSERT(sizeof(float) == 4);
+
+    union FP32
+    {
+        uint32_t u;
+        float f;
+    };
+
+    const uint32_t exponent = ((uint32_t)value >> 10U) & 0x1FU;
+    uint32_t mantissa = (uint32_t)value & 0x3FFU;
+    union FP32 out;
+    out.u = ((uint32_t)value & 0x8000U) << 16U;
+
+    if (exponent == 0x1FU)
+    {
+        out.u |= ((uint32_t)0xFFU << 23U) | (mantissa << 13U);
+    }
+    else if (exponent != 0U)
+    {
+        out.u |= ((exponent + 127U - 15U) << 23U) | (mantissa << 13U);
+    }
+    else if (mantissa != 0U)
+    {
+        // Subnormal float16 values are normal float32 values
+        uint32_t normalized_exponent = 127U - 14U;
+        while ((mantissa & 0x400U) == 0U)
+        {
+            mantissa <<= 1U;
+            normalized_exponent--;
+        }
+        out.u |= (normalized_exponent << 23U) | ((mantissa & 0x3FFU) << 13U);
+    }
+    else
+    {
+        ;   // Zero
+    }
+
+    return out.f;
+}
+
+#else
+
+uint16_t canardConvertNativeFloatToFloat16(float value)
+{
+    CANARD_ASSERT(sizeof(float) == 4);
+
+    union FP32
+    {
+        uint32_t u;
+        float f;
+    };
+
+    const union FP32 f32inf = { 255UL << 23U };
+    const union FP32 f16inf = { 31UL << 23U };
+    const union FP32 magic = { 15UL << 23U };
+    const uint32_t sign_mask = 0x80000000UL;
+    const uint32_t round_mask = 0xFFFFF000UL;
+
+    union FP32 in;
+    in.f = value;
+    uint32_t sign = in.u & sign_mask;
+    in.u ^= sign;
+
+    uint16_t out = 0;
+
+    if (in.u >= f32inf.u)
+    {
+        out = (in.u > f32inf.u) ? (uint16_t)0x7FFFU : (uint16_t)0x7C00U;
     }
     else
     {
@@ -930,6 +1712,74 @@ float canardConvertFloat16ToNativeFloat(uint16_t value)
     return out.f;
 }
 
+#endif
+
+void canardConvertNativeFloatArrayToFloat16(const float* values,
+                                            uint16_t* out_values,
+                                            size_t count)
+{
+    CANARD_ASSERT(((values != NULL) && (out_values != NULL)) || (count == 0U));
+
+    size_t i = 0;
+#if defined(CANARD_USE_FLOAT16_CAST)
+    for (; i < count; i++)
+    {
+        const CANARD_USE_FLOAT16_CAST tmp_float = (CANARD_USE_FLOAT16_CAST)values[i];
+        memcpy(&out_values[i], &tmp_float, sizeof(uint16_t));
+    }
+#else
+# if FLOAT16_SIMD_F16C
+    for (; (i + 8U) <= count; i += 8U)
+    {
+        _mm_storeu_si128((__m128i*)(void*)&out_values[i],
+                         _mm256_cvtps_ph(_mm256_loadu_ps(&values[i]), _MM_FROUND_TO_NEAREST_INT));
+    }
+# elif FLOAT16_SIMD_NEON
+    for (; (i + 4U) <= count; i += 4U)
+    {
+        vst1_u16(&out_values[i], vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(&values[i]))));
+    }
+# endif
+    for (; i < count; i++)
+    {
+        out_values[i] = canardConvertNativeFloatToFloat16(values[i]);
+    }
+#endif
+}
+
+void canardConvertFloat16ArrayToNativeFloat(const uint16_t* values,
+                                            float* out_values,
+                                            size_t count)
+{
+    CANARD_ASSERT(((values != NULL) && (out_values != NULL)) || (count == 0U));
+
+    size_t i = 0;
+#if defined(CANARD_USE_FLOAT16_CAST)
+    for (; i < count; i++)
+    {
+        CANARD_USE_FLOAT16_CAST tmp_float;
+        memcpy(&tmp_float, &values[i], sizeof(uint16_t));
+        out_values[i] = (float)tmp_float;
+    }
+#else
+# if FLOAT16_SIMD_F16C
+    for (; (i + 8U) <= count; i += 8U)
+    {
+        _mm256_storeu_ps(&out_values[i], _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(const void*)&values[i])));
+    }
+# elif FLOAT16_SIMD_NEON
+    for (; (i + 4U) <= count; i += 4U)
+    {
+        vst1q_f32(&out_values[i], vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(&values[i]))));
+    }
+# endif
+    for (; i < count; i++)
+    {
+        out_values[i] = canardConvertFloat16ToNativeFloat(values[i]);
+    }
+#endif
+}
+
 /*
  * Internal (static functions)
  */
@@ -1031,7 +1881,8 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
 #endif
     if (payload_len < frame_max_data_len)                        // Single frame transfer
     {
-        CanardTxQueueItem* queue_item = createTxItem(&ins->allocator);
+        const uint8_t frame_data_len = dlcToDataLength(dataLengthToDlc((uint8_t)(payload_len + 1U)));
+        CanardTxQueueItem* queue_item = createTxItem(&ins->allocator, frame_data_len);
         if (queue_item == NULL)
         {
             return -CANARD_ERROR_OUT_OF_MEMORY;
@@ -1039,8 +1890,8 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
 
         memcpy(queue_item->frame.data, payload, payload_len);
 
-        payload_len = dlcToDataLength(dataLengthToDlc(payload_len+1))-1;
-        queue_item->frame.data_len = (uint8_t)(payload_len + 1);
+        payload_len = (uint16_t)(frame_data_len - 1U);
+        queue_item->frame.data_len = frame_data_len;
         queue_item->frame.data[payload_len] = (uint8_t)(0xC0U | (*transfer_id & 31U));
         queue_item->frame.id = can_id | CANARD_CAN_FRAME_EFF;
 #if CANARD_MULTI_IFACE
@@ -1048,6 +1899,7 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
 #endif
 #if CANARD_ENABLE_CANFD
         queue_item->frame.canfd = canfd;
+        queue_item->frame.brs = canfd && !ins->brs_disabled;
 #endif
         pushTxQueue(ins, queue_item);
         result++;
@@ -1062,7 +1914,12 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
 
         while (payload_len - data_index != 0)
         {
-            queue_item = createTxItem(&ins->allocator);
+            // The CRC, the payload bytes and the tail byte, padded to a valid CAN FD frame length
+            const uint16_t crc_len = (data_index == 0) ? 2U : 0U;
+            const uint16_t chunk_len = (uint16_t) MIN(frame_max_data_len - 1U - crc_len,
+                                                      (uint16_t)(payload_len - data_index));
+            queue_item = createTxItem(&ins->allocator,
+                                      dlcToDataLength(dataLengthToDlc((uint8_t)(crc_len + chunk_len + 1U))));
             if (queue_item == NULL)
             {
                 return -CANARD_ERROR_OUT_OF_MEMORY;          // TODO: Purge all frames enqueued so far
@@ -1097,6 +1954,7 @@ CANARD_INTERNAL int16_t enqueueTxFrames(CanardInstance* ins,
 #endif
 #if CANARD_ENABLE_CANFD
             queue_item->frame.canfd = canfd;
+            queue_item->frame.brs = canfd && !ins->brs_disabled;
 #endif
             pushTxQueue(ins, queue_item);
 
@@ -1120,6 +1978,9 @@ CANARD_INTERNAL void pushTxQueue(CanardInstance* ins, CanardTxQueueItem* item)
     if (ins->tx_queue == NULL)
     {
         ins->tx_queue = item;
+#if CANARD_ENABLE_SIZE_CLASSES
+        copyTxQueueHead(ins);
+#endif
         return;
     }
 
@@ -1134,6 +1995,9 @@ CANARD_INTERNAL void pushTxQueue(CanardInstance* ins, CanardTxQueueItem* item)
             {
                 item->next = queue;
                 ins->tx_queue = item;
+#if CANARD_ENABLE_SIZE_CLASSES
+                copyTxQueueHead(ins);
+#endif
             }
             else
             {
@@ -1159,19 +2023,39 @@ CANARD_INTERNAL void pushTxQueue(CanardInstance* ins, CanardTxQueueItem* item)
 }
 
 /**
- * Creates new tx queue item from allocator
+ * Creates new tx queue item from allocator. With size classes the block only has room for data_len bytes of frame
+ * data, otherwise it holds the complete frame.
  */
-CANARD_INTERNAL CanardTxQueueItem* createTxItem(CanardPoolAllocator* allocator)
+CANARD_INTERNAL CanardTxQueueItem* createTxItem(CanardPoolAllocator* allocator, uint8_t data_len)
 {
-    CanardTxQueueItem* item = (CanardTxQueueItem*) allocateBlock(allocator);
+    CANARD_ASSERT(data_len <= sizeof(((CanardCANFrame*)NULL)->data));
+#if CANARD_ENABLE_SIZE_CLASSES
+    const size_t size = offsetof(CanardTxQueueItem, frame) + offsetof(CanardCANFrame, data) + data_len;
+#else
+    const size_t size = sizeof(CanardTxQueueItem);
+    (void) data_len;
+#endif
+    CanardTxQueueItem* item = (CanardTxQueueItem*) allocatePoolBlock(allocator, CanardPoolCategoryTx, size);
     if (item == NULL)
     {
         return NULL;
     }
-    memset(item, 0, sizeof(*item));
+    memset(item, 0, size);
     return item;
 }
 
+#if CANARD_ENABLE_SIZE_CLASSES
+CANARD_INTERNAL void copyTxQueueHead(CanardInstance* ins)
+{
+    if (ins->tx_queue != NULL)
+    {
+        // The item block ends after data_len bytes of data
+        memcpy(&ins->tx_head_frame, &ins->tx_queue->frame,
+               offsetof(CanardCANFrame, data) + ins->tx_queue->frame.data_len);
+    }
+}
+#endif
+
 /**
  * Returns true if priority of rhs is higher than id
  */
@@ -1246,6 +2130,21 @@ CANARD_INTERNAL uint16_t extractDataType(uint32_t id)
     }
 }
 
+/**
+ * Returns the reception timeouts of the transfer, see canardSetRxTimeouts()
+ */
+CANARD_INTERNAL CanardRxTimeouts getRxTimeouts(const CanardInstance* ins, uint32_t transfer_descriptor)
+{
+    CanardRxTimeouts timeouts = ins->rx_timeouts;
+    if (ins->get_rx_timeouts != NULL)
+    {
+        const uint16_t data_type_id = (uint16_t)(transfer_descriptor & 0xFFFFU);
+        const CanardTransferType transfer_type = (CanardTransferType)((transfer_descriptor >> 16U) & 0x3U);
+        ins->get_rx_timeouts(ins, data_type_id, transfer_type, &timeouts);
+    }
+    return timeouts;
+}
+
 /**
  * returns transfer type from id
  */
@@ -1266,6 +2165,89 @@ CANARD_INTERNAL CanardTransferType extractTransferType(uint32_t id)
     }
 }
 
+/*
+ *  Acceptance filter functions
+ */
+CANARD_INTERNAL uint32_t countAcceptedIDs(CanardAcceptanceFilter filter)
+{
+    uint8_t num_free_bits = 0;
+    for (uint32_t bit = 1U; bit <= CANARD_CAN_EXT_ID_MASK; bit <<= 1U)
+    {
+        if ((filter.mask & bit) == 0)
+        {
+            num_free_bits++;
+        }
+    }
+    return 1U << num_free_bits;
+}
+
+CANARD_INTERNAL CanardAcceptanceFilter mergeAcceptanceFilters(CanardAcceptanceFilter a,
+                                                              CanardAcceptanceFilter b)
+{
+    CanardAcceptanceFilter out;
+    out.mask = a.mask & b.mask & ~(a.id ^ b.id);
+    out.id = a.id & out.mask;
+    return out;
+}
+
+CANARD_INTERNAL void addAcceptanceFilter(CanardAcceptanceFilter* filters,
+                                         uint8_t* inout_num_filters,
+                                         uint8_t max_filters,
+                                         CanardAcceptanceFilter filter)
+{
+    const uint8_t num_filters = *inout_num_filters;
+
+    // Nothing to do if an existing filter passes everything that the new one does
+    for (uint8_t i = 0; i < num_filters; i++)
+    {
+        const CanardAcceptanceFilter merged = mergeAcceptanceFilters(filters[i], filter);
+        if ((merged.id == (filters[i].id & filters[i].mask)) && (merged.mask == filters[i].mask))
+        {
+            return;
+        }
+    }
+
+    if (num_filters < max_filters)
+    {
+        filters[num_filters] = filter;
+        (*inout_num_filters)++;
+        return;
+    }
+
+    /*
+     * The set is full, so two of the filters, including the new one at the index num_filters, have to be merged.
+     * The cost of a merge is the number of CAN IDs that pass the merged filter but passed neither of the two.
+     */
+    uint8_t best_a = 0;
+    uint8_t best_b = 0;
+    int64_t best_cost = INT64_MAX;
+    for (uint8_t a = 0; a < num_filters; a++)
+    {
+        for (uint8_t b = (uint8_t)(a + 1U); b <= num_filters; b++)
+        {
+            const CanardAcceptanceFilter filter_b = (b < num_filters) ? filters[b] : filter;
+            const int64_t cost = (int64_t)countAcceptedIDs(mergeAcceptanceFilters(filters[a], filter_b)) -
+                                 (int64_t)countAcceptedIDs(filters[a]) - (int64_t)countAcceptedIDs(filter_b);
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_a = a;
+                best_b = b;
+            }
+        }
+    }
+
+    if (best_b < num_filters)
+    {
+        filters[best_a] = mergeAcceptanceFilters(filters[best_a], filters[best_b]);
+        filters[best_b] = filter;
+    }
+    else
+    {
+        filters[best_a] = mergeAcceptanceFilters(filters[best_a], filter);
+    }
+}
+
 /*
  *  CanardRxState functions
  */
@@ -1343,7 +2325,8 @@ CANARD_INTERNAL CanardRxState* createRxState(CanardPoolAllocator* allocator, uin
         .dtid_tt_snid_dnid = transfer_descriptor
     };
 
-    CanardRxState* state = (CanardRxState*) allocateBlock(allocator);
+    CanardRxState* state = (CanardRxState*) allocatePoolBlock(allocator, CanardPoolCategoryRxState,
+                                                              CANARD_RX_STATE_BLOCK_SIZE);
     if (state == NULL)
     {
         return NULL;
@@ -1358,13 +2341,70 @@ CANARD_INTERNAL uint64_t releaseStatePayload(CanardInstance* ins, CanardRxState*
     while (rxstate->buffer_blocks != NULL)
     {
         CanardBufferBlock* const temp = rxstate->buffer_blocks->next;
-        freeBlock(&ins->allocator, rxstate->buffer_blocks);
+        freePoolBlock(&ins->allocator, CanardPoolCategoryRxPayload, rxstate->buffer_blocks);
         rxstate->buffer_blocks = temp;
     }
     rxstate->payload_len = 0;
     return CANARD_OK;
 }
 
+#if CANARD_ENABLE_RX_STATE_EVICTION
+CANARD_INTERNAL bool evictRxState(CanardInstance* ins, uint8_t priority)
+{
+    // The least recently used idle state goes first; otherwise the lowest priority reception, the oldest of equals
+    CanardRxState* victim = NULL;
+    CanardRxState* victim_prev = NULL;
+    bool victim_idle = false;
+    for (CanardRxState* prev = NULL, * state = ins->rx_states; state != NULL; prev = state, state = state->next)
+    {
+        const bool idle = state->payload_len == 0;
+        bool better = false;
+        if (idle)
+        {
+            better = !victim_idle || (state->timestamp_usec < victim->timestamp_usec);
+        }
+        else if (!victim_idle && (state->priority > priority))
+        {
+            better = (victim == NULL) ||
+                     (state->priority > victim->priority) ||
+                     ((state->priority == victim->priority) && (state->timestamp_usec < victim->timestamp_usec));
+        }
+        if (better)
+        {
+            victim = state;
+            victim_prev = prev;
+            victim_idle = idle;
+        }
+    }
+
+    if (victim == NULL)
+    {
+        return false;
+    }
+
+    if (victim_prev == NULL)
+    {
+        ins->rx_states = victim->next;
+    }
+    else
+    {
+        victim_prev->next = victim->next;
+    }
+    releaseStatePayload(ins, victim);
+    freePoolBlock(&ins->allocator, CanardPoolCategoryRxState, victim);
+
+    if (victim_idle)
+    {
+        ins->rx_evictions.idle_states++;
+    }
+    else
+    {
+        ins->rx_evictions.in_progress_states++;
+    }
+    return true;
+}
+#endif
+
 /*
  *  CanardBufferBlock functions
  */
@@ -1471,7 +2511,8 @@ CANARD_INTERNAL int16_t bufferBlockPushBytes(CanardPoolAllocator* allocator,
 
 CANARD_INTERNAL CanardBufferBlock* createBufferBlock(CanardPoolAllocator* allocator)
 {
-    CanardBufferBlock* block = (CanardBufferBlock*) allocateBlock(allocator);
+    CanardBufferBlock* block = (CanardBufferBlock*) allocatePoolBlock(allocator, CanardPoolCategoryRxPayload,
+                                                                      CANARD_BUFFER_BLOCK_SIZE);
     if (block == NULL)
     {
         return NULL;
@@ -1495,7 +2536,7 @@ void copyBitArray(const uint8_t* src, uint32_t src_offset, uint32_t src_len,
     src_offset %= 8U;
     dst_offset %= 8U;
 
-    const size_t last_bit = src_offset + src_len;
+    const uint32_t last_bit = src_offset + src_len;
     while (last_bit - src_offset)
     {
         const uint8_t src_bit_offset = (uint8_t)(src_offset % 8U);
@@ -1559,8 +2600,8 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
         }
 
         // Reading middle
-        uint32_t remaining_bits = transfer->payload_len * 8U - CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8U;
-        uint32_t block_bit_offset = CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8U;
+        uint32_t remaining_bits = transfer->payload_len * 8U - (uint32_t)CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8U;
+        uint32_t block_bit_offset = (uint32_t)CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8U;
         const CanardBufferBlock* block = transfer->payload_middle;
 
         while ((block != NULL) && (remaining_bit_length > 0))
@@ -1618,10 +2659,58 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
     return bit_length;
 }
 
-CANARD_INTERNAL bool isBigEndian(void)
+CANARD_INTERNAL uint16_t getTransferPayloadSegment(const CanardRxTransfer* transfer,
+                                                   uint16_t byte_offset,
+                                                   const uint8_t** out_segment)
 {
-#if defined(BYTE_ORDER) && defined(BIG_ENDIAN)
-    return BYTE_ORDER == BIG_ENDIAN;                // Some compilers offer this neat shortcut
+    CANARD_ASSERT(transfer != NULL);
+    CANARD_ASSERT(out_segment != NULL);
+
+    if (byte_offset >= transfer->payload_len)
+    {
+        *out_segment = NULL;
+        return 0;
+    }
+
+    if ((transfer->payload_middle == NULL) && (transfer->payload_tail == NULL))  // Single frame
+    {
+        *out_segment = &transfer->payload_head[byte_offset];
+        return (uint16_t)(transfer->payload_len - byte_offset);
+    }
+
+    // Head
+    if (byte_offset < CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE)
+    {
+        *out_segment = &transfer->payload_head[byte_offset];
+        return (uint16_t)(MIN(CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE, transfer->payload_len) - byte_offset);
+    }
+
+    // Middle, all blocks are full except possibly the last one
+    uint16_t block_offset = CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE;
+    const CanardBufferBlock* block = transfer->payload_middle;
+    while (block != NULL)
+    {
+        const uint16_t block_len = (uint16_t) MIN(CANARD_BUFFER_BLOCK_DATA_SIZE,
+                                                  (uint16_t)(transfer->payload_len - block_offset));
+        if (byte_offset < block_offset + block_len)
+        {
+            *out_segment = &block->data[byte_offset - block_offset];
+            return (uint16_t)(block_offset + block_len - byte_offset);
+        }
+        block_offset = (uint16_t)(block_offset + block_len);
+        block = block->next;
+    }
+
+    // Tail
+    CANARD_ASSERT(transfer->payload_tail != NULL);
+    *out_segment = &transfer->payload_tail[byte_offset - block_offset];
+    return (uint16_t)(transfer->payload_len - byte_offset);
+}
+
+CANARD_INTERNAL bool isBigEndian(void)
+{
+#if defined(BYTE_ORDER) && defined(BIG_ENDIAN)
+    return BYTE_ORDER == BIG_ENDIAN;                // Some compilers offer this neat shortcut
 #else
     union
     {
@@ -1693,10 +2782,162 @@ CANARD_INTERNAL uint16_t crcAdd(uint16_t crc_val, const uint8_t* bytes, size_t l
 /*
  *  Pool Allocator functions
  */
+#if CANARD_ENABLE_SIZE_CLASSES
+static const uint16_t PoolBlockSizes[CANARD_POOL_NUM_SIZE_CLASSES] =
+{
+    CANARD_POOL_SMALL_BLOCK_SIZE,
+    CANARD_POOL_MEDIUM_BLOCK_SIZE,
+    CANARD_POOL_LARGE_BLOCK_SIZE
+};
+
+CANARD_STATIC_ASSERT((CANARD_POOL_SMALL_BLOCK_SIZE % 8U == 0) && (CANARD_POOL_MEDIUM_BLOCK_SIZE % 8U == 0) &&
+                     (CANARD_POOL_LARGE_BLOCK_SIZE % 8U == 0), "Block sizes must be multiples of 8");
+CANARD_STATIC_ASSERT((CANARD_POOL_SMALL_BLOCK_SIZE < CANARD_POOL_MEDIUM_BLOCK_SIZE) &&
+                     (CANARD_POOL_MEDIUM_BLOCK_SIZE < CANARD_POOL_LARGE_BLOCK_SIZE), "Block sizes must be ascending");
+CANARD_STATIC_ASSERT(CANARD_POOL_SMALL_SHARE_PERCENT + CANARD_POOL_MEDIUM_SHARE_PERCENT <= 100U,
+                     "The arena shares cannot exceed 100%");
+
+CANARD_INTERNAL void initPoolSizeClasses(CanardPoolAllocator* allocator, void* arena, size_t arena_size)
+{
+    static const size_t SharePercent[CANARD_POOL_NUM_SIZE_CLASSES - 1U] =
+    {
+        CANARD_POOL_SMALL_SHARE_PERCENT,
+        CANARD_POOL_MEDIUM_SHARE_PERCENT
+    };
+
+    memset(&allocator->statistics, 0, sizeof(allocator->statistics));
+#if CANARD_ENABLE_POOL_QUOTAS
+    initPoolQuotas(allocator);
+#endif
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+    allocator->custom = NULL;
+#endif
+
+    uint8_t* block = (uint8_t*) arena;
+    size_t remaining_size = arena_size;
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        CanardPoolSizeClass* const size_class = &allocator->size_classes[i];
+
+        // The last class takes the rest of the arena; the split avoids overflowing size_t on huge arenas
+        size_t class_size = remaining_size;
+        if (i < (CANARD_POOL_NUM_SIZE_CLASSES - 1U))
+        {
+            class_size = (arena_size / 100U) * SharePercent[i] + ((arena_size % 100U) * SharePercent[i]) / 100U;
+        }
+        size_t num_blocks = class_size / PoolBlockSizes[i];
+#if SIZE_MAX > CANARD_POOL_MAX_BLOCKS
+        if (num_blocks > CANARD_POOL_MAX_BLOCKS)
+        {
+            num_blocks = CANARD_POOL_MAX_BLOCKS;
+        }
+#endif
+
+#if CANARD_ENABLE_LAZY_POOL_INIT
+        size_class->free_list = NULL;
+        size_class->untouched = block;
+        block += num_blocks * PoolBlockSizes[i];
+#else
+        CanardPoolAllocatorBlock** current_block = &size_class->free_list;
+        for (size_t k = 0; k < num_blocks; k++)
+        {
+            *current_block = (CanardPoolAllocatorBlock*)(void*) block;
+            current_block = &((*current_block)->next);
+            block += PoolBlockSizes[i];
+        }
+        *current_block = NULL;
+#endif
+
+        size_class->end = block;
+        remaining_size -= num_blocks * PoolBlockSizes[i];
+        size_class->statistics.capacity_blocks = (CanardPoolBlockCount) num_blocks;
+        size_class->statistics.current_usage_blocks = 0;
+        size_class->statistics.peak_usage_blocks = 0;
+        allocator->statistics.capacity_blocks =
+            (CanardPoolBlockCount)(allocator->statistics.capacity_blocks + num_blocks);
+    }
+}
+
+CANARD_INTERNAL void* allocateSizedBlock(CanardPoolAllocator* allocator, size_t size)
+{
+    CANARD_ASSERT(size <= CANARD_MEM_BLOCK_SIZE);
+
+    // If the smallest class that fits is exhausted, a larger class will do
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        CanardPoolSizeClass* const size_class = &allocator->size_classes[i];
+        if (PoolBlockSizes[i] < size)
+        {
+            continue;
+        }
+
+        void* result = NULL;
+        if (size_class->free_list != NULL)
+        {
+            result = size_class->free_list;
+            size_class->free_list = size_class->free_list->next;
+        }
+#if CANARD_ENABLE_LAZY_POOL_INIT
+        else if (size_class->untouched < size_class->end)
+        {
+            result = size_class->untouched;
+            size_class->untouched += PoolBlockSizes[i];
+        }
+#endif
+        else
+        {
+            continue;
+        }
+
+        // Update statistics of the class and of the whole pool
+        size_class->statistics.current_usage_blocks++;
+        if (size_class->statistics.peak_usage_blocks < size_class->statistics.current_usage_blocks)
+        {
+            size_class->statistics.peak_usage_blocks = size_class->statistics.current_usage_blocks;
+        }
+        allocator->statistics.current_usage_blocks++;
+        if (allocator->statistics.peak_usage_blocks < allocator->statistics.current_usage_blocks)
+        {
+            allocator->statistics.peak_usage_blocks = allocator->statistics.current_usage_blocks;
+        }
+
+        return result;
+    }
+
+    return NULL;
+}
+
+CANARD_INTERNAL void freeBlock(CanardPoolAllocator* allocator, void* p)
+{
+    CanardPoolAllocatorBlock* block = (CanardPoolAllocatorBlock*) p;
+
+    // The classes follow each other in the arena, so the first class ending past the block is the owner
+    uint8_t i = 0;
+    while ((const uint8_t*) p >= allocator->size_classes[i].end)
+    {
+        i++;
+        CANARD_ASSERT(i < CANARD_POOL_NUM_SIZE_CLASSES);
+    }
+    CanardPoolSizeClass* const size_class = &allocator->size_classes[i];
+
+    block->next = size_class->free_list;
+    size_class->free_list = block;
+
+    CANARD_ASSERT(size_class->statistics.current_usage_blocks > 0);
+    size_class->statistics.current_usage_blocks--;
+    CANARD_ASSERT(allocator->statistics.current_usage_blocks > 0);
+    allocator->statistics.current_usage_blocks--;
+}
+#else
 CANARD_INTERNAL void initPoolAllocator(CanardPoolAllocator* allocator,
                                        CanardPoolAllocatorBlock* buf,
-                                       uint16_t buf_len)
+                                       CanardPoolBlockCount buf_len)
 {
+#if CANARD_ENABLE_LAZY_POOL_INIT
+    allocator->free_list = NULL;
+    allocator->untouched = buf;
+    allocator->end = buf + buf_len;
+#else
     size_t current_index = 0;
     CanardPoolAllocatorBlock** current_block = &(allocator->free_list);
     while (current_index < buf_len)
@@ -1706,24 +2947,40 @@ CANARD_INTERNAL void initPoolAllocator(CanardPoolAllocator* allocator,
         current_index++;
     }
     *current_block = NULL;
+#endif
 
+    memset(&allocator->statistics, 0, sizeof(allocator->statistics));
     allocator->statistics.capacity_blocks = buf_len;
-    allocator->statistics.current_usage_blocks = 0;
-    allocator->statistics.peak_usage_blocks = 0;
+#if CANARD_ENABLE_POOL_QUOTAS
+    initPoolQuotas(allocator);
+#endif
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+    allocator->custom = NULL;
+#endif
 }
 
 CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator)
 {
-    // Check if there are any blocks available in the free list.
-    if (allocator->free_list == NULL)
+    void* result = NULL;
+    if (allocator->free_list != NULL)
+    {
+        // Take first available block and prepares next block for use.
+        result = allocator->free_list;
+        allocator->free_list = allocator->free_list->next;
+    }
+#if CANARD_ENABLE_LAZY_POOL_INIT
+    else if (allocator->untouched < allocator->end)
+    {
+        // The freed blocks are reused first, so the arena is only touched up to the peak usage
+        result = allocator->untouched;
+        allocator->untouched++;
+    }
+#endif
+    else
     {
         return NULL;
     }
 
-    // Take first available block and prepares next block for use.
-    void* result = allocator->free_list;
-    allocator->free_list = allocator->free_list->next;
-
     // Update statistics
     allocator->statistics.current_usage_blocks++;
     if (allocator->statistics.peak_usage_blocks < allocator->statistics.current_usage_blocks)
@@ -1744,3 +3001,382 @@ CANARD_INTERNAL void freeBlock(CanardPoolAllocator* allocator, void* p)
     CANARD_ASSERT(allocator->statistics.current_usage_blocks > 0);
     allocator->statistics.current_usage_blocks--;
 }
+
+CANARD_INTERNAL void* allocateSizedBlock(CanardPoolAllocator* allocator, size_t size)
+{
+    CANARD_ASSERT(size <= CANARD_MEM_BLOCK_SIZE);
+    (void) size;
+    return allocateBlock(allocator);
+}
+#endif
+
+#if CANARD_ENABLE_POOL_QUOTAS
+CANARD_INTERNAL void initPoolQuotas(CanardPoolAllocator* allocator)
+{
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_CATEGORIES; i++)
+    {
+        allocator->quotas[i].reserved_blocks = 0;
+        allocator->quotas[i].max_blocks = (CanardPoolBlockCount) CANARD_POOL_MAX_BLOCKS;
+    }
+}
+
+CANARD_INTERNAL bool isPoolQuotaAvailable(const CanardPoolAllocator* allocator, CanardPoolCategory category)
+{
+    const CanardPoolCategoryStatistics* const categories = allocator->statistics.categories;
+    if (categories[category].current_usage_blocks >= allocator->quotas[category].max_blocks)
+    {
+        return false;
+    }
+
+    // The free blocks must not be needed to cover the unused reservations of the other categories
+    size_t reserved_for_others = 0;
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_CATEGORIES; i++)
+    {
+        if ((i != (uint8_t)category) && (allocator->quotas[i].reserved_blocks > categories[i].current_usage_blocks))
+        {
+            reserved_for_others += (size_t)(allocator->quotas[i].reserved_blocks - categories[i].current_usage_blocks);
+        }
+    }
+    const size_t free_blocks =
+        (size_t)(allocator->statistics.capacity_blocks - allocator->statistics.current_usage_blocks);
+    return free_blocks > reserved_for_others;
+}
+#endif
+
+CANARD_INTERNAL void initPool(CanardPoolAllocator* allocator, void* arena, size_t arena_size)
+{
+#if CANARD_ENABLE_SIZE_CLASSES
+    initPoolSizeClasses(allocator, arena, arena_size);
+#else
+    size_t pool_capacity = arena_size / CANARD_MEM_BLOCK_SIZE;
+#if SIZE_MAX > CANARD_POOL_MAX_BLOCKS
+    if (pool_capacity > CANARD_POOL_MAX_BLOCKS)
+    {
+        pool_capacity = CANARD_POOL_MAX_BLOCKS;
+    }
+#endif
+
+    initPoolAllocator(allocator, arena, (CanardPoolBlockCount)pool_capacity);
+#endif
+}
+
+#if CANARD_ENABLE_SHARED_POOL
+CANARD_INTERNAL int16_t attachSharedPoolAllocator(CanardInstance* ins,
+                                                  CanardMemoryAllocator* allocator,
+                                                  CanardPoolBlockCount pool_capacity,
+                                                  CanardPoolBlockCount max_blocks)
+{
+    CANARD_ASSERT(ins != NULL);
+
+    const int16_t res = canardSetMemoryAllocator(ins, allocator);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    // The capacity of the instance caps its allocations, see allocateMemory()
+    ins->allocator.statistics.capacity_blocks = (max_blocks < pool_capacity) ? max_blocks : pool_capacity;
+    return CANARD_OK;
+}
+
+CANARD_INTERNAL void* allocateSharedPoolBlock(CanardMemoryAllocator* self, size_t size)
+{
+    CanardSharedPool* const pool = (CanardSharedPool*)(void*) self;
+#if CANARD_ENABLE_LOCK_FREE_POOL
+    CANARD_ASSERT(size <= CANARD_MEM_BLOCK_SIZE);
+    (void) size;
+    return popLockFreeBlock(pool);
+#else
+    return allocateSizedBlock(&pool->pool, size);
+#endif
+}
+
+CANARD_INTERNAL void freeSharedPoolBlock(CanardMemoryAllocator* self, void* pointer)
+{
+    CanardSharedPool* const pool = (CanardSharedPool*)(void*) self;
+#if CANARD_ENABLE_LOCK_FREE_POOL
+    pushLockFreeBlock(pool, pointer);
+#else
+    freeBlock(&pool->pool, pointer);
+#endif
+}
+#endif
+
+#if CANARD_ENABLE_LOCK_FREE_POOL
+CANARD_INTERNAL void initLockFreePool(CanardSharedPool* pool, void* arena, size_t arena_size)
+{
+    size_t pool_capacity = arena_size / CANARD_MEM_BLOCK_SIZE;
+#if SIZE_MAX > CANARD_POOL_MAX_BLOCKS
+    if (pool_capacity > CANARD_POOL_MAX_BLOCKS)
+    {
+        pool_capacity = CANARD_POOL_MAX_BLOCKS;
+    }
+#endif
+
+    pool->blocks = (CanardPoolAllocatorBlock*) arena;
+    memset(&pool->statistics, 0, sizeof(pool->statistics));
+    pool->statistics.capacity_blocks = (CanardPoolBlockCount) pool_capacity;
+#if CANARD_ENABLE_LAZY_POOL_INIT
+    pool->free_list = 0;
+    pool->num_touched = 0;
+#else
+    for (size_t i = 0; i < pool_capacity; i++)
+    {
+        // Links hold the index of the next block plus one, the last block terminates the list with zero
+        *getLockFreeLink(&pool->blocks[i]) = (CanardPoolBlockCount)((i + 1U < pool_capacity) ? (i + 2U) : 0U);
+    }
+    pool->free_list = (pool_capacity > 0U) ? 1U : 0U;
+#endif
+}
+
+CANARD_INTERNAL CanardPoolBlockCount* getLockFreeLink(CanardPoolAllocatorBlock* block)
+{
+    return (CanardPoolBlockCount*)(void*) block;
+}
+
+CANARD_INTERNAL void* popLockFreeBlock(CanardSharedPool* pool)
+{
+    CanardPoolAllocatorBlock* result = NULL;
+    CanardPoolLockFreeHead head = CANARD_ATOMIC_LOAD_ACQUIRE(&pool->free_list);
+    while (LOCK_FREE_HEAD_INDEX(head) != 0U)
+    {
+        CanardPoolAllocatorBlock* const block = &pool->blocks[LOCK_FREE_HEAD_INDEX(head) - 1U];
+        // The block may be taken and written concurrently, then the link is garbage, but the tag fails the exchange;
+        // race detectors report this read of a block that is in use
+        const CanardPoolBlockCount next = CANARD_ATOMIC_LOAD_ACQUIRE(getLockFreeLink(block));
+        if (CANARD_ATOMIC_COMPARE_EXCHANGE_ACQ_REL(&pool->free_list, &head, MAKE_LOCK_FREE_HEAD(head, next)))
+        {
+            result = block;
+            break;
+        }
+    }
+
+#if CANARD_ENABLE_LAZY_POOL_INIT
+    // The freed blocks are reused first, see allocateBlock()
+    CanardPoolBlockCount num_touched = CANARD_ATOMIC_LOAD_ACQUIRE(&pool->num_touched);
+    while ((result == NULL) && (num_touched < pool->statistics.capacity_blocks))
+    {
+        if (CANARD_ATOMIC_COMPARE_EXCHANGE(&pool->num_touched, &num_touched, (CanardPoolBlockCount)(num_touched + 1U)))
+        {
+            result = &pool->blocks[num_touched];
+        }
+    }
+#endif
+
+    if (result != NULL)
+    {
+        const CanardPoolBlockCount usage =
+            (CanardPoolBlockCount)(CANARD_ATOMIC_FETCH_ADD(&pool->statistics.current_usage_blocks, 1U) + 1U);
+        CanardPoolBlockCount peak = CANARD_ATOMIC_LOAD_ACQUIRE(&pool->statistics.peak_usage_blocks);
+        while ((peak < usage) && !CANARD_ATOMIC_COMPARE_EXCHANGE(&pool->statistics.peak_usage_blocks, &peak, usage))
+        {
+            // The peak was updated concurrently, compare again
+        }
+    }
+    return result;
+}
+
+CANARD_INTERNAL void pushLockFreeBlock(CanardSharedPool* pool, void* p)
+{
+    CanardPoolAllocatorBlock* const block = (CanardPoolAllocatorBlock*) p;
+    CANARD_ASSERT((block >= pool->blocks) && (block < &pool->blocks[pool->statistics.capacity_blocks]));
+    const CanardPoolBlockCount index = (CanardPoolBlockCount)((block - pool->blocks) + 1);
+
+    // The usage is decremented while the block is still held, so that it never exceeds the capacity
+    CANARD_ASSERT(CANARD_ATOMIC_LOAD_ACQUIRE(&pool->statistics.current_usage_blocks) > 0);
+    (void) CANARD_ATOMIC_FETCH_SUB(&pool->statistics.current_usage_blocks, 1U);
+
+    CanardPoolLockFreeHead head = CANARD_ATOMIC_LOAD_ACQUIRE(&pool->free_list);
+    do
+    {
+        CANARD_ATOMIC_STORE_RELEASE(getLockFreeLink(block), LOCK_FREE_HEAD_INDEX(head));
+    }
+    while (!CANARD_ATOMIC_COMPARE_EXCHANGE_ACQ_REL(&pool->free_list, &head, MAKE_LOCK_FREE_HEAD(head, index)));
+}
+
+CANARD_INTERNAL void* allocateSharedPoolContextBlock(CanardMemoryAllocator* self, size_t size)
+{
+    CanardSharedPoolContext* const context = (CanardSharedPoolContext*)(void*) self;
+    CANARD_ASSERT(size <= CANARD_MEM_BLOCK_SIZE);
+    (void) size;
+
+    if (context->magazine_size == 0U)
+    {
+        // Refill half of the magazine, so that the next frees do not overflow it right away
+        while (context->magazine_size < (CANARD_POOL_MAGAZINE_SIZE / 2U))
+        {
+            CanardPoolAllocatorBlock* const block = (CanardPoolAllocatorBlock*) popLockFreeBlock(context->pool);
+            if (block == NULL)
+            {
+                break;
+            }
+            block->next = context->magazine;
+            context->magazine = block;
+            context->magazine_size++;
+        }
+        if (context->magazine_size == 0U)
+        {
+            return NULL;
+        }
+    }
+
+    CanardPoolAllocatorBlock* const result = context->magazine;
+    context->magazine = result->next;
+    context->magazine_size--;
+    return result;
+}
+
+CANARD_INTERNAL void freeSharedPoolContextBlock(CanardMemoryAllocator* self, void* pointer)
+{
+    CanardSharedPoolContext* const context = (CanardSharedPoolContext*)(void*) self;
+
+    if (context->magazine_size >= CANARD_POOL_MAGAZINE_SIZE)
+    {
+        flushSharedPoolContext(context, CANARD_POOL_MAGAZINE_SIZE / 2U);
+    }
+
+    CanardPoolAllocatorBlock* const block = (CanardPoolAllocatorBlock*) pointer;
+    block->next = context->magazine;
+    context->magazine = block;
+    context->magazine_size++;
+}
+
+CANARD_INTERNAL void flushSharedPoolContext(CanardSharedPoolContext* context, uint8_t num_blocks)
+{
+    CANARD_ASSERT(num_blocks <= context->magazine_size);
+    for (uint8_t i = 0; i < num_blocks; i++)
+    {
+        CanardPoolAllocatorBlock* const block = context->magazine;
+        context->magazine = block->next;
+        context->magazine_size--;
+        pushLockFreeBlock(context->pool, block);
+    }
+}
+#endif
+
+CANARD_INTERNAL void* allocateMemory(CanardPoolAllocator* allocator, size_t size)
+{
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+    if (allocator->custom != NULL)
+    {
+        if (allocator->statistics.current_usage_blocks >= allocator->statistics.capacity_blocks)
+        {
+            return NULL;
+        }
+
+        void* const result = allocator->custom->allocate(allocator->custom, size);
+        if (result != NULL)
+        {
+            allocator->statistics.current_usage_blocks++;
+            if (allocator->statistics.peak_usage_blocks < allocator->statistics.current_usage_blocks)
+            {
+                allocator->statistics.peak_usage_blocks = allocator->statistics.current_usage_blocks;
+            }
+        }
+        return result;
+    }
+#endif
+    return allocateSizedBlock(allocator, size);
+}
+
+CANARD_INTERNAL void freeMemory(CanardPoolAllocator* allocator, void* p)
+{
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+    if (allocator->custom != NULL)
+    {
+        allocator->custom->deallocate(allocator->custom, p);
+        CANARD_ASSERT(allocator->statistics.current_usage_blocks > 0);
+        allocator->statistics.current_usage_blocks--;
+        return;
+    }
+#endif
+    freeBlock(allocator, p);
+}
+
+CANARD_INTERNAL void* allocatePoolBlock(CanardPoolAllocator* allocator, CanardPoolCategory category, size_t size)
+{
+#if CANARD_ENABLE_POOL_QUOTAS
+    CanardPoolCategoryStatistics* const stats = &allocator->statistics.categories[category];
+    void* const result = isPoolQuotaAvailable(allocator, category) ? allocateMemory(allocator, size) : NULL;
+    if (result == NULL)
+    {
+        stats->failed_allocations++;
+        return NULL;
+    }
+
+    stats->current_usage_blocks++;
+    if (stats->peak_usage_blocks < stats->current_usage_blocks)
+    {
+        stats->peak_usage_blocks = stats->current_usage_blocks;
+    }
+    return result;
+#else
+    (void) category;
+    return allocateMemory(allocator, size);
+#endif
+}
+
+CANARD_INTERNAL void freePoolBlock(CanardPoolAllocator* allocator, CanardPoolCategory category, void* p)
+{
+#if CANARD_ENABLE_POOL_QUOTAS
+    CANARD_ASSERT(allocator->statistics.categories[category].current_usage_blocks > 0);
+    allocator->statistics.categories[category].current_usage_blocks--;
+#else
+    (void) category;
+#endif
+    freeMemory(allocator, p);
+}
+
+#if CANARD_ENABLE_TX_STAGING
+CANARD_INTERNAL CanardTxStagingSlot* acquireTxStagingSlot(CanardTxStaging* staging,
+                                                          const void* payload,
+                                                          uint16_t payload_len)
+{
+    CANARD_ASSERT(staging != NULL);
+    CANARD_ASSERT((payload != NULL) || (payload_len == 0));
+
+    if (payload_len > CANARD_TX_STAGING_MAX_PAYLOAD_SIZE)
+    {
+        return NULL;
+    }
+
+    uint32_t pos = CANARD_ATOMIC_LOAD_ACQUIRE(&staging->enqueue_pos);
+    CanardTxStagingSlot* slot = NULL;
+    for (;;)
+    {
+        slot = &staging->slots[pos & (CANARD_TX_STAGING_CAPACITY - 1U)];
+        const int32_t lag = (int32_t)(CANARD_ATOMIC_LOAD_ACQUIRE(&slot->sequence) - pos);
+        if (lag == 0)
+        {
+            // The slot is free for this lap; claiming it, unless another producer has been faster
+            if (CANARD_ATOMIC_COMPARE_EXCHANGE(&staging->enqueue_pos, &pos, pos + 1U))
+            {
+                break;
+            }
+        }
+        else if (lag < 0)
+        {
+            // The consumer has not drained the slot since the previous lap
+            (void) CANARD_ATOMIC_FETCH_ADD(&staging->overflow_count, 1U);
+            return NULL;
+        }
+        else
+        {
+            pos = CANARD_ATOMIC_LOAD_ACQUIRE(&staging->enqueue_pos);
+        }
+    }
+
+    if (payload_len > 0)
+    {
+        memcpy(slot->payload, payload, payload_len);
+    }
+    slot->payload_len = payload_len;
+    return slot;
+}
+
+CANARD_INTERNAL void commitTxStagingSlot(CanardTxStagingSlot* slot)
+{
+    // The slot was claimed at the enqueue position equal to its sequence number
+    CANARD_ATOMIC_STORE_RELEASE(&slot->sequence, slot->sequence + 1U);
+}
+#endif
@@ -62,6 +62,113 @@ extern "C" {
 #endif
 #endif
 
+/// Use a small lookup table and integer arithmetic for float16 conversions instead of float multiplications.
+/// This is faster on targets without an FPU, where float arithmetic is emulated in software.
+/// The results are the same, except that values exactly halfway between two float16 values are rounded to even.
+#ifndef CANARD_ENABLE_FLOAT16_LUT
+#define CANARD_ENABLE_FLOAT16_LUT                   0
+#endif
+
+/// Use 32-bit block counts in the memory pool, which lifts the limit of 65535 blocks for very large arenas.
+/// The pool statistics are then 32-bit as well, see CanardPoolBlockCount.
+#ifndef CANARD_ENABLE_LARGE_POOL
+#define CANARD_ENABLE_LARGE_POOL                    0
+#endif
+
+/// Initialize the memory pool in constant time: blocks are handed out from the untouched part of the arena, and
+/// only freed blocks are linked into the free list. The arena is then only touched as far as it is actually used,
+/// which saves startup time and page faults with large arenas.
+#ifndef CANARD_ENABLE_LAZY_POOL_INIT
+#define CANARD_ENABLE_LAZY_POOL_INIT                0
+#endif
+
+/// Split the memory pool into size classes of small, medium and large blocks (32, 64 and 128 bytes by default),
+/// so that every TX frame, RX state and RX buffer block takes the smallest block that fits it.
+/// See CANARD_POOL_SMALL_BLOCK_SIZE and the related macros.
+#ifndef CANARD_ENABLE_SIZE_CLASSES
+#define CANARD_ENABLE_SIZE_CLASSES                  0
+#endif
+
+/// Count the memory pool usage per category (TX, RX states, RX payload), and enforce the reserved minimums and the
+/// caps configured with canardSetPoolQuota(), so that e.g. an RX flood cannot starve the TX queue.
+#ifndef CANARD_ENABLE_POOL_QUOTAS
+#define CANARD_ENABLE_POOL_QUOTAS                   0
+#endif
+
+/// When there is no memory for the state of a new incoming transfer, evict the least recently used idle RX state,
+/// or else the in-progress reception of the lowest priority below that of the new transfer.
+/// See canardGetRxEvictionStatistics().
+#ifndef CANARD_ENABLE_RX_STATE_EVICTION
+#define CANARD_ENABLE_RX_STATE_EVICTION             0
+#endif
+
+/// Make CanardSharedPool lock-free, so that instances in different threads or in interrupts can allocate from it
+/// concurrently, and provide CanardSharedPoolContext, a per-context cache of blocks. Needs the shared pool.
+/// Besides the atomics listed for the TX staging queue, it needs CANARD_ATOMIC_FETCH_SUB(ptr, value) and
+/// CANARD_ATOMIC_COMPARE_EXCHANGE_ACQ_REL(ptr, expected_ptr, desired), a compare-exchange with acquire/release
+/// ordering; the GCC/Clang builtins are used by default. The atomic block counts must be lock-free on the target,
+/// which needs a 64-bit compare-exchange with CANARD_ENABLE_LARGE_POOL; with the builtins, a target without one is
+/// rejected at compile time instead of silently falling back to the locks of libatomic.
+#ifndef CANARD_ENABLE_LOCK_FREE_POOL
+#define CANARD_ENABLE_LOCK_FREE_POOL                0
+#endif
+
+/// Maximum number of free blocks cached by a CanardSharedPoolContext, an even number from 2 to 254.
+#ifndef CANARD_POOL_MAGAZINE_SIZE
+#define CANARD_POOL_MAGAZINE_SIZE                   8U
+#endif
+
+/// Allow several instances to allocate from one memory pool, see CanardSharedPool. Needs the custom allocator.
+#ifndef CANARD_ENABLE_SHARED_POOL
+#define CANARD_ENABLE_SHARED_POOL                   CANARD_ENABLE_LOCK_FREE_POOL
+#endif
+
+/// Allow the application to replace the memory pool with its own allocator, see canardSetMemoryAllocator().
+/// Without this option the library uses the built-in pool directly, at no extra cost.
+#ifndef CANARD_ENABLE_CUSTOM_ALLOCATOR
+#define CANARD_ENABLE_CUSTOM_ALLOCATOR              CANARD_ENABLE_SHARED_POOL
+#endif
+
+#if CANARD_ENABLE_SHARED_POOL && !CANARD_ENABLE_CUSTOM_ALLOCATOR
+# error "CANARD_ENABLE_SHARED_POOL needs CANARD_ENABLE_CUSTOM_ALLOCATOR"
+#endif
+
+#if CANARD_ENABLE_LOCK_FREE_POOL && !CANARD_ENABLE_SHARED_POOL
+# error "CANARD_ENABLE_LOCK_FREE_POOL needs CANARD_ENABLE_SHARED_POOL"
+#endif
+#if CANARD_ENABLE_LOCK_FREE_POOL && CANARD_ENABLE_SIZE_CLASSES
+# error "CANARD_ENABLE_LOCK_FREE_POOL does not support CANARD_ENABLE_SIZE_CLASSES"
+#endif
+
+/// Provide the lock-free single-producer/single-consumer RX frame ring, see CanardRxRing.
+/// It needs atomic loads and stores with acquire/release ordering; by default the GCC/Clang builtins are used,
+/// other compilers must define CANARD_ATOMIC_LOAD_ACQUIRE(ptr) and CANARD_ATOMIC_STORE_RELEASE(ptr, value).
+#ifndef CANARD_ENABLE_RX_RING
+#define CANARD_ENABLE_RX_RING                       0
+#endif
+
+/// Number of frames that the RX ring can hold, a power of two not greater than 32768.
+#ifndef CANARD_RX_RING_CAPACITY
+#define CANARD_RX_RING_CAPACITY                     32U
+#endif
+
+/// Provide the lock-free multi-producer TX staging queue, see CanardTxStaging.
+/// Besides the atomics listed for the RX ring, it needs CANARD_ATOMIC_COMPARE_EXCHANGE(ptr, expected_ptr, desired)
+/// and CANARD_ATOMIC_FETCH_ADD(ptr, value); the GCC/Clang builtins are used by default.
+#ifndef CANARD_ENABLE_TX_STAGING
+#define CANARD_ENABLE_TX_STAGING                    0
+#endif
+
+/// Number of transfers that the TX staging queue can hold, a power of two not greater than 32768.
+#ifndef CANARD_TX_STAGING_CAPACITY
+#define CANARD_TX_STAGING_CAPACITY                  32U
+#endif
+
+/// Maximum payload of a staged transfer, in bytes. Every slot of the staging queue reserves this much memory.
+#ifndef CANARD_TX_STAGING_MAX_PAYLOAD_SIZE
+#define CANARD_TX_STAGING_MAX_PAYLOAD_SIZE          64U
+#endif
+
 /// By default this macro resolves to the standard assert(). The user can redefine this if necessary.
 #ifndef CANARD_ASSERT
 # define CANARD_ASSERT(x)   assert(x)
@@ -97,13 +204,60 @@ extern "C" {
 #define CANARD_ERROR_RX_SHORT_FRAME                    16
 #define CANARD_ERROR_RX_BAD_CRC                        17
 
+#if CANARD_ENABLE_SIZE_CLASSES
+/// Block sizes of the pool size classes in bytes, in ascending order. Each must be a multiple of 8.
+#ifndef CANARD_POOL_SMALL_BLOCK_SIZE
+#define CANARD_POOL_SMALL_BLOCK_SIZE                32U
+#endif
+#ifndef CANARD_POOL_MEDIUM_BLOCK_SIZE
+#define CANARD_POOL_MEDIUM_BLOCK_SIZE               64U
+#endif
+#ifndef CANARD_POOL_LARGE_BLOCK_SIZE
+#define CANARD_POOL_LARGE_BLOCK_SIZE                128U
+#endif
+#define CANARD_POOL_NUM_SIZE_CLASSES                3U
+
+/// Shares of the memory arena that canardInit() gives to the small and the medium size classes, in percent.
+/// The large size class gets the rest of the arena.
+#ifndef CANARD_POOL_SMALL_SHARE_PERCENT
+#define CANARD_POOL_SMALL_SHARE_PERCENT             30U
+#endif
+#ifndef CANARD_POOL_MEDIUM_SHARE_PERCENT
+#define CANARD_POOL_MEDIUM_SHARE_PERCENT            40U
+#endif
+
+/// The size of the largest memory block in bytes.
+#define CANARD_MEM_BLOCK_SIZE                       CANARD_POOL_LARGE_BLOCK_SIZE
+
+/// Block sizes of RX transfer states and RX buffer blocks. The allocator rounds them up to the nearest size class.
+/// The RX state needs 27 bytes for its fields on 32-bit platforms and 35 bytes on 64-bit platforms, the rest of
+/// the block holds the payload head. The buffer blocks are larger than the smallest class to keep the chains short.
+#ifndef CANARD_RX_STATE_BLOCK_SIZE
+#if UINTPTR_MAX > 0xFFFFFFFFU
+#define CANARD_RX_STATE_BLOCK_SIZE                  CANARD_POOL_MEDIUM_BLOCK_SIZE
+#else
+#define CANARD_RX_STATE_BLOCK_SIZE                  CANARD_POOL_SMALL_BLOCK_SIZE
+#endif
+#endif
+#ifndef CANARD_BUFFER_BLOCK_SIZE
+#define CANARD_BUFFER_BLOCK_SIZE                    CANARD_POOL_MEDIUM_BLOCK_SIZE
+#endif
+#else
 /// The size of a memory block in bytes.
+/// The RX transfer state holds two pointers, so on platforms with 64-bit pointers the blocks are 8 bytes larger
+/// to keep the same payload head size as on 32-bit platforms.
 #if CANARD_ENABLE_CANFD
 #define CANARD_MEM_BLOCK_SIZE                       128U
+#elif UINTPTR_MAX > 0xFFFFFFFFU
+#define CANARD_MEM_BLOCK_SIZE                       40U
 #else
 #define CANARD_MEM_BLOCK_SIZE                       32U
 #endif
 
+#define CANARD_RX_STATE_BLOCK_SIZE                  CANARD_MEM_BLOCK_SIZE
+#define CANARD_BUFFER_BLOCK_SIZE                    CANARD_MEM_BLOCK_SIZE
+#endif
+
 #define CANARD_CAN_FRAME_MAX_DATA_LEN               8U
 #if CANARD_ENABLE_CANFD
 #define CANARD_CANFD_FRAME_MAX_DATA_LEN             64U
@@ -115,14 +269,18 @@ extern "C" {
 #define CANARD_MAX_NODE_ID                          127
 
 /// Refer to the type CanardRxTransfer
-#define CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE      (CANARD_MEM_BLOCK_SIZE - offsetof(CanardRxState, buffer_head))
+#define CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE      (CANARD_RX_STATE_BLOCK_SIZE - offsetof(CanardRxState, buffer_head))
 
 /// Refer to the type CanardBufferBlock
-#define CANARD_BUFFER_BLOCK_DATA_SIZE               (CANARD_MEM_BLOCK_SIZE - offsetof(CanardBufferBlock, data))
+#define CANARD_BUFFER_BLOCK_DATA_SIZE               (CANARD_BUFFER_BLOCK_SIZE - offsetof(CanardBufferBlock, data))
 
 /// Refer to canardCleanupStaleTransfers() for details.
 #define CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC     1000000U
 
+/// Default reception timeouts, refer to CanardRxTimeouts.
+#define CANARD_DEFAULT_TRANSFER_TIMEOUT_USEC        2000000U
+#define CANARD_DEFAULT_IFACE_SWITCH_DELAY_USEC      1000000U
+
 /// Transfer priority definitions
 #define CANARD_TRANSFER_PRIORITY_HIGHEST            0
 #define CANARD_TRANSFER_PRIORITY_HIGH               8
@@ -143,6 +301,8 @@ extern "C" {
 
 /**
  * This data type holds a standard CAN 2.0B data frame with 29-bit ID.
+ * With CANARD_ENABLE_SIZE_CLASSES the data go last, so that the TX queue can store a frame in a block that only
+ * fits data_len bytes of data; canardPeekTxQueue() still returns a complete frame.
  */
 typedef struct
 {
@@ -153,10 +313,12 @@ typedef struct
      *  - CANARD_CAN_FRAME_ERR
      */
     uint32_t id;
+#if !CANARD_ENABLE_SIZE_CLASSES
 #if CANARD_ENABLE_CANFD
     uint8_t data[CANARD_CANFD_FRAME_MAX_DATA_LEN];
 #else
     uint8_t data[CANARD_CAN_FRAME_MAX_DATA_LEN];
+#endif
 #endif
     uint8_t data_len;
     uint8_t iface_id;
@@ -165,6 +327,14 @@ typedef struct
 #endif
 #if CANARD_ENABLE_CANFD
     bool canfd;
+    bool brs;                   ///< Bit rate switch, the data phase of a CAN FD frame uses the faster bit rate
+#endif
+#if CANARD_ENABLE_SIZE_CLASSES
+#if CANARD_ENABLE_CANFD
+    uint8_t data[CANARD_CANFD_FRAME_MAX_DATA_LEN];
+#else
+    uint8_t data[CANARD_CAN_FRAME_MAX_DATA_LEN];
+#endif
 #endif
 } CanardCANFrame;
 
@@ -187,6 +357,93 @@ typedef enum
     CanardRequest
 } CanardRequestResponse;
 
+/**
+ * A transfer that the application accepts, see canardComputeAcceptanceFilters().
+ */
+typedef struct
+{
+    uint16_t data_type_id;
+    CanardTransferType transfer_type;
+} CanardAcceptedTransfer;
+
+/**
+ * ID and mask of a CAN acceptance filter. A frame is accepted if (frame_id & mask) == (id & mask).
+ * Both fields use the CanardCANFrame ID format, including the flags CANARD_CAN_FRAME_EFF and CANARD_CAN_FRAME_RTR.
+ */
+typedef struct
+{
+    uint32_t id;
+    uint32_t mask;
+} CanardAcceptanceFilter;
+
+#if CANARD_ENABLE_RX_RING
+/**
+ * A received frame with its reception timestamp, see CanardRxRing.
+ */
+typedef struct
+{
+    CanardCANFrame frame;                       ///< The frame, including the iface_id
+    uint64_t timestamp_usec;
+} CanardRxRingEntry;
+
+/**
+ * Fixed-size lock-free single-producer/single-consumer ring of received frames.
+ * The producer, e.g. the CAN interrupt handler or a driver thread, pushes the frames with canardRxRingPush(),
+ * which takes constant time and never blocks. The consumer, e.g. the main loop, passes them to the library with
+ * canardRxRingDrain(), so that the reassembly and the application callbacks do not run in the producer's context.
+ * Every field is written either by the producer or by the consumer only; the fields must not be accessed directly.
+ */
+typedef struct
+{
+    uint16_t head;                              ///< Free running index of the next entry to push, producer side
+    uint32_t overflow_count;                    ///< Frames dropped because the ring was full, producer side
+    CanardRxRingEntry entries[CANARD_RX_RING_CAPACITY];
+    uint16_t tail;                              ///< Free running index of the next entry to pop, consumer side
+} CanardRxRing;
+#endif
+
+#if CANARD_ENABLE_TX_STAGING
+/**
+ * A serialized transfer waiting in CanardTxStaging, with the arguments of canardBroadcast() or
+ * canardRequestOrRespond().
+ */
+typedef struct
+{
+    uint32_t sequence;                          ///< Tells whether the slot is free or filled, see CanardTxStaging
+    uint64_t data_type_signature;
+    uint16_t data_type_id;
+    uint16_t payload_len;
+    uint8_t transfer_id;
+    uint8_t priority;
+    uint8_t destination_node_id;                ///< CANARD_BROADCAST_NODE_ID for message transfers
+    uint8_t request_response;                   ///< CanardRequestResponse, if destination_node_id is set
+#if CANARD_MULTI_IFACE
+    uint8_t iface_mask;
+#endif
+#if CANARD_ENABLE_CANFD
+    bool canfd;
+#endif
+    uint8_t payload[CANARD_TX_STAGING_MAX_PAYLOAD_SIZE];
+} CanardTxStagingSlot;
+
+/**
+ * Fixed-size lock-free multi-producer/single-consumer queue of outgoing transfers.
+ * Any number of threads stage transfers with canardTxStagingBroadcast() or canardTxStagingRequestOrRespond(),
+ * which never block and never touch the library instance. The thread that owns the instance, normally the IO
+ * thread, moves them into the TX queue with canardTxStagingDrain() before it transmits.
+ * Every slot carries a sequence number that hands it over between the producers and the consumer, so that
+ * a producer that is preempted while filling its slot delays only the transfers staged after it.
+ * The fields must not be accessed directly.
+ */
+typedef struct
+{
+    uint32_t enqueue_pos;                       ///< Free running index of the next slot to fill, shared by producers
+    uint32_t overflow_count;                    ///< Transfers rejected because the queue was full
+    CanardTxStagingSlot slots[CANARD_TX_STAGING_CAPACITY];
+    uint32_t dequeue_pos;                       ///< Free running index of the next slot to drain, consumer side
+} CanardTxStaging;
+#endif
+
 /*
  * Forward declarations.
  */
@@ -219,6 +476,34 @@ typedef bool (* CanardShouldAcceptTransfer)(const CanardInstance* ins,
 typedef void (* CanardOnTransferReception)(CanardInstance* ins,                 ///< Library instance
                                            CanardRxTransfer* transfer);         ///< Ptr to temporary transfer object
 
+/**
+ * Timeouts of the reception of transfers, see canardSetRxTimeouts().
+ */
+typedef struct
+{
+    /// The RX state of a transfer is removed, and the next transfer is accepted with any transfer ID, once no frame
+    /// was received for this long. Shorter timeouts free the pool memory sooner; the timeout should still exceed
+    /// the transmission interval of the transfer.
+    uint32_t transfer_timeout_usec;
+
+    /// A new transfer is accepted from another interface once no frame was received for this long, so that the
+    /// reception fails over to a redundant interface.
+    uint32_t iface_switch_delay_usec;
+} CanardRxTimeouts;
+
+/**
+ * Optional callback that adjusts the reception timeouts of a subscription, see canardSetRxTimeouts().
+ * The timeouts are initialized with the instance defaults.
+ * The library calls it for every received frame and for every RX state in canardCleanupStaleTransfers() and
+ * canardGetNextDeadline(), rather than storing the timeouts in every RX state. Hence it must run in constant time,
+ * e.g. a switch or a table lookup, must not have side effects, and must return the same timeouts for the same
+ * data type and transfer type.
+ */
+typedef void (* CanardGetRxTimeouts)(const CanardInstance* ins,                 ///< Library instance
+                                     uint16_t data_type_id,                     ///< Refer to the specification
+                                     CanardTransferType transfer_type,          ///< Refer to CanardTransferType
+                                     CanardRxTimeouts* inout_timeouts);         ///< Timeouts of the subscription
+
 /**
  * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
  * A memory block used in the memory block allocator.
@@ -229,26 +514,193 @@ typedef union CanardPoolAllocatorBlock_u
     union CanardPoolAllocatorBlock_u* next;
 } CanardPoolAllocatorBlock;
 
+/**
+ * Number of blocks in the memory pool; canardInit() uses at most CANARD_POOL_MAX_BLOCKS blocks of the arena.
+ */
+#if CANARD_ENABLE_LARGE_POOL
+typedef uint32_t CanardPoolBlockCount;
+#define CANARD_POOL_MAX_BLOCKS                      0xFFFFFFFFUL
+#else
+typedef uint16_t CanardPoolBlockCount;
+#define CANARD_POOL_MAX_BLOCKS                      0xFFFFU
+#endif
+
+/**
+ * Users of the memory pool, see CANARD_ENABLE_POOL_QUOTAS.
+ */
+typedef enum
+{
+    CanardPoolCategoryTx,                       ///< TX queue items
+    CanardPoolCategoryRxState,                  ///< RX transfer states
+    CanardPoolCategoryRxPayload                 ///< RX payload buffer blocks
+} CanardPoolCategory;
+
+#define CANARD_POOL_NUM_CATEGORIES                  3U
+
+#if CANARD_ENABLE_POOL_QUOTAS
+/**
+ * Usage statistics of one category of the memory pool.
+ */
+typedef struct
+{
+    CanardPoolBlockCount current_usage_blocks;  ///< Number of blocks that are currently allocated to the category
+    CanardPoolBlockCount peak_usage_blocks;     ///< Maximum number of blocks used since initialization
+    uint32_t failed_allocations;                ///< Allocations denied by the quotas or failed on an empty pool
+} CanardPoolCategoryStatistics;
+
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ * Quota of one category of the memory pool, see canardSetPoolQuota().
+ */
+typedef struct
+{
+    CanardPoolBlockCount reserved_blocks;
+    CanardPoolBlockCount max_blocks;
+} CanardPoolQuota;
+#endif
+
 /**
  * This structure provides usage statistics of the memory pool allocator.
  * This data helps to evaluate whether the allocated memory is sufficient for the application.
  */
 typedef struct
 {
-    uint16_t capacity_blocks;               ///< Pool capacity in number of blocks
-    uint16_t current_usage_blocks;          ///< Number of blocks that are currently allocated by the library
-    uint16_t peak_usage_blocks;             ///< Maximum number of blocks used since initialization
+    CanardPoolBlockCount capacity_blocks;       ///< Pool capacity in number of blocks
+    CanardPoolBlockCount current_usage_blocks;  ///< Number of blocks that are currently allocated by the library
+    CanardPoolBlockCount peak_usage_blocks;     ///< Maximum number of blocks used since initialization
+#if CANARD_ENABLE_POOL_QUOTAS
+    /// Usage per category, indexed by CanardPoolCategory; only set in the statistics of the whole pool
+    CanardPoolCategoryStatistics categories[CANARD_POOL_NUM_CATEGORIES];
+#endif
 } CanardPoolAllocatorStatistics;
 
+#if CANARD_ENABLE_SIZE_CLASSES
 /**
  * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ * Blocks of one size, carved from a contiguous part of the memory arena.
  */
 typedef struct
 {
     CanardPoolAllocatorBlock* free_list;
+#if CANARD_ENABLE_LAZY_POOL_INIT
+    uint8_t* untouched;                             ///< First block that was never allocated
+#endif
+    const uint8_t* end;                             ///< Past the last block of this class
     CanardPoolAllocatorStatistics statistics;
+} CanardPoolSizeClass;
+#endif
+
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+typedef struct CanardMemoryAllocator CanardMemoryAllocator;
+
+/**
+ * Memory allocator provided by the application, see canardSetMemoryAllocator().
+ * The functions receive the pointer to this structure, which the application can embed into its own allocator
+ * state. The library calls them from the same contexts as the other calls on the instance.
+ */
+struct CanardMemoryAllocator
+{
+    /// Returns a block of at least size bytes aligned like the memory arena of canardInit(), or NULL.
+    /// The size never exceeds CANARD_MEM_BLOCK_SIZE.
+    void* (* allocate)(CanardMemoryAllocator* self, size_t size);
+
+    /// Releases a block returned by allocate().
+    void (* deallocate)(CanardMemoryAllocator* self, void* pointer);
+};
+#endif
+
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ */
+typedef struct
+{
+#if CANARD_ENABLE_SIZE_CLASSES
+    CanardPoolSizeClass size_classes[CANARD_POOL_NUM_SIZE_CLASSES];     ///< In ascending order of block size
+#else
+    CanardPoolAllocatorBlock* free_list;
+#if CANARD_ENABLE_LAZY_POOL_INIT
+    CanardPoolAllocatorBlock* untouched;            ///< First block that was never allocated
+    CanardPoolAllocatorBlock* end;                  ///< Past the last block of the arena
+#endif
+#endif
+    CanardPoolAllocatorStatistics statistics;       ///< With size classes, blocks of all sizes are counted together
+#if CANARD_ENABLE_POOL_QUOTAS
+    CanardPoolQuota quotas[CANARD_POOL_NUM_CATEGORIES];
+#endif
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+    CanardMemoryAllocator* custom;                  ///< Replaces the blocks of the arena if not NULL
+#endif
 } CanardPoolAllocator;
 
+#if CANARD_ENABLE_LOCK_FREE_POOL
+/**
+ * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
+ * Head of the lock-free free list: the index of the first free block plus one in the low half, zero if the list
+ * is empty, and a generation tag in the high half, incremented on every change to detect ABA races.
+ * The head is 64 bits wide, with a 32-bit tag, whenever the target has a lock-free 64-bit compare-exchange.
+ * Otherwise the tag has only 16 bits: a thread that is preempted between reading the head and swapping it may then
+ * be fooled if exactly a multiple of 65536 allocations and releases happen in between and the same block is on top.
+ */
+#if CANARD_ENABLE_LARGE_POOL && !defined(CANARD_ATOMIC_COMPARE_EXCHANGE_ACQ_REL) && \
+    defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE != 2)
+# error "CANARD_ENABLE_LARGE_POOL needs a lock-free 64-bit compare-exchange for CANARD_ENABLE_LOCK_FREE_POOL"
+#endif
+#if CANARD_ENABLE_LARGE_POOL || (defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2))
+typedef uint64_t CanardPoolLockFreeHead;
+#else
+typedef uint32_t CanardPoolLockFreeHead;
+#endif
+#endif
+
+#if CANARD_ENABLE_SHARED_POOL
+/**
+ * Memory pool that several instances can allocate from, e.g. one instance per bus of a gateway, so that the arena
+ * only has to cover the peaks of all buses together rather than the sum of the peaks.
+ * The fields should not be accessed directly; see canardInitSharedPool().
+ */
+typedef struct
+{
+    CanardMemoryAllocator base;                     ///< Must be the first field
+#if CANARD_ENABLE_LOCK_FREE_POOL
+    CanardPoolAllocatorBlock* blocks;               ///< The arena; the free list links the blocks by index
+    CanardPoolLockFreeHead free_list;
+#if CANARD_ENABLE_LAZY_POOL_INIT
+    CanardPoolBlockCount num_touched;               ///< Blocks from this index on were never allocated
+#endif
+    CanardPoolAllocatorStatistics statistics;       ///< Updated atomically
+#else
+    CanardPoolAllocator pool;
+#endif
+} CanardSharedPool;
+#endif
+
+#if CANARD_ENABLE_LOCK_FREE_POOL
+/**
+ * Cache of free blocks of a CanardSharedPool for one execution context, e.g. an interrupt or a thread, so that most
+ * allocations and deallocations do not touch the shared free list. A context must only be used from one execution
+ * context at a time; the instances attached to it must be used from that context as well.
+ * The fields should not be accessed directly; see canardInitSharedPoolContext().
+ */
+typedef struct
+{
+    CanardMemoryAllocator base;                     ///< Must be the first field
+    CanardSharedPool* pool;
+    CanardPoolAllocatorBlock* magazine;             ///< Cached free blocks
+    uint8_t magazine_size;
+} CanardSharedPoolContext;
+#endif
+
+#if CANARD_ENABLE_RX_STATE_EVICTION
+/**
+ * Numbers of RX states evicted since initialization, see CANARD_ENABLE_RX_STATE_EVICTION.
+ */
+typedef struct
+{
+    uint32_t idle_states;                   ///< States between transfers, which only kept the expected transfer ID
+    uint32_t in_progress_states;            ///< States of lower priority transfers whose reception was aborted
+} CanardRxEvictionStatistics;
+#endif
+
 /**
  * INTERNAL DEFINITION, DO NOT USE DIRECTLY.
  * Buffer block for received data.
@@ -280,10 +732,14 @@ struct CanardRxState
 
     uint16_t payload_crc;
     uint8_t  iface_id;
+#if CANARD_ENABLE_RX_STATE_EVICTION
+    uint8_t  priority;              // Of the transfer in progress
+#endif
     uint8_t buffer_head[];
 };
-CANARD_STATIC_ASSERT(offsetof(CanardRxState, buffer_head) <= 28, "Invalid memory layout");
-CANARD_STATIC_ASSERT(CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE >= 4, "Invalid memory layout");
+CANARD_STATIC_ASSERT(offsetof(CanardRxState, buffer_head) <= CANARD_RX_STATE_BLOCK_SIZE - 4U, "Invalid memory layout");
+CANARD_STATIC_ASSERT(CANARD_RX_STATE_BLOCK_SIZE <= CANARD_MEM_BLOCK_SIZE, "Invalid memory layout");
+CANARD_STATIC_ASSERT(CANARD_BUFFER_BLOCK_SIZE <= CANARD_MEM_BLOCK_SIZE, "Invalid memory layout");
 
 /**
  * This is the core structure that keeps all of the states and allocated resources of the library instance.
@@ -306,6 +762,19 @@ struct CanardInstance
 #if CANARD_ENABLE_TAO_OPTION
     bool tao_disabled;                              ///< True if TAO is disabled
 #endif
+#if CANARD_ENABLE_CANFD
+    bool brs_disabled;                              ///< True if CAN FD frames are sent without bit rate switch
+#endif
+#if CANARD_ENABLE_SIZE_CLASSES
+    CanardCANFrame tx_head_frame;                   ///< Complete copy of the trimmed frame at the TX queue head
+#endif
+
+    CanardRxTimeouts rx_timeouts;                   ///< Default reception timeouts
+    CanardGetRxTimeouts get_rx_timeouts;            ///< Optional per-subscription timeouts, may be NULL
+
+#if CANARD_ENABLE_RX_STATE_EVICTION
+    CanardRxEvictionStatistics rx_evictions;        ///< RX states evicted to make room for new transfers
+#endif
 };
 
 /**
@@ -372,6 +841,9 @@ struct CanardRxTransfer
  * Typically, size of the memory pool should not be less than 1K, although it depends on the application. The
  * recommended way to detect the required pool size is to measure the peak pool usage after a stress-test. Refer to
  * the function canardGetPoolAllocatorStatistics().
+ *
+ * With CANARD_ENABLE_SIZE_CLASSES, the arena is split between the size classes according to
+ * CANARD_POOL_SMALL_SHARE_PERCENT and CANARD_POOL_MEDIUM_SHARE_PERCENT.
  */
 void canardInit(CanardInstance* out_ins,                    ///< Uninitialized library instance
                 void* mem_arena,                            ///< Raw memory chunk used for dynamic allocation
@@ -380,6 +852,25 @@ void canardInit(CanardInstance* out_ins,                    ///< Uninitialized l
                 CanardShouldAcceptTransfer should_accept,   ///< Callback, see CanardShouldAcceptTransfer
                 void* user_reference);                      ///< Optional pointer for user's convenience, can be NULL
 
+/**
+ * Sets the reception timeouts of the instance, which default to CANARD_DEFAULT_TRANSFER_TIMEOUT_USEC and
+ * CANARD_DEFAULT_IFACE_SWITCH_DELAY_USEC. If get_subscription_timeouts is not NULL, it can adjust the timeouts
+ * per data type, e.g. a few tens of milliseconds for messages published at 100 Hz.
+ * The timeouts apply to the existing RX states as well.
+ */
+void canardSetRxTimeouts(CanardInstance* ins,
+                         CanardRxTimeouts timeouts,
+                         CanardGetRxTimeouts get_subscription_timeouts);
+
+#if CANARD_ENABLE_CANFD
+/**
+ * Selects whether the CAN FD frames queued from now on use the bit rate switch (BRS), i.e. send their data phase
+ * at the faster data bit rate. Enabled by default; disable it on buses where not all nodes support the data bit rate.
+ * The flag is passed to the driver in CanardCANFrame.brs. Classic CAN frames never use it.
+ */
+void canardSetCanFdBitRateSwitch(CanardInstance* ins, bool enabled);
+#endif
+
 /**
  * Returns the value of the user pointer.
  * The user pointer is configured once during initialization.
@@ -475,6 +966,7 @@ int16_t canardRequestOrRespond(CanardInstance* ins,             ///< Library ins
  * Returns NULL if the TX queue is empty.
  * The application will call this function after canardBroadcast() or canardRequestOrRespond() to transmit generated
  * frames over the CAN bus.
+ * With CANARD_ENABLE_SIZE_CLASSES the frame is a complete copy kept by the instance, since the queue items are trimmed.
  */
 const CanardCANFrame* canardPeekTxQueue(const CanardInstance* ins);
 
@@ -497,13 +989,164 @@ int16_t canardHandleRxFrame(CanardInstance* ins,
                             uint64_t timestamp_usec);
 
 /**
- * Traverses the list of transfers and removes those that were last updated more than timeout_usec microseconds ago.
+ * Computes CAN acceptance filters that let through the frames of the accepted transfers, so that the unwanted
+ * frames can be dropped by the CAN controller or the kernel before they reach canardHandleRxFrame().
+ *
+ * Service transfers are accepted only if they are addressed to local_node_id; none are accepted if the local
+ * node ID is CANARD_BROADCAST_NODE_ID, so the filters must be recomputed once the node ID is set.
+ * Broadcast transfers with data type IDs that fit anonymous transfers are accepted from anonymous nodes too.
+ *
+ * Every accepted transfer needs one filter, anonymous-capable broadcast transfers need two. If there are more
+ * than max_filters of them, the filters that let through the fewest unwanted CAN IDs when merged are merged,
+ * so frames of the accepted transfers are never rejected, but some unwanted frames may pass.
+ * No filters are needed if no transfers are accepted, which means that all frames should be rejected.
+ *
+ * The filters can be passed e.g. to socketcanConfigureAcceptanceFilters() or
+ * canardSTM32ConfigureAcceptanceFilters() of the drivers.
+ *
+ * Returns the number of filters written to out_filters, or negated error code, such as invalid argument.
+ */
+int16_t canardComputeAcceptanceFilters(const CanardAcceptedTransfer* accepted_transfers,
+                                       uint16_t num_accepted_transfers,
+                                       uint8_t local_node_id,
+                                       CanardAcceptanceFilter* out_filters,
+                                       uint8_t max_filters);
+
+/**
+ * Traverses the list of transfers and removes those that were last updated more than the transfer timeout ago,
+ * see canardSetRxTimeouts().
  * This function must be invoked by the application periodically, about once a second.
  * Also refer to the constant CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC.
+ * Alternatively, a tickless application invokes it only once the time returned by canardGetNextDeadline() is reached.
  */
 void canardCleanupStaleTransfers(CanardInstance* ins,
                                  uint64_t current_time_usec);
 
+/**
+ * Returns the earliest time when the library has work to do that is not triggered by a received frame, so that
+ * a tickless application can sleep until then unless a frame arrives. The time is in the time base of the frame
+ * timestamps passed to canardHandleRxFrame().
+ *
+ * The only such event is the expiry of the oldest transfer reception state, which is then to be removed with
+ * canardCleanupStaleTransfers(); the library does not schedule transmissions by itself.
+ * Returns UINT64_MAX if there is no pending event.
+ */
+uint64_t canardGetNextDeadline(const CanardInstance* ins);
+
+#if CANARD_ENABLE_RX_STATE_EVICTION
+/**
+ * Returns the numbers of RX states evicted to make room for the states of new transfers.
+ * An evicted idle state is recreated by the next transfer from that source like after a timeout; an evicted
+ * in-progress state loses the transfer it was reassembling.
+ */
+CanardRxEvictionStatistics canardGetRxEvictionStatistics(const CanardInstance* ins);
+#endif
+
+#if CANARD_ENABLE_RX_RING
+/**
+ * Initializes an empty RX ring. Must be called before the producer and the consumer start.
+ */
+void canardRxRingInit(CanardRxRing* ring);
+
+/**
+ * Producer side: copies the frame and its timestamp into the ring.
+ * Safe to call from an interrupt handler or from another thread than the consumer; wait-free.
+ * Returns true on success, false if the ring is full; the frame is then dropped and counted as an overflow.
+ */
+bool canardRxRingPush(CanardRxRing* ring,
+                      const CanardCANFrame* frame,
+                      uint64_t timestamp_usec);
+
+/**
+ * Consumer side: takes the oldest frame from the ring.
+ * Returns true if a frame was taken, false if the ring is empty.
+ */
+bool canardRxRingPop(CanardRxRing* ring,
+                     CanardCANFrame* out_frame,
+                     uint64_t* out_timestamp_usec);
+
+/**
+ * Consumer side: passes up to max_frames frames from the ring to canardHandleRxFrame(), in the order of reception.
+ * The frames are handled in place, every entry is released to the producer right after its frame is handled.
+ * Returns the number of frames handled.
+ */
+uint16_t canardRxRingDrain(CanardRxRing* ring,
+                           CanardInstance* ins,
+                           uint16_t max_frames);
+
+/**
+ * Returns the number of frames that were dropped because the ring was full. Can be called from either side.
+ */
+uint32_t canardRxRingGetOverflowCount(const CanardRxRing* ring);
+#endif
+
+#if CANARD_ENABLE_TX_STAGING
+/**
+ * Initializes an empty TX staging queue. Must be called before any producer or the consumer start.
+ */
+void canardTxStagingInit(CanardTxStaging* staging);
+
+/**
+ * Producer side: stages a message transfer, which canardTxStagingDrain() will later pass to canardBroadcast().
+ * The payload is copied, and inout_transfer_id is incremented right away, so every publishing thread must use its
+ * own transfer ID variables. Safe to call from any number of threads concurrently; lock-free.
+ *
+ * Returns zero on success, -CANARD_ERROR_INVALID_ARGUMENT if the payload does not fit in a slot, or
+ * -CANARD_ERROR_OUT_OF_MEMORY if the queue is full; the transfer is then counted as an overflow.
+ * Errors detected by canardBroadcast() itself are reported by canardTxStagingDrain().
+ */
+int16_t canardTxStagingBroadcast(CanardTxStaging* staging,
+                                 uint64_t data_type_signature,
+                                 uint16_t data_type_id,
+                                 uint8_t* inout_transfer_id,
+                                 uint8_t priority,
+                                 const void* payload,
+                                 uint16_t payload_len
+#if CANARD_MULTI_IFACE
+                                 ,uint8_t iface_mask
+#endif
+#if CANARD_ENABLE_CANFD
+                                 ,bool canfd
+#endif
+);
+
+/**
+ * Producer side: stages a service transfer, which canardTxStagingDrain() will later pass to
+ * canardRequestOrRespond(). Same rules as canardTxStagingBroadcast(); the transfer ID of a response is not altered.
+ */
+int16_t canardTxStagingRequestOrRespond(CanardTxStaging* staging,
+                                        uint8_t destination_node_id,
+                                        uint64_t data_type_signature,
+                                        uint8_t data_type_id,
+                                        uint8_t* inout_transfer_id,
+                                        uint8_t priority,
+                                        CanardRequestResponse kind,
+                                        const void* payload,
+                                        uint16_t payload_len
+#if CANARD_MULTI_IFACE
+                                        ,uint8_t iface_mask
+#endif
+#if CANARD_ENABLE_CANFD
+                                        ,bool canfd
+#endif
+);
+
+/**
+ * Consumer side: moves up to max_transfers staged transfers into the TX queue of the instance, in staging order.
+ * Stops at the first transfer that is still being filled by its producer.
+ * Returns the number of transfers moved, or the negative error code of the first transfer that the library
+ * rejected; that transfer is dropped, the ones moved before it are kept.
+ */
+int16_t canardTxStagingDrain(CanardTxStaging* staging,
+                             CanardInstance* ins,
+                             uint16_t max_transfers);
+
+/**
+ * Returns the number of transfers that were rejected because the queue was full. Can be called from any thread.
+ */
+uint32_t canardTxStagingGetOverflowCount(const CanardTxStaging* staging);
+#endif
+
 /**
  * This function can be used to extract values from received UAVCAN transfers. It decodes a scalar value -
  * boolean, integer, character, or floating point - from the specified bit position in the RX transfer buffer.
@@ -537,6 +1180,28 @@ int16_t canardDecodeScalar(const CanardRxTransfer* transfer,    ///< The RX tran
                            bool value_is_signed,                ///< True if the value can be negative; see the table
                            void* out_value);                    ///< Pointer to the output storage; see the table
 
+/**
+ * This function can be used to extract byte arrays (uint8[<=N]) from received UAVCAN transfers.
+ *
+ * If 'zero_copy' is true and the requested bytes are byte-aligned and stored contiguously in the transfer buffer
+ * (in the head, in one of the pool blocks, or in the tail of a multi-frame transfer), 'out_data' is set to point
+ * directly into the transfer buffer and no data is copied. Such a view stays valid only until the transfer payload
+ * is released, i.e. until canardReleaseRxTransferPayload() is called or the reception callback returns, and must not
+ * be modified.
+ *
+ * Otherwise the bytes are copied into the memory pointed to by 'inout_arena', which is then advanced by 'len' bytes.
+ * If 'arena_end' is not NULL, the copy fails with CANARD_ERROR_OUT_OF_MEMORY instead of writing past it.
+ *
+ * Returns the number of bits decoded (len * 8), or negated error code.
+ */
+int32_t canardDecodeByteArray(const CanardRxTransfer* transfer, ///< The RX transfer where the data will be read from
+                              uint32_t bit_offset,              ///< Offset, in bits, from the beginning of the transfer
+                              uint16_t len,                     ///< Number of bytes to decode
+                              bool zero_copy,                   ///< Return a view into the transfer buffer if possible
+                              uint8_t** out_data,               ///< Pointer to the decoded bytes will be stored here
+                              uint8_t** inout_arena,            ///< Memory for the copy; may be NULL if only views are OK
+                              const uint8_t* arena_end);        ///< End of the arena memory; NULL if unchecked
+
 /**
  * This function can be used to encode values for later transmission in a UAVCAN transfer. It encodes a scalar value -
  * boolean, integer, character, or floating point - and puts it to the specified bit position in the specified
@@ -583,6 +1248,103 @@ void canardReleaseRxTransferPayload(CanardInstance* ins,
  */
 CanardPoolAllocatorStatistics canardGetPoolAllocatorStatistics(CanardInstance* ins);
 
+#if CANARD_ENABLE_POOL_QUOTAS
+/**
+ * Configures the quota of a category of the memory pool.
+ * The reserved blocks can only be taken by this category: the other categories fail to allocate once the free
+ * blocks only cover the unused reservations. The category cannot use more than max_blocks blocks at once.
+ * By default, no blocks are reserved and the categories are not capped.
+ * With CANARD_ENABLE_SIZE_CLASSES the quotas count blocks of all sizes together.
+ *
+ * Returns -CANARD_ERROR_INVALID_ARGUMENT if the category is unknown, if reserved_blocks exceeds max_blocks, or if
+ * the reservations of all categories together exceed the pool capacity; the quota is not changed then.
+ * Lowering a cap below the current usage does not release any blocks, it only denies further allocations.
+ */
+int16_t canardSetPoolQuota(CanardInstance* ins,
+                           CanardPoolCategory category,
+                           CanardPoolBlockCount reserved_blocks,
+                           CanardPoolBlockCount max_blocks);
+#endif
+
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+/**
+ * Makes the instance allocate all of its memory from the given allocator instead of the memory arena passed to
+ * canardInit(), which is not used afterwards. The allocator must outlive the instance.
+ * The pool statistics keep counting the allocated blocks, but the capacity becomes CANARD_POOL_MAX_BLOCKS: the
+ * allocator decides when the memory runs out. Pool quotas apply to the allocator as well.
+ *
+ * Returns -CANARD_ERROR_INVALID_ARGUMENT if the allocator or one of its functions is NULL, or if the instance
+ * already holds any memory, i.e. the function must be called before any transfer is sent or received.
+ */
+int16_t canardSetMemoryAllocator(CanardInstance* ins,
+                                 CanardMemoryAllocator* allocator);
+#endif
+
+#if CANARD_ENABLE_SHARED_POOL
+/**
+ * Initializes a memory pool for several instances on the given arena, in the same way canardInit() does.
+ * Without CANARD_ENABLE_LOCK_FREE_POOL the pool is not thread safe: the instances that share it must be used from one
+ * thread, or the application must serialize all calls on them. With it, instances used from different threads or
+ * interrupts can share the pool, preferably through a CanardSharedPoolContext per execution context.
+ */
+void canardInitSharedPool(CanardSharedPool* out_pool,
+                          void* mem_arena,
+                          size_t mem_arena_size);
+
+/**
+ * Makes the instance allocate all of its memory from the shared pool, see canardSetMemoryAllocator().
+ * The instance cannot use more than max_blocks blocks of the pool at once; pass CANARD_POOL_MAX_BLOCKS for no cap.
+ * canardGetPoolAllocatorStatistics() then reports the usage of this instance, with the capacity being the cap or
+ * the capacity of the pool, whichever is lower; canardGetSharedPoolStatistics() reports the usage of all instances.
+ * The pool quotas of the instance apply within its share of the pool.
+ *
+ * Returns -CANARD_ERROR_INVALID_ARGUMENT if the instance already holds any memory.
+ */
+int16_t canardAttachSharedPool(CanardInstance* ins,
+                               CanardSharedPool* pool,
+                               CanardPoolBlockCount max_blocks);
+
+/**
+ * Returns a copy of the usage statistics of the whole shared pool, counting the blocks of all instances.
+ * The statistics per category are kept per instance only.
+ * With CANARD_ENABLE_LOCK_FREE_POOL, the blocks cached by the contexts count as used.
+ */
+CanardPoolAllocatorStatistics canardGetSharedPoolStatistics(const CanardSharedPool* pool);
+#endif
+
+#if CANARD_ENABLE_LOCK_FREE_POOL
+/**
+ * Initializes a cache of up to CANARD_POOL_MAGAZINE_SIZE free blocks of the shared pool for one execution context.
+ * The cache is refilled from the pool with half of its size at a time, and half of it is returned to the pool when
+ * it is full. The cached blocks are not available to the other contexts, see canardFlushSharedPoolContext().
+ */
+void canardInitSharedPoolContext(CanardSharedPoolContext* out_context,
+                                 CanardSharedPool* pool);
+
+/**
+ * Same as canardAttachSharedPool(), but the instance allocates through the cache of the context.
+ */
+int16_t canardAttachSharedPoolContext(CanardInstance* ins,
+                                      CanardSharedPoolContext* context,
+                                      CanardPoolBlockCount max_blocks);
+
+/**
+ * Returns all cached blocks of the context to the shared pool.
+ * Must be called from the execution context that uses the context, e.g. when it goes idle or before it ends.
+ */
+void canardFlushSharedPoolContext(CanardSharedPoolContext* context);
+#endif
+
+#if CANARD_ENABLE_SIZE_CLASSES
+/**
+ * Returns a copy of the usage statistics of one size class of the pool allocator.
+ * The size classes are numbered in ascending order of block size, starting from zero for
+ * CANARD_POOL_SMALL_BLOCK_SIZE; the statistics count blocks of that size.
+ * The statistics are all zero while a custom allocator replaces the pool, see canardSetMemoryAllocator().
+ */
+CanardPoolAllocatorStatistics canardGetPoolSizeClassStatistics(CanardInstance* ins, uint8_t size_class);
+#endif
+
 /**
  * Float16 marshaling helpers.
  * These functions convert between the native float and 16-bit float.
@@ -593,16 +1355,19 @@ CanardPoolAllocatorStatistics canardGetPoolAllocatorStatistics(CanardInstance* i
 uint16_t canardConvertNativeFloatToFloat16(float value);
 float canardConvertFloat16ToNativeFloat(uint16_t value);
 
-/// Abort the build if the current platform is not supported.
-#if CANARD_ENABLE_CANFD
-CANARD_STATIC_ASSERT(((uint32_t)CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE) < 128,
-                     "Platforms where sizeof(void*) > 4 are not supported. "
-                     "On AMD64 use 32-bit mode (e.g. GCC flag -m32).");
-#else
-CANARD_STATIC_ASSERT(((uint32_t)CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE) < 32,
-                     "Platforms where sizeof(void*) > 4 are not supported. "
-                     "On AMD64 use 32-bit mode (e.g. GCC flag -m32).");
-#endif
+/**
+ * Converts arrays of count values, e.g. float16 array fields.
+ * Hardware conversion is used if available (F16C on AMD64, NEON on ARM), otherwise the functions above.
+ * The hardware rounds subnormal float16 values to nearest even and keeps NaN payloads, so in these corner cases
+ * the results may differ from the functions above in the least significant bit.
+ * If CANARD_USE_FLOAT16_CAST is defined, the compiler's half precision type is used instead.
+ */
+void canardConvertNativeFloatArrayToFloat16(const float* values,
+                                            uint16_t* out_values,
+                                            size_t count);
+void canardConvertFloat16ArrayToNativeFloat(const uint16_t* values,
+                                            float* out_values,
+                                            size_t count);
 
 #ifdef __cplusplus
 }
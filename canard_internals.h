@@ -67,13 +67,35 @@ CANARD_INTERNAL CanardTransferType extractTransferType(uint32_t id);
 
 CANARD_INTERNAL uint16_t extractDataType(uint32_t id);
 
+CANARD_INTERNAL CanardRxTimeouts getRxTimeouts(const CanardInstance* ins,
+                                               uint32_t transfer_descriptor);
+
+/// Returns the number of CAN IDs that pass the filter
+CANARD_INTERNAL uint32_t countAcceptedIDs(CanardAcceptanceFilter filter);
+
+/// Returns the narrowest filter that passes the CAN IDs that pass either filter
+CANARD_INTERNAL CanardAcceptanceFilter mergeAcceptanceFilters(CanardAcceptanceFilter a,
+                                                              CanardAcceptanceFilter b);
+
+/// Adds the filter to the set, merging the filters with the lowest cost if the set is full
+CANARD_INTERNAL void addAcceptanceFilter(CanardAcceptanceFilter* filters,
+                                         uint8_t* inout_num_filters,
+                                         uint8_t max_filters,
+                                         CanardAcceptanceFilter filter);
+
 CANARD_INTERNAL void pushTxQueue(CanardInstance* ins,
                                  CanardTxQueueItem* item);
 
+#if CANARD_ENABLE_SIZE_CLASSES
+/// Copies the frame at the head of the TX queue into the complete frame returned by canardPeekTxQueue()
+CANARD_INTERNAL void copyTxQueueHead(CanardInstance* ins);
+#endif
+
 CANARD_INTERNAL bool isPriorityHigher(uint32_t id,
                                       uint32_t rhs);
 
-CANARD_INTERNAL CanardTxQueueItem* createTxItem(CanardPoolAllocator* allocator);
+CANARD_INTERNAL CanardTxQueueItem* createTxItem(CanardPoolAllocator* allocator,
+                                                uint8_t data_len);
 
 CANARD_INTERNAL void prepareForNextTransfer(CanardRxState* state);
 
@@ -85,6 +107,12 @@ CANARD_INTERNAL void incrementTransferID(uint8_t* transfer_id);
 CANARD_INTERNAL uint64_t releaseStatePayload(CanardInstance* ins,
                                              CanardRxState* rxstate);
 
+#if CANARD_ENABLE_RX_STATE_EVICTION
+/// Removes an RX state to make room for a transfer of the given priority; returns false if there is none to remove
+CANARD_INTERNAL bool evictRxState(CanardInstance* ins,
+                                  uint8_t priority);
+#endif
+
 CANARD_INTERNAL uint8_t dlcToDataLength(uint8_t dlc);
 CANARD_INTERNAL uint8_t dataLengthToDlc(uint8_t data_length);
 
@@ -118,9 +146,17 @@ CANARD_INTERNAL int16_t descatterTransferPayload(const CanardRxTransfer* transfe
                                                  uint8_t bit_length,
                                                  void* output);
 
+/**
+ * Finds the contiguous piece of the transfer storage that contains the specified payload byte.
+ * Returns the number of payload bytes stored contiguously from that byte onwards, or zero if out of range.
+ */
+CANARD_INTERNAL uint16_t getTransferPayloadSegment(const CanardRxTransfer* transfer,
+                                                   uint16_t byte_offset,
+                                                   const uint8_t** out_segment);
+
 CANARD_INTERNAL bool isBigEndian(void);
 
-CANARD_INTERNAL void swapByteOrder(void* data, unsigned size);
+CANARD_INTERNAL void swapByteOrder(void* data, size_t size);
 
 /*
  * Transfer CRC
@@ -135,6 +171,18 @@ CANARD_INTERNAL uint16_t crcAdd(uint16_t crc_val,
                                 const uint8_t* bytes,
                                 size_t len);
 
+#if CANARD_ENABLE_SIZE_CLASSES
+/**
+ * Inits a memory allocator with size classes, splitting the arena according to CANARD_POOL_*_SHARE_PERCENT.
+ *
+ * @param [in] allocator The memory allocator to initialize.
+ * @param [in] arena The memory used by the allocator, aligned for pointers.
+ * @param [in] arena_size The size of the arena in bytes.
+ */
+CANARD_INTERNAL void initPoolSizeClasses(CanardPoolAllocator* allocator,
+                                         void* arena,
+                                         size_t arena_size);
+#else
 /**
  * Inits a memory allocator.
  *
@@ -144,12 +192,19 @@ CANARD_INTERNAL uint16_t crcAdd(uint16_t crc_val,
  */
 CANARD_INTERNAL void initPoolAllocator(CanardPoolAllocator* allocator,
                                        CanardPoolAllocatorBlock* buf,
-                                       uint16_t buf_len);
+                                       CanardPoolBlockCount buf_len);
 
 /**
  * Allocates a block from the given pool allocator.
  */
 CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator);
+#endif
+
+/**
+ * Allocates a block of at least the given size in bytes; with size classes, from the smallest class that fits.
+ */
+CANARD_INTERNAL void* allocateSizedBlock(CanardPoolAllocator* allocator,
+                                         size_t size);
 
 /**
  * Frees a memory block previously returned by canardAllocateBlock.
@@ -157,6 +212,111 @@ CANARD_INTERNAL void* allocateBlock(CanardPoolAllocator* allocator);
 CANARD_INTERNAL void freeBlock(CanardPoolAllocator* allocator,
                                void* p);
 
+#if CANARD_ENABLE_POOL_QUOTAS
+/**
+ * Removes the reservations and the caps of all categories.
+ */
+CANARD_INTERNAL void initPoolQuotas(CanardPoolAllocator* allocator);
+
+/**
+ * Returns true if the quotas allow the category to allocate one more block.
+ */
+CANARD_INTERNAL bool isPoolQuotaAvailable(const CanardPoolAllocator* allocator,
+                                          CanardPoolCategory category);
+#endif
+
+/**
+ * Initializes the pool on the arena, with the size classes if enabled.
+ */
+CANARD_INTERNAL void initPool(CanardPoolAllocator* allocator,
+                              void* arena,
+                              size_t arena_size);
+
+#if CANARD_ENABLE_SHARED_POOL
+/**
+ * Allocator functions of CanardSharedPool.
+ */
+CANARD_INTERNAL void* allocateSharedPoolBlock(CanardMemoryAllocator* self,
+                                              size_t size);
+
+CANARD_INTERNAL void freeSharedPoolBlock(CanardMemoryAllocator* self,
+                                         void* pointer);
+
+/**
+ * Sets the allocator of the instance, with the capacity of the instance being the lower of the cap and the pool.
+ */
+CANARD_INTERNAL int16_t attachSharedPoolAllocator(CanardInstance* ins,
+                                                  CanardMemoryAllocator* allocator,
+                                                  CanardPoolBlockCount pool_capacity,
+                                                  CanardPoolBlockCount max_blocks);
+#endif
+
+#if CANARD_ENABLE_LOCK_FREE_POOL
+/**
+ * Initializes the lock-free free list of the shared pool on the arena.
+ */
+CANARD_INTERNAL void initLockFreePool(CanardSharedPool* pool,
+                                      void* arena,
+                                      size_t arena_size);
+
+/**
+ * Returns the location of the index of the next free block, stored in the free block itself.
+ */
+CANARD_INTERNAL CanardPoolBlockCount* getLockFreeLink(CanardPoolAllocatorBlock* block);
+
+/**
+ * Takes a block from the lock-free free list, or NULL if the pool is exhausted. Safe to call concurrently.
+ */
+CANARD_INTERNAL void* popLockFreeBlock(CanardSharedPool* pool);
+
+/**
+ * Returns a block to the lock-free free list. Safe to call concurrently.
+ */
+CANARD_INTERNAL void pushLockFreeBlock(CanardSharedPool* pool,
+                                       void* p);
+
+/**
+ * Allocator functions of CanardSharedPoolContext.
+ */
+CANARD_INTERNAL void* allocateSharedPoolContextBlock(CanardMemoryAllocator* self,
+                                                     size_t size);
+
+CANARD_INTERNAL void freeSharedPoolContextBlock(CanardMemoryAllocator* self,
+                                                void* pointer);
+
+/**
+ * Returns the given number of cached blocks of the context to the pool.
+ */
+CANARD_INTERNAL void flushSharedPoolContext(CanardSharedPoolContext* context,
+                                            uint8_t num_blocks);
+#endif
+
+/**
+ * Allocates a block of at least the given size from the custom allocator if one is set, otherwise from the pool.
+ */
+CANARD_INTERNAL void* allocateMemory(CanardPoolAllocator* allocator,
+                                     size_t size);
+
+/**
+ * Frees a block previously returned by allocateMemory().
+ */
+CANARD_INTERNAL void freeMemory(CanardPoolAllocator* allocator,
+                                void* p);
+
+/**
+ * Allocates a block of at least the given size for the category, enforcing the quotas if enabled.
+ */
+CANARD_INTERNAL void* allocatePoolBlock(CanardPoolAllocator* allocator,
+                                        CanardPoolCategory category,
+                                        size_t size);
+
+/**
+ * Frees a block previously returned by allocatePoolBlock() for the same category.
+ */
+CANARD_INTERNAL void freePoolBlock(CanardPoolAllocator* allocator,
+                                   CanardPoolCategory category,
+                                   void* p);
+
 CANARD_INTERNAL uint16_t calculateCRC(const void* payload, 
                                       uint16_t payload_len, 
                                       uint64_t data_type_signature
@@ -165,6 +325,21 @@ CANARD_INTERNAL uint16_t calculateCRC(const void* payload,
 #endif
 );
 
+#if CANARD_ENABLE_TX_STAGING
+/**
+ * Claims the next free slot of the staging queue and copies the payload into it.
+ * Returns NULL if the payload does not fit in a slot or if the queue is full.
+ */
+CANARD_INTERNAL CanardTxStagingSlot* acquireTxStagingSlot(CanardTxStaging* staging,
+                                                          const void* payload,
+                                                          uint16_t payload_len);
+
+/**
+ * Makes a slot returned by acquireTxStagingSlot() visible to the consumer.
+ */
+CANARD_INTERNAL void commitTxStagingSlot(CanardTxStagingSlot* slot);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,14 +11,60 @@
 #endif
 
 #include <net/if.h>
+#include <net/if_arp.h>
 #include "socketcan.h"
 #include <poll.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+// io_uring is used if the kernel headers are recent enough for multishot reception; there is no liburing dependency
+#if defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+# endif
+#endif
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+# define IO_URING_AVAILABLE     1
+#else
+# define IO_URING_AVAILABLE     0
+#endif
+
+#if SOCKETCAN_LOOP_MAX_TX_IN_FLIGHT < SOCKETCAN_MAX_IFACES
+# error "SOCKETCAN_LOOP_MAX_TX_IN_FLIGHT cannot be less than SOCKETCAN_MAX_IFACES"
+#endif
+#if (SOCKETCAN_LOOP_NUM_RX_BUFFERS & (SOCKETCAN_LOOP_NUM_RX_BUFFERS - 1U)) != 0
+# error "SOCKETCAN_LOOP_NUM_RX_BUFFERS must be a power of two"
+#endif
+
+/// The frames are read and written in the largest format that the library is configured for.
+/// Classic frames are written with the CAN_MTU prefix of it, the layouts of both formats are compatible.
+#if CANARD_ENABLE_CANFD
+typedef struct canfd_frame SocketCANFrame;
+#else
+typedef struct can_frame SocketCANFrame;
+#endif
+
+/// Ancillary data buffer of a received frame, which holds its timestamp
+typedef union
+{
+    size_t align;                       ///< The alignment of struct cmsghdr
+    uint8_t data[CMSG_SPACE(sizeof(struct timespec))];
+} ControlBuffer;
 
 /// Returns the current errno as negated int16_t
 static int16_t getErrorCode()
@@ -42,34 +88,41 @@ static int16_t getErrorCode()
     }
 }
 
-int16_t socketcanInit(SocketCANInstance* out_ins, const char* can_iface_name)
+/**
+ * Opens a CAN socket bound to the interface index, zero binds it to all CAN interfaces.
+ * Returns the file descriptor, negative on error with errno set.
+ */
+static int openSocket(int ifindex)
 {
-    const size_t iface_name_size = strlen(can_iface_name) + 1;
-    if (iface_name_size > IFNAMSIZ)
-    {
-        goto fail0;
-    }
-
     const int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW);  // NOLINT
     if (fd < 0)
     {
         goto fail0;
     }
 
-    struct ifreq ifr;
-    memset(&ifr, 0, sizeof(ifr));
-    memcpy(ifr.ifr_name, can_iface_name, iface_name_size);
+    const int enable_timestamps = 1;
+    const int timestamps_result = setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS,
+                                             &enable_timestamps, sizeof(enable_timestamps));
+    if (timestamps_result < 0)
+    {
+        goto fail1;
+    }
 
-    const int ioctl_result = ioctl(fd, SIOCGIFINDEX, &ifr);
-    if (ioctl_result < 0)
+#if CANARD_ENABLE_CANFD
+    // Classic and FD frames share the socket, the MTU of each written frame selects its format
+    const int enable_fd_frames = 1;
+    const int setsockopt_result = setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES,
+                                             &enable_fd_frames, sizeof(enable_fd_frames));
+    if (setsockopt_result < 0)
     {
         goto fail1;
     }
+#endif
 
     struct sockaddr_can addr;
     memset(&addr, 0, sizeof(addr));
     addr.can_family = AF_CAN;
-    addr.can_ifindex = ifr.ifr_ifindex;
+    addr.can_ifindex = ifindex;
 
     const int bind_result = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
     if (bind_result < 0)
@@ -77,13 +130,106 @@ int16_t socketcanInit(SocketCANInstance* out_ins, const char* can_iface_name)
         goto fail1;
     }
 
-    out_ins->fd = fd;
-    return 0;
+    return fd;
 
 fail1:
     (void)close(fd);
 fail0:
-    return getErrorCode();
+    return -1;
+}
+
+int16_t socketcanInit(SocketCANInstance* out_ins, const char* can_iface_name)
+{
+    const size_t iface_name_size = strlen(can_iface_name) + 1;
+    if (iface_name_size > IFNAMSIZ)
+    {
+        return -ENAMETOOLONG;
+    }
+
+    const unsigned ifindex = if_nametoindex(can_iface_name);
+    if (ifindex == 0)
+    {
+        return getErrorCode();
+    }
+
+    const int fd = openSocket((int)ifindex);
+    if (fd < 0)
+    {
+        return getErrorCode();
+    }
+
+    out_ins->fd = fd;
+    out_ins->num_ifaces = 0;
+    return 0;
+}
+
+/**
+ * Finds the CAN interfaces, in the order of their interface indices, using the socket for the queries.
+ * Returns the number of interfaces, negative on error.
+ */
+static int16_t findCANInterfaces(int fd, int* out_ifindices)
+{
+    struct if_nameindex* const ifaces = if_nameindex();
+    if (ifaces == NULL)
+    {
+        return getErrorCode();
+    }
+
+    uint8_t num_ifaces = 0;
+    for (struct if_nameindex* iface = ifaces; (iface->if_index != 0) && (num_ifaces < SOCKETCAN_MAX_IFACES); iface++)
+    {
+        struct ifreq ifr;
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, iface->if_name, IFNAMSIZ - 1);
+        if ((ioctl(fd, SIOCGIFHWADDR, &ifr) == 0) && (ifr.ifr_hwaddr.sa_family == ARPHRD_CAN))
+        {
+            out_ifindices[num_ifaces++] = (int)iface->if_index;
+        }
+    }
+
+    if_freenameindex(ifaces);
+    return (int16_t)num_ifaces;
+}
+
+int16_t socketcanInitMultiIface(SocketCANInstance* out_ins, const char* const* can_iface_names, uint8_t num_ifaces)
+{
+    if ((num_ifaces > SOCKETCAN_MAX_IFACES) || ((can_iface_names == NULL) && (num_ifaces > 0)))
+    {
+        return -EINVAL;
+    }
+
+    int ifindices[SOCKETCAN_MAX_IFACES];
+    for (uint8_t i = 0; i < num_ifaces; i++)
+    {
+        const unsigned ifindex = if_nametoindex(can_iface_names[i]);
+        if (ifindex == 0)
+        {
+            return getErrorCode();
+        }
+        ifindices[i] = (int)ifindex;
+    }
+
+    const int fd = openSocket(0);
+    if (fd < 0)
+    {
+        return getErrorCode();
+    }
+
+    if (num_ifaces == 0)
+    {
+        const int16_t find_result = findCANInterfaces(fd, ifindices);
+        if (find_result <= 0)
+        {
+            (void)close(fd);
+            return (int16_t)((find_result < 0) ? find_result : -ENODEV);
+        }
+        num_ifaces = (uint8_t)find_result;
+    }
+
+    out_ins->fd = fd;
+    out_ins->num_ifaces = num_ifaces;
+    memcpy(out_ins->ifindices, ifindices, sizeof(ifindices[0]) * num_ifaces);
+    return 0;
 }
 
 int16_t socketcanClose(SocketCANInstance* ins)
@@ -94,11 +240,58 @@ int16_t socketcanClose(SocketCANInstance* ins)
 }
 
 int16_t socketcanTransmit(SocketCANInstance* ins, const CanardCANFrame* frame, int32_t timeout_msec)
+{
+    return socketcanTransmitBatch(ins, frame, 1, timeout_msec);
+}
+
+int16_t socketcanReceive(SocketCANInstance* ins, CanardCANFrame* out_frame, int32_t timeout_msec)
+{
+    return socketcanReceiveBatch(ins, out_frame, NULL, 1, timeout_msec);
+}
+
+int16_t socketcanEnableTransmitTimestamps(SocketCANInstance* ins, bool enable)
+{
+    const int value = enable ? 1 : 0;
+    const int setsockopt_result = setsockopt(ins->fd, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &value, sizeof(value));
+    return (int16_t)((setsockopt_result == 0) ? 0 : getErrorCode());
+}
+
+/// Returns the current time of the clock in nanoseconds
+static int64_t getTimestampNSec(clockid_t clock)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    (void)clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Returns the monotonic timestamp of the received message in microseconds.
+ * The kernel timestamps are taken from CLOCK_REALTIME; realtime_to_monotonic_nsec is the offset between the clocks.
+ * If the message carries no timestamp, the current time is returned.
+ */
+static uint64_t getMessageTimestampUSec(struct msghdr* msg, int64_t realtime_to_monotonic_nsec)
+{
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+        {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            const int64_t realtime_nsec = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+            return (uint64_t)(realtime_nsec + realtime_to_monotonic_nsec) / 1000U;
+        }
+    }
+    return (uint64_t)getTimestampNSec(CLOCK_MONOTONIC) / 1000U;
+}
+
+/// Waits for the events on the socket. Returns 1 if ready, 0 on timeout, negative on error.
+static int16_t pollSocket(int fd, short events, int32_t timeout_msec)
 {
     struct pollfd fds;
     memset(&fds, 0, sizeof(fds));
-    fds.fd = ins->fd;
-    fds.events |= POLLOUT;
+    fds.fd = fd;
+    fds.events = events;
 
     const int poll_result = poll(&fds, 1, timeout_msec);
     if (poll_result < 0)
@@ -109,75 +302,1491 @@ int16_t socketcanTransmit(SocketCANInstance* ins, const CanardCANFrame* frame, i
     {
         return 0;
     }
-    if (((uint32_t)fds.revents & (uint32_t)POLLOUT) == 0)
+    if (((uint32_t)fds.revents & (uint32_t)events) == 0)
     {
         return -EIO;
     }
+    return 1;
+}
 
-    struct can_frame transmit_frame;
-    memset(&transmit_frame, 0, sizeof(transmit_frame));
-    transmit_frame.can_id = frame->id;                  // TODO: Map flags properly
-    transmit_frame.can_dlc = frame->data_len;
-    memcpy(transmit_frame.data, frame->data, frame->data_len);
+/// True if the last socket operation failed only because it would have blocked
+static bool wouldBlock(void)
+{
+    return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+}
 
-    const ssize_t nbytes = write(ins->fd, &transmit_frame, sizeof(transmit_frame));
-    if (nbytes < 0)
+/// Converts the ID flags of libcanard into the SocketCAN ones
+static canid_t toSocketCANID(uint32_t id)
+{
+    canid_t out = id & CANARD_CAN_EXT_ID_MASK;
+    if (id & CANARD_CAN_FRAME_EFF)
     {
-        return getErrorCode();
+        out |= CAN_EFF_FLAG;
+    }
+    if (id & CANARD_CAN_FRAME_RTR)
+    {
+        out |= CAN_RTR_FLAG;
+    }
+    if (id & CANARD_CAN_FRAME_ERR)
+    {
+        out |= CAN_ERR_FLAG;
     }
-    if ((size_t)nbytes != sizeof(transmit_frame))
+    return out;
+}
+
+/// Converts the frame into the SocketCAN format. Returns the number of bytes to write to the socket (the MTU).
+static size_t toSocketCANFrame(const CanardCANFrame* frame, SocketCANFrame* out_frame)
+{
+    memset(out_frame, 0, sizeof(*out_frame));
+    out_frame->can_id = toSocketCANID(frame->id);
+    memcpy(out_frame->data, frame->data, frame->data_len);
+#if CANARD_ENABLE_CANFD
+    out_frame->len = frame->data_len;
+    if (frame->canfd)
+    {
+        if (frame->brs)
+        {
+            out_frame->flags = CANFD_BRS;
+        }
+        return CANFD_MTU;
+    }
+#else
+    out_frame->can_dlc = frame->data_len;
+#endif
+    return CAN_MTU;
+}
+
+/// Converts the frame of frame_size bytes read from the socket. Returns 0 on success, negative on error.
+static int16_t fromSocketCANFrame(const SocketCANFrame* frame, size_t frame_size, CanardCANFrame* out_frame)
+{
+#if CANARD_ENABLE_CANFD
+    const uint8_t data_len = frame->len;
+    const bool canfd = frame_size == CANFD_MTU;
+    if ((!canfd && (frame_size != CAN_MTU)) || (data_len > (canfd ? CANFD_MAX_DLEN : CAN_MAX_DLEN)))
+    {
+        return -EIO;
+    }
+    out_frame->canfd = canfd;
+    out_frame->brs = canfd && ((frame->flags & CANFD_BRS) != 0);
+#else
+    const uint8_t data_len = frame->can_dlc;
+    if ((frame_size != CAN_MTU) || (data_len > CAN_MAX_DLEN))   // Appeasing Coverity Scan
     {
         return -EIO;
     }
+#endif
 
-    return 1;
+    out_frame->id = frame->can_id & CAN_EFF_MASK;
+    if (frame->can_id & CAN_EFF_FLAG)
+    {
+        out_frame->id |= CANARD_CAN_FRAME_EFF;
+    }
+    if (frame->can_id & CAN_RTR_FLAG)
+    {
+        out_frame->id |= CANARD_CAN_FRAME_RTR;
+    }
+    if (frame->can_id & CAN_ERR_FLAG)
+    {
+        out_frame->id |= CANARD_CAN_FRAME_ERR;
+    }
+    out_frame->data_len = data_len;
+    memcpy(out_frame->data, frame->data, data_len);
+    return 0;
 }
 
-int16_t socketcanReceive(SocketCANInstance* ins, CanardCANFrame* out_frame, int32_t timeout_msec)
+/// Returns the mask of the interfaces of the instance that the frame is to be transmitted on
+static uint8_t getTransmitIfaceMask(const SocketCANInstance* ins, const CanardCANFrame* frame)
 {
-    struct pollfd fds;
-    memset(&fds, 0, sizeof(fds));
-    fds.fd = ins->fd;
-    fds.events |= POLLIN;
+    if (ins->num_ifaces == 0)
+    {
+        return 1U;                      // The socket is bound to the interface
+    }
+    const uint8_t all_ifaces_mask = (uint8_t)((1U << ins->num_ifaces) - 1U);
+#if CANARD_MULTI_IFACE
+    return (uint8_t)(frame->iface_mask & all_ifaces_mask);
+#else
+    (void)frame;
+    return all_ifaces_mask;
+#endif
+}
 
-    const int poll_result = poll(&fds, 1, timeout_msec);
-    if (poll_result < 0)
+int16_t socketcanTransmitBatch(SocketCANInstance* ins,
+                               const CanardCANFrame* frames,
+                               uint16_t num_frames,
+                               int32_t timeout_msec)
+{
+    SocketCANFrame transmit_frames[SOCKETCAN_MAX_BATCH_SIZE];
+    struct sockaddr_can addrs[SOCKETCAN_MAX_IFACES];
+    struct iovec iovs[SOCKETCAN_MAX_BATCH_SIZE];
+    struct mmsghdr msgs[SOCKETCAN_MAX_BATCH_SIZE];
+    uint16_t first_msgs[SOCKETCAN_MAX_BATCH_SIZE + 1U];     // Index of the first message of every frame
+
+    if (num_frames > SOCKETCAN_MAX_BATCH_SIZE)
+    {
+        num_frames = SOCKETCAN_MAX_BATCH_SIZE;
+    }
+    if (num_frames == 0)
+    {
+        return 0;
+    }
+
+    // A socket bound to several interfaces takes the destination interface from the message address
+    memset(addrs, 0, sizeof(addrs[0]) * ins->num_ifaces);
+    for (uint8_t k = 0; k < ins->num_ifaces; k++)
+    {
+        addrs[k].can_family = AF_CAN;
+        addrs[k].can_ifindex = ins->ifindices[k];
+    }
+
+    // Every frame is written once per interface, as far as the messages go
+    uint16_t num_msgs = 0;
+    uint16_t num_batched_frames = 0;
+    for (; num_batched_frames < num_frames; num_batched_frames++)
+    {
+        const uint8_t iface_mask = getTransmitIfaceMask(ins, &frames[num_batched_frames]);
+        uint16_t num_copies = 0;
+        for (uint8_t k = 0; k < SOCKETCAN_MAX_IFACES; k++)
+        {
+            num_copies = (uint16_t)(num_copies + ((iface_mask >> k) & 1U));
+        }
+        if ((num_msgs + num_copies) > SOCKETCAN_MAX_BATCH_SIZE)
+        {
+            break;
+        }
+
+        first_msgs[num_batched_frames] = num_msgs;
+        SocketCANFrame* const transmit_frame = &transmit_frames[num_batched_frames];
+        const size_t frame_size = toSocketCANFrame(&frames[num_batched_frames], transmit_frame);
+        for (uint8_t k = 0; k < SOCKETCAN_MAX_IFACES; k++)
+        {
+            if ((iface_mask & (1U << k)) == 0)
+            {
+                continue;
+            }
+            memset(&msgs[num_msgs], 0, sizeof(msgs[num_msgs]));
+            iovs[num_msgs].iov_base = transmit_frame;
+            iovs[num_msgs].iov_len = frame_size;
+            msgs[num_msgs].msg_hdr.msg_iov = &iovs[num_msgs];
+            msgs[num_msgs].msg_hdr.msg_iovlen = 1;
+            if (ins->num_ifaces > 0)
+            {
+                msgs[num_msgs].msg_hdr.msg_name = &addrs[k];
+                msgs[num_msgs].msg_hdr.msg_namelen = sizeof(addrs[k]);
+            }
+            num_msgs++;
+        }
+    }
+    first_msgs[num_batched_frames] = num_msgs;
+    if (num_msgs == 0)
+    {
+        return (int16_t)num_batched_frames;     // None of the frames is to be transmitted anywhere
+    }
+
+    int sent = sendmmsg(ins->fd, msgs, num_msgs, MSG_DONTWAIT);
+    if ((sent < 0) && wouldBlock())
+    {
+        const int16_t poll_result = pollSocket(ins->fd, POLLOUT, timeout_msec);
+        if (poll_result <= 0)
+        {
+            return poll_result;
+        }
+        sent = sendmmsg(ins->fd, msgs, num_msgs, MSG_DONTWAIT);
+        if ((sent < 0) && wouldBlock())
+        {
+            return 0;
+        }
+    }
+    if (sent < 0)
     {
         return getErrorCode();
     }
-    if (poll_result == 0)
+
+    for (int i = 0; i < sent; i++)
+    {
+        if (msgs[i].msg_len != iovs[i].iov_len)
+        {
+            return -EIO;
+        }
+    }
+
+    // A frame is transmitted if any of its copies is; the frames without copies go along with the preceding ones
+    uint16_t num_sent_frames = 0;
+    while ((num_sent_frames < num_batched_frames) &&
+           ((first_msgs[num_sent_frames] < (uint16_t)sent) ||
+            (first_msgs[num_sent_frames] == first_msgs[num_sent_frames + 1U])))
+    {
+        num_sent_frames++;
+    }
+    return (int16_t)num_sent_frames;
+}
+
+/// Returns the iface_id of the interface that the message was received from, negative if it is not served
+static int16_t getReceiveIfaceID(const SocketCANInstance* ins, const struct msghdr* msg)
+{
+    if (ins->num_ifaces == 0)
+    {
+        return 0;                       // The socket is bound to the interface
+    }
+    const struct sockaddr_can* const addr = (const struct sockaddr_can*)msg->msg_name;
+    if ((msg->msg_namelen < sizeof(*addr)) || (addr->can_family != AF_CAN))
+    {
+        return -1;
+    }
+    for (uint8_t k = 0; k < ins->num_ifaces; k++)
+    {
+        if (ins->ifindices[k] == addr->can_ifindex)
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+int16_t socketcanReceiveBatch(SocketCANInstance* ins,
+                              CanardCANFrame* out_frames,
+                              SocketCANFrameInfo* out_infos,
+                              uint16_t max_frames,
+                              int32_t timeout_msec)
+{
+    SocketCANFrame receive_frames[SOCKETCAN_MAX_BATCH_SIZE];
+    struct iovec iovs[SOCKETCAN_MAX_BATCH_SIZE];
+    struct mmsghdr msgs[SOCKETCAN_MAX_BATCH_SIZE];
+    ControlBuffer controls[SOCKETCAN_MAX_BATCH_SIZE];
+    struct sockaddr_can addrs[SOCKETCAN_MAX_BATCH_SIZE];
+
+    if (max_frames > SOCKETCAN_MAX_BATCH_SIZE)
+    {
+        max_frames = SOCKETCAN_MAX_BATCH_SIZE;
+    }
+    if (max_frames == 0)
     {
         return 0;
     }
-    if (((uint32_t)fds.revents & (uint32_t)POLLIN) == 0)
+
+    memset(msgs, 0, sizeof(msgs[0]) * max_frames);
+    for (uint16_t i = 0; i < max_frames; i++)
     {
-        return -EIO;
+        iovs[i].iov_base = &receive_frames[i];
+        iovs[i].iov_len = sizeof(receive_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = controls[i].data;
+        msgs[i].msg_hdr.msg_controllen = sizeof(controls[i].data);
+        if (ins->num_ifaces > 0)
+        {
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        }
     }
 
-    struct can_frame receive_frame;
-    const ssize_t nbytes = read(ins->fd, &receive_frame, sizeof(receive_frame));
-    if (nbytes < 0)
+    int received = recvmmsg(ins->fd, msgs, max_frames, MSG_DONTWAIT, NULL);
+    if ((received < 0) && wouldBlock())
+    {
+        const int16_t poll_result = pollSocket(ins->fd, POLLIN, timeout_msec);
+        if (poll_result <= 0)
+        {
+            return poll_result;
+        }
+        received = recvmmsg(ins->fd, msgs, max_frames, MSG_DONTWAIT, NULL);
+        if ((received < 0) && wouldBlock())
+        {
+            return 0;
+        }
+    }
+    if (received < 0)
     {
         return getErrorCode();
     }
-    if ((size_t)nbytes != sizeof(receive_frame))
+
+    // The clocks are read in the VDSO, without system calls
+    const int64_t realtime_to_monotonic_nsec = getTimestampNSec(CLOCK_MONOTONIC) - getTimestampNSec(CLOCK_REALTIME);
+
+    uint16_t num_frames = 0;
+    for (int i = 0; i < received; i++)
     {
-        return -EIO;
+        const int16_t iface_id = getReceiveIfaceID(ins, &msgs[i].msg_hdr);
+        if (iface_id < 0)
+        {
+            continue;                   // Not one of our interfaces
+        }
+
+        if (out_infos != NULL)
+        {
+            out_infos[num_frames].timestamp_usec = getMessageTimestampUSec(&msgs[i].msg_hdr,
+                                                                           realtime_to_monotonic_nsec);
+            out_infos[num_frames].transmitted = (msgs[i].msg_hdr.msg_flags & MSG_CONFIRM) != 0;
+        }
+
+        const int16_t conversion_result = fromSocketCANFrame(&receive_frames[i], msgs[i].msg_len,
+                                                             &out_frames[num_frames]);
+        if (conversion_result < 0)
+        {
+            return conversion_result;
+        }
+        out_frames[num_frames].iface_id = (uint8_t)iface_id;
+        num_frames++;
     }
 
-    if (receive_frame.can_dlc > CAN_MAX_DLEN)           // Appeasing Coverity Scan
+    return (int16_t)num_frames;
+}
+
+int16_t socketcanConfigureAcceptanceFilters(SocketCANInstance* ins,
+                                            const CanardAcceptanceFilter* filters,
+                                            uint8_t num_filters)
+{
+    if (((filters == NULL) && (num_filters > 0)) || (num_filters > SOCKETCAN_MAX_ACCEPTANCE_FILTERS))
     {
-        return -EIO;
+        return -EINVAL;
     }
 
-    out_frame->id = receive_frame.can_id;               // TODO: Map flags properly
-    out_frame->data_len = receive_frame.can_dlc;
-    memcpy(out_frame->data, &receive_frame.data, receive_frame.can_dlc);
+    struct can_filter can_filters[SOCKETCAN_MAX_ACCEPTANCE_FILTERS];
+    for (uint8_t i = 0; i < num_filters; i++)
+    {
+        can_filters[i].can_id = toSocketCANID(filters[i].id);
+        can_filters[i].can_mask = toSocketCANID(filters[i].mask);
+    }
 
-    return 1;
+    const int setsockopt_result = setsockopt(ins->fd, SOL_CAN_RAW, CAN_RAW_FILTER, can_filters,
+                                             (socklen_t)(sizeof(can_filters[0]) * num_filters));
+    return (int16_t)((setsockopt_result == 0) ? 0 : getErrorCode());
 }
 
 int socketcanGetSocketFileDescriptor(const SocketCANInstance* ins)
 {
     return ins->fd;
 }
+
+/*
+ * Memory mapped reception
+ */
+#define RING_FRAME_SIZE         256U        ///< Upper bound of a packet slot, required by the API only
+
+/// Offset of the packet address from the packet header, equals TPACKET_ALIGN(sizeof(struct tpacket3_hdr))
+#define RING_PACKET_ADDR_OFFSET ((sizeof(struct tpacket3_hdr) + TPACKET_ALIGNMENT - 1U) & \
+                                 ~(size_t)(TPACKET_ALIGNMENT - 1U))
+
+static struct tpacket_block_desc* getRingBlock(const SocketCANRingInstance* ins, uint32_t index)
+{
+    return (struct tpacket_block_desc*)(void*)(ins->ring + (size_t)index * SOCKETCAN_RING_BLOCK_SIZE);
+}
+
+/**
+ * Receives the CAN frames of the interface into the ring. A packet socket is bound to one protocol, which is enough
+ * without CAN FD; otherwise the socket is bound to all protocols and the kernel drops everything except ETH_P_CAN
+ * and ETH_P_CANFD before it reaches the ring, as well as the outgoing copies of the frames transmitted by the host.
+ */
+static int bindRingSocket(int fd, unsigned ifindex)
+{
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_ifindex = (int)ifindex;
+#if CANARD_ENABLE_CANFD
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, (uint32_t)(SKF_AD_OFF + SKF_AD_PKTTYPE)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 4, 0),
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, (uint32_t)(SKF_AD_OFF + SKF_AD_PROTOCOL)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_CAN, 1, 0),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_CANFD, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFFU),
+        BPF_STMT(BPF_RET | BPF_K, 0U),
+    };
+    struct sock_fprog program;
+    program.len = (unsigned short)(sizeof(code) / sizeof(code[0]));
+    program.filter = code;
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0)
+    {
+        return -1;
+    }
+    addr.sll_protocol = htons(ETH_P_ALL);
+#else
+    addr.sll_protocol = htons(ETH_P_CAN);
+#endif
+    return bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+}
+
+int16_t socketcanRingInit(SocketCANRingInstance* out_ins, const char* can_iface_name)
+{
+    const size_t ring_size = (size_t)SOCKETCAN_RING_BLOCK_SIZE * SOCKETCAN_RING_NUM_BLOCKS;
+
+    const unsigned ifindex = if_nametoindex(can_iface_name);
+    if (ifindex == 0)
+    {
+        goto fail0;
+    }
+
+    // The protocol is set when binding, so that nothing is received before the ring is ready
+    const int fd = socket(PF_PACKET, SOCK_RAW | SOCK_NONBLOCK, 0);  // NOLINT
+    if (fd < 0)
+    {
+        goto fail0;
+    }
+
+    const int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    {
+        goto fail1;
+    }
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = SOCKETCAN_RING_BLOCK_SIZE;
+    req.tp_block_nr = SOCKETCAN_RING_NUM_BLOCKS;
+    req.tp_frame_size = RING_FRAME_SIZE;
+    req.tp_frame_nr = (SOCKETCAN_RING_BLOCK_SIZE / RING_FRAME_SIZE) * SOCKETCAN_RING_NUM_BLOCKS;
+    req.tp_retire_blk_tov = SOCKETCAN_RING_BLOCK_TIMEOUT_MSEC;
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+    {
+        goto fail1;
+    }
+
+    void* const ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring == MAP_FAILED)
+    {
+        goto fail1;
+    }
+
+    if (bindRingSocket(fd, ifindex) < 0)
+    {
+        goto fail2;
+    }
+
+    out_ins->fd = fd;
+    out_ins->ifindex = (int)ifindex;
+    out_ins->ring = (uint8_t*)ring;
+    out_ins->current_block = 0;
+    out_ins->num_remaining_packets = 0;
+    out_ins->next_packet_offset = 0;
+    return 0;
+
+fail2:
+    (void)munmap(ring, ring_size);
+fail1:
+    (void)close(fd);
+fail0:
+    return getErrorCode();
+}
+
+int16_t socketcanRingClose(SocketCANRingInstance* ins)
+{
+    (void)munmap(ins->ring, (size_t)SOCKETCAN_RING_BLOCK_SIZE * SOCKETCAN_RING_NUM_BLOCKS);
+    ins->ring = NULL;
+    const int close_result = close(ins->fd);
+    ins->fd = -1;
+    return (int16_t)((close_result == 0) ? 0 : getErrorCode());
+}
+
+int16_t socketcanRingReceiveBatch(SocketCANRingInstance* ins,
+                                  CanardCANFrame* out_frames,
+                                  SocketCANFrameInfo* out_infos,
+                                  uint16_t max_frames,
+                                  int32_t timeout_msec)
+{
+    const int64_t realtime_to_monotonic_nsec = getTimestampNSec(CLOCK_MONOTONIC) - getTimestampNSec(CLOCK_REALTIME);
+    bool may_wait = true;
+    uint16_t num_frames = 0;
+
+    while (num_frames < max_frames)
+    {
+        struct tpacket_block_desc* const block = getRingBlock(ins, ins->current_block);
+
+        if (ins->num_remaining_packets == 0)
+        {
+            // The kernel hands the block over by setting its status, the packets are valid after that
+            if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+            {
+                if ((num_frames > 0) || !may_wait)
+                {
+                    break;
+                }
+                const int16_t poll_result = pollSocket(ins->fd, POLLIN, timeout_msec);
+                if (poll_result <= 0)
+                {
+                    return poll_result;
+                }
+                may_wait = false;
+                continue;
+            }
+            ins->num_remaining_packets = block->hdr.bh1.num_pkts;
+            ins->next_packet_offset = block->hdr.bh1.offset_to_first_pkt;
+        }
+
+        if (ins->num_remaining_packets > 0)
+        {
+            const uint8_t* const packet = (const uint8_t*)block + ins->next_packet_offset;
+            const struct tpacket3_hdr* const hdr = (const struct tpacket3_hdr*)(const void*)packet;
+            const struct sockaddr_ll* const addr =
+                (const struct sockaddr_ll*)(const void*)(packet + RING_PACKET_ADDR_OFFSET);
+
+            // The ring serves one interface, which is iface_id 0 like with a socket bound to the interface
+            SocketCANFrame frame;
+            if ((addr->sll_ifindex == ins->ifindex) && (hdr->tp_snaplen <= sizeof(frame)))
+            {
+                memcpy(&frame, packet + hdr->tp_mac, hdr->tp_snaplen);
+                if (fromSocketCANFrame(&frame, hdr->tp_snaplen, &out_frames[num_frames]) == 0)
+                {
+                    out_frames[num_frames].iface_id = 0;
+                    if (out_infos != NULL)
+                    {
+                        const int64_t realtime_nsec = (int64_t)hdr->tp_sec * 1000000000LL + hdr->tp_nsec;
+                        out_infos[num_frames].timestamp_usec =
+                            (uint64_t)(realtime_nsec + realtime_to_monotonic_nsec) / 1000U;
+                        out_infos[num_frames].transmitted = false;
+                    }
+                    num_frames++;
+                }
+            }
+
+            ins->next_packet_offset += hdr->tp_next_offset;
+            ins->num_remaining_packets--;
+            if (ins->num_remaining_packets > 0)
+            {
+                continue;
+            }
+        }
+
+        // The block is read completely, handing it back to the kernel
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        ins->current_block = (ins->current_block + 1U) % SOCKETCAN_RING_NUM_BLOCKS;
+    }
+
+    return (int16_t)num_frames;
+}
+
+int socketcanRingGetSocketFileDescriptor(const SocketCANRingInstance* ins)
+{
+    return ins->fd;
+}
+
+/*
+ * Event loop
+ */
+#define LOOP_SQ_ENTRIES         256U        ///< Holds the operations of all buses, see getFreeSQEs()
+#define LOOP_CQ_ENTRIES         1024U
+#define LOOP_BUFFER_GROUP       0U
+
+/// User data of the operations: the kind in the low byte, then the bus index and the TX slot index
+#define LOOP_OP_RECEIVE         1U
+#define LOOP_OP_TRANSMIT        2U
+#define LOOP_OP_WAIT_WRITABLE   3U
+#define LOOP_OP_CANCEL          4U
+
+/// Epoll user data of the timer of the epoll based loop, the sockets are identified by their bus indices
+#define LOOP_TIMER_TOKEN        0xFFFFFFFFU
+
+typedef struct
+{
+    SocketCANFrame frame;
+    size_t frame_size;
+    struct sockaddr_can addr;           ///< Destination interface of a socket bound to several interfaces
+    struct iovec iov;
+    struct msghdr msg;
+    int32_t result;                     ///< Result of the send operation
+} LoopTxSlot;
+
+typedef struct
+{
+    SocketCANInstance* socketcan;
+    CanardInstance* canard;
+    struct msghdr rx_msg;               ///< Sizes of the name and the ancillary data of the multishot reception
+    bool rx_armed;                      ///< The multishot reception is active
+    LoopTxSlot tx_slots[SOCKETCAN_LOOP_MAX_TX_IN_FLIGHT];   ///< Frames to transmit, in the order of transmission
+    uint16_t num_tx_slots;
+    uint16_t num_tx_ops_in_flight;      ///< The slots are not changed while a chain is in flight
+    bool tx_wait_writable;              ///< The socket was full, the next chain waits for POLLOUT first
+    uint32_t epoll_events;              ///< The events that the epoll based loop waits for
+} LoopBus;
+
+#if IO_URING_AVAILABLE
+/// Layout of a receive buffer: the header of the multishot reception, the address, the ancillary data, the frame
+# define LOOP_RX_BUFFER_SIZE    (sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_can) + \
+                                 sizeof(ControlBuffer) + sizeof(SocketCANFrame))
+
+typedef struct
+{
+    int fd;
+    uint8_t* sq_ring;
+    size_t sq_ring_size;
+    uint8_t* cq_ring;                   ///< Same as sq_ring if the kernel maps both rings at once
+    size_t cq_ring_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    uint32_t* sq_khead;
+    uint32_t* sq_ktail;
+    uint32_t* sq_array;
+    uint32_t sq_mask;
+    uint32_t sq_entries;
+    uint32_t sq_tail;                   ///< Local tail, published to the kernel when submitting
+    uint32_t* cq_khead;
+    uint32_t* cq_ktail;
+    uint32_t cq_mask;
+    struct io_uring_cqe* cqes;
+    struct io_uring_buf_ring* buf_ring; ///< Followed by the receive buffers in the same mapping
+    size_t buf_ring_size;
+    uint16_t buf_tail;
+} LoopRing;
+#endif
+
+struct SocketCANLoopState
+{
+    LoopBus buses[SOCKETCAN_LOOP_MAX_BUSES];
+    uint8_t num_buses;
+    bool io_uring;
+    int epoll_fd;                       ///< The epoll based loop only
+    int timer_fd;
+    uint64_t timer_armed_at_usec;       ///< UINT64_MAX if the timer is disarmed
+#if IO_URING_AVAILABLE
+    LoopRing ring;
+#endif
+};
+
+/// Passes a received frame to the library unless it was transmitted by the instance itself
+static bool handleLoopFrame(LoopBus* bus, const CanardCANFrame* frame, const SocketCANFrameInfo* info)
+{
+    if (info->transmitted)
+    {
+        return false;
+    }
+    (void)canardHandleRxFrame(bus->canard, frame, info->timestamp_usec);
+    return true;
+}
+
+/**
+ * Transmits the queued frames of the bus without waiting, until the socket is full.
+ * Returns 0 on success, negative if a frame was dropped.
+ */
+static int16_t transmitPolledBus(LoopBus* bus)
+{
+    int16_t result = 0;
+    for (const CanardCANFrame* frame = canardPeekTxQueue(bus->canard);
+         frame != NULL;
+         frame = canardPeekTxQueue(bus->canard))
+    {
+        const int16_t tx_result = socketcanTransmit(bus->socketcan, frame, 0);
+        if (tx_result == 0)
+        {
+            break;                      // The socket is full
+        }
+        if (tx_result < 0)
+        {
+            result = tx_result;
+        }
+        canardPopTxQueue(bus->canard);
+    }
+    return result;
+}
+
+/// Returns the current time of CLOCK_MONOTONIC in microseconds, the time base of the frame timestamps
+static uint64_t getMonotonicTimestampUSec(void)
+{
+    return (uint64_t)getTimestampNSec(CLOCK_MONOTONIC) / 1000U;
+}
+
+/**
+ * Arms the timer of the epoll based loop to expire at the time, or disarms it if the time is UINT64_MAX.
+ * The timer is not touched if it is armed to that time already. Returns 0 on success, negative on error.
+ */
+static int16_t armLoopTimer(SocketCANLoopState* state, uint64_t wake_at_usec)
+{
+    if (wake_at_usec == state->timer_armed_at_usec)
+    {
+        return 0;
+    }
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (wake_at_usec != UINT64_MAX)
+    {
+        spec.it_value.tv_sec = (time_t)(wake_at_usec / 1000000U);
+        spec.it_value.tv_nsec = (long)(wake_at_usec % 1000000U) * 1000L;
+    }
+    if (timerfd_settime(state->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0)
+    {
+        return getErrorCode();
+    }
+    state->timer_armed_at_usec = wake_at_usec;
+    return 0;
+}
+
+/**
+ * The epoll based loop. Every socket is watched for reception, and for transmission while its TX queue is not empty.
+ * Waiting ends exactly at the wake up time, the timer file descriptor expires at it in CLOCK_MONOTONIC.
+ */
+static int16_t runEpollLoop(SocketCANLoopState* state, uint64_t wake_at_usec)
+{
+    int16_t result = 0;
+    for (uint8_t i = 0; i < state->num_buses; i++)
+    {
+        LoopBus* const bus = &state->buses[i];
+        const int16_t tx_result = transmitPolledBus(bus);
+        if (tx_result < 0)
+        {
+            result = tx_result;
+        }
+
+        const uint32_t events = EPOLLIN | ((canardPeekTxQueue(bus->canard) != NULL) ? (uint32_t)EPOLLOUT : 0U);
+        if (events != bus->epoll_events)
+        {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = events;
+            event.data.u32 = i;
+            if (epoll_ctl(state->epoll_fd, EPOLL_CTL_MOD, bus->socketcan->fd, &event) < 0)
+            {
+                return getErrorCode();
+            }
+            bus->epoll_events = events;
+        }
+    }
+
+    int timeout_msec = 0;
+    if (wake_at_usec > getMonotonicTimestampUSec())
+    {
+        const int16_t arm_result = armLoopTimer(state, wake_at_usec);
+        if (arm_result < 0)
+        {
+            return arm_result;
+        }
+        timeout_msec = -1;
+    }
+
+    struct epoll_event events[SOCKETCAN_LOOP_MAX_BUSES + 1U];
+    const int num_events = epoll_wait(state->epoll_fd, events, (int)(SOCKETCAN_LOOP_MAX_BUSES + 1U), timeout_msec);
+    if (num_events < 0)
+    {
+        return (int16_t)((errno == EINTR) ? result : getErrorCode());
+    }
+
+    CanardCANFrame frames[SOCKETCAN_MAX_BATCH_SIZE];
+    SocketCANFrameInfo infos[SOCKETCAN_MAX_BATCH_SIZE];
+    uint16_t num_frames = 0;
+    for (int k = 0; k < num_events; k++)
+    {
+        if (events[k].data.u32 == LOOP_TIMER_TOKEN)
+        {
+            uint64_t expirations = 0;
+            (void)read(state->timer_fd, &expirations, sizeof(expirations));
+            state->timer_armed_at_usec = UINT64_MAX;    // Expired, a one shot timer is disarmed
+            continue;
+        }
+        LoopBus* const bus = &state->buses[events[k].data.u32];
+        if (events[k].events & (EPOLLIN | EPOLLERR))
+        {
+            const int16_t rx_result = socketcanReceiveBatch(bus->socketcan, frames, infos,
+                                                            SOCKETCAN_MAX_BATCH_SIZE, 0);
+            if (rx_result < 0)
+            {
+                result = rx_result;
+            }
+            for (int16_t n = 0; n < rx_result; n++)
+            {
+                num_frames = (uint16_t)(num_frames + (handleLoopFrame(bus, &frames[n], &infos[n]) ? 1U : 0U));
+            }
+        }
+        if (events[k].events & EPOLLOUT)
+        {
+            const int16_t tx_result = transmitPolledBus(bus);
+            if (tx_result < 0)
+            {
+                result = tx_result;
+            }
+        }
+    }
+
+    if (result < 0)
+    {
+        return result;
+    }
+    return (int16_t)((num_frames > INT16_MAX) ? INT16_MAX : num_frames);
+}
+
+#if IO_URING_AVAILABLE
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void* arg,
+                        size_t arg_size)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size);
+}
+
+static int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned num_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, num_args);
+}
+
+/// Returns a receive buffer to the kernel
+static void recycleLoopBuffer(LoopRing* ring, uint16_t buffer_id)
+{
+    uint8_t* const buffers = (uint8_t*)ring->buf_ring + sizeof(struct io_uring_buf) * SOCKETCAN_LOOP_NUM_RX_BUFFERS;
+    struct io_uring_buf* const buf = &ring->buf_ring->bufs[ring->buf_tail & (SOCKETCAN_LOOP_NUM_RX_BUFFERS - 1U)];
+    buf->addr = (uint64_t)(uintptr_t)(buffers + (size_t)buffer_id * LOOP_RX_BUFFER_SIZE);
+    buf->len = (uint32_t)LOOP_RX_BUFFER_SIZE;
+    buf->bid = buffer_id;
+    ring->buf_tail++;
+    __atomic_store_n(&ring->buf_ring->tail, ring->buf_tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * Sets up the rings shared with the kernel and the provided receive buffers.
+ * Returns 0 on success, negative on error.
+ */
+static int16_t initLoopRing(LoopRing* ring)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = LOOP_CQ_ENTRIES;
+    ring->fd = ioUringSetup(LOOP_SQ_ENTRIES, &params);
+    if (ring->fd < 0)
+    {
+        goto fail0;
+    }
+    // The waiting needs the timeout argument, and the multishot reception must not lose completions
+    if (((params.features & IORING_FEAT_EXT_ARG) == 0) || ((params.features & IORING_FEAT_NODROP) == 0))
+    {
+        errno = ENOSYS;
+        goto fail1;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && (ring->cq_ring_size > ring->sq_ring_size))
+    {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+    void* const sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                               ring->fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED)
+    {
+        goto fail1;
+    }
+    ring->sq_ring = (uint8_t*)sq_ring;
+    ring->cq_ring = ring->sq_ring;
+    if (!single_mmap)
+    {
+        void* const cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                   ring->fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED)
+        {
+            goto fail2;
+        }
+        ring->cq_ring = (uint8_t*)cq_ring;
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* const sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        goto fail3;
+    }
+    ring->sqes = (struct io_uring_sqe*)sqes;
+
+    ring->sq_khead = (uint32_t*)(void*)(ring->sq_ring + params.sq_off.head);
+    ring->sq_ktail = (uint32_t*)(void*)(ring->sq_ring + params.sq_off.tail);
+    ring->sq_array = (uint32_t*)(void*)(ring->sq_ring + params.sq_off.array);
+    ring->sq_mask = *(uint32_t*)(void*)(ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_tail = *ring->sq_ktail;
+    ring->cq_khead = (uint32_t*)(void*)(ring->cq_ring + params.cq_off.head);
+    ring->cq_ktail = (uint32_t*)(void*)(ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = *(uint32_t*)(void*)(ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(void*)(ring->cq_ring + params.cq_off.cqes);
+
+    // The buffer ring must be page aligned, the buffers follow it
+    ring->buf_ring_size = sizeof(struct io_uring_buf) * SOCKETCAN_LOOP_NUM_RX_BUFFERS +
+                          LOOP_RX_BUFFER_SIZE * SOCKETCAN_LOOP_NUM_RX_BUFFERS;
+    void* const buf_ring = mmap(NULL, ring->buf_ring_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ring == MAP_FAILED)
+    {
+        goto fail4;
+    }
+    ring->buf_ring = (struct io_uring_buf_ring*)buf_ring;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)buf_ring;
+    reg.ring_entries = SOCKETCAN_LOOP_NUM_RX_BUFFERS;
+    reg.bgid = LOOP_BUFFER_GROUP;
+    if (ioUringRegister(ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        goto fail5;
+    }
+    for (uint16_t i = 0; i < SOCKETCAN_LOOP_NUM_RX_BUFFERS; i++)
+    {
+        recycleLoopBuffer(ring, i);
+    }
+    return 0;
+
+fail5:
+    (void)munmap(buf_ring, ring->buf_ring_size);
+fail4:
+    (void)munmap(sqes, ring->sqes_size);
+fail3:
+    if (!single_mmap)
+    {
+        (void)munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+fail2:
+    (void)munmap(sq_ring, ring->sq_ring_size);
+fail1:
+    (void)close(ring->fd);
+fail0:
+    return getErrorCode();
+}
+
+static uint32_t getFreeSQEs(const LoopRing* ring)
+{
+    return ring->sq_entries - (ring->sq_tail - __atomic_load_n(ring->sq_khead, __ATOMIC_ACQUIRE));
+}
+
+/// Returns the next SQE, cleared. The caller ensures that it is free, see getFreeSQEs().
+static struct io_uring_sqe* getSQE(LoopRing* ring, uint8_t op, uint8_t bus_index, uint16_t slot_index)
+{
+    const uint32_t index = ring->sq_tail & ring->sq_mask;
+    struct io_uring_sqe* const sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = (uint64_t)op | ((uint64_t)bus_index << 8U) | ((uint64_t)slot_index << 16U);
+    ring->sq_array[index] = index;
+    ring->sq_tail++;
+    return sqe;
+}
+
+static void closeLoopRing(LoopRing* ring)
+{
+    // Cancelling the operations in flight and reaping the completions here, in the submitting thread. If the ring
+    // were just closed, the kernel would complete them later with task work, which interrupts (EINTR) the next
+    // blocking system call of this thread.
+    if (getFreeSQEs(ring) > 0)
+    {
+        struct io_uring_sqe* const sqe = getSQE(ring, LOOP_OP_CANCEL, 0, 0);
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL | IORING_ASYNC_CANCEL_ANY;
+        __atomic_store_n(ring->sq_ktail, ring->sq_tail, __ATOMIC_RELEASE);
+
+        struct __kernel_timespec ts;
+        memset(&ts, 0, sizeof(ts));
+        ts.tv_nsec = 100000000LL;
+        struct io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        (void)ioUringEnter(ring->fd, ring->sq_entries - getFreeSQEs(ring), 1U,
+                           IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    }
+
+    (void)close(ring->fd);
+    (void)munmap(ring->buf_ring, ring->buf_ring_size);
+    (void)munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring)
+    {
+        (void)munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    (void)munmap(ring->sq_ring, ring->sq_ring_size);
+}
+
+/// Starts the multishot reception into the provided buffers
+static void submitLoopReceive(LoopRing* ring, LoopBus* bus, uint8_t bus_index)
+{
+    struct io_uring_sqe* const sqe = getSQE(ring, LOOP_OP_RECEIVE, bus_index, 0);
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = bus->socketcan->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&bus->rx_msg;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = LOOP_BUFFER_GROUP;
+    bus->rx_armed = true;
+}
+
+/**
+ * Moves the frames of the TX queue into the free TX slots, one slot per interface copy.
+ */
+static void fillLoopTxSlots(LoopBus* bus)
+{
+    const SocketCANInstance* const ins = bus->socketcan;
+    for (const CanardCANFrame* frame = canardPeekTxQueue(bus->canard);
+         frame != NULL;
+         frame = canardPeekTxQueue(bus->canard))
+    {
+        const uint8_t iface_mask = getTransmitIfaceMask(ins, frame);
+        uint16_t num_copies = 0;
+        for (uint8_t k = 0; k < SOCKETCAN_MAX_IFACES; k++)
+        {
+            num_copies = (uint16_t)(num_copies + ((iface_mask >> k) & 1U));
+        }
+        if ((bus->num_tx_slots + num_copies) > SOCKETCAN_LOOP_MAX_TX_IN_FLIGHT)
+        {
+            break;
+        }
+
+        for (uint8_t k = 0; k < SOCKETCAN_MAX_IFACES; k++)
+        {
+            if ((iface_mask & (1U << k)) == 0)
+            {
+                continue;
+            }
+            LoopTxSlot* const slot = &bus->tx_slots[bus->num_tx_slots++];
+            slot->frame_size = toSocketCANFrame(frame, &slot->frame);
+            memset(&slot->addr, 0, sizeof(slot->addr));
+            slot->addr.can_family = AF_CAN;
+            slot->addr.can_ifindex = (ins->num_ifaces > 0) ? ins->ifindices[k] : 0;
+        }
+        canardPopTxQueue(bus->canard);
+    }
+}
+
+/**
+ * Submits the frames of the TX slots as a chain of linked send operations, which keeps their order.
+ * If the socket was full, the chain starts with waiting for it to become writable.
+ */
+static void submitLoopTransmit(LoopRing* ring, LoopBus* bus, uint8_t bus_index)
+{
+    fillLoopTxSlots(bus);
+    const uint32_t num_ops = bus->num_tx_slots + (bus->tx_wait_writable ? 1U : 0U);
+    if ((bus->num_tx_slots == 0) || (num_ops > getFreeSQEs(ring)))
+    {
+        return;
+    }
+
+    if (bus->tx_wait_writable)
+    {
+        struct io_uring_sqe* const sqe = getSQE(ring, LOOP_OP_WAIT_WRITABLE, bus_index, 0);
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = bus->socketcan->fd;
+        sqe->poll32_events = POLLOUT;
+        sqe->flags = IOSQE_IO_LINK;
+        bus->tx_wait_writable = false;
+    }
+    for (uint16_t i = 0; i < bus->num_tx_slots; i++)
+    {
+        LoopTxSlot* const slot = &bus->tx_slots[i];
+        memset(&slot->msg, 0, sizeof(slot->msg));
+        slot->iov.iov_base = &slot->frame;
+        slot->iov.iov_len = slot->frame_size;
+        slot->msg.msg_iov = &slot->iov;
+        slot->msg.msg_iovlen = 1;
+        if (bus->socketcan->num_ifaces > 0)
+        {
+            slot->msg.msg_name = &slot->addr;
+            slot->msg.msg_namelen = sizeof(slot->addr);
+        }
+
+        struct io_uring_sqe* const sqe = getSQE(ring, LOOP_OP_TRANSMIT, bus_index, i);
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = bus->socketcan->fd;
+        sqe->addr = (uint64_t)(uintptr_t)&slot->msg;
+        sqe->len = 1;
+        sqe->flags = (uint8_t)(((i + 1U) < bus->num_tx_slots) ? IOSQE_IO_LINK : 0U);
+    }
+    bus->num_tx_ops_in_flight = (uint16_t)num_ops;
+}
+
+/**
+ * Accounts for a completed send operation; once the whole chain is completed, the transmitted frames are removed.
+ * The frames that found the socket full, and those cancelled after them, are kept in order for the next chain.
+ * Returns 0 on success, negative if a frame was dropped.
+ */
+static int16_t completeLoopTransmit(LoopBus* bus, uint8_t op, uint16_t slot_index, int32_t result)
+{
+    if ((op == LOOP_OP_TRANSMIT) && (slot_index < bus->num_tx_slots))
+    {
+        bus->tx_slots[slot_index].result = result;
+    }
+    bus->num_tx_ops_in_flight--;
+    if (bus->num_tx_ops_in_flight > 0)
+    {
+        return 0;
+    }
+
+    int16_t out = 0;
+    uint16_t num_kept = 0;
+    for (uint16_t i = 0; i < bus->num_tx_slots; i++)
+    {
+        const int32_t slot_result = bus->tx_slots[i].result;
+        if ((slot_result == -EAGAIN) || (slot_result == -ECANCELED))
+        {
+            bus->tx_wait_writable = bus->tx_wait_writable || (slot_result == -EAGAIN);
+            if (num_kept != i)
+            {
+                bus->tx_slots[num_kept] = bus->tx_slots[i];
+            }
+            num_kept++;
+        }
+        else if (slot_result < 0)
+        {
+            out = (int16_t)((slot_result >= INT16_MIN) ? slot_result : INT16_MIN);
+        }
+        else if ((size_t)slot_result != bus->tx_slots[i].frame_size)
+        {
+            out = -EIO;
+        }
+    }
+    bus->num_tx_slots = num_kept;
+    return out;
+}
+
+/**
+ * Passes the frame of a completed reception to the library and returns the buffer to the kernel.
+ * Returns true if the frame was passed to the library.
+ */
+static bool completeLoopReceive(LoopRing* ring, LoopBus* bus, const struct io_uring_cqe* cqe,
+                                int64_t realtime_to_monotonic_nsec)
+{
+    if ((cqe->flags & IORING_CQE_F_BUFFER) == 0)
+    {
+        return false;
+    }
+    const uint16_t buffer_id = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    const uint8_t* const buffer = (const uint8_t*)ring->buf_ring +
+                                  sizeof(struct io_uring_buf) * SOCKETCAN_LOOP_NUM_RX_BUFFERS +
+                                  (size_t)buffer_id * LOOP_RX_BUFFER_SIZE;
+
+    bool handled = false;
+    struct io_uring_recvmsg_out out;
+    memcpy(&out, buffer, sizeof(out));
+    if ((cqe->res >= 0) && ((out.flags & MSG_TRUNC) == 0))
+    {
+        // The kernel lays out the name and the ancillary data with the sizes requested, then the payload
+        uint8_t* const name = (uint8_t*)buffer + sizeof(out);
+        uint8_t* const control = name + bus->rx_msg.msg_namelen;
+        const uint8_t* const payload = control + bus->rx_msg.msg_controllen;
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = name;
+        msg.msg_namelen = (out.namelen < bus->rx_msg.msg_namelen) ? out.namelen : bus->rx_msg.msg_namelen;
+        msg.msg_control = control;
+        msg.msg_controllen = (out.controllen < bus->rx_msg.msg_controllen) ? out.controllen :
+                                                                            bus->rx_msg.msg_controllen;
+
+        SocketCANFrame frame;
+        CanardCANFrame canard_frame;
+        const int16_t iface_id = getReceiveIfaceID(bus->socketcan, &msg);
+        if ((iface_id >= 0) && (out.payloadlen <= sizeof(frame)))
+        {
+            memcpy(&frame, payload, out.payloadlen);
+            if (fromSocketCANFrame(&frame, out.payloadlen, &canard_frame) == 0)
+            {
+                canard_frame.iface_id = (uint8_t)iface_id;
+                SocketCANFrameInfo info;
+                info.timestamp_usec = getMessageTimestampUSec(&msg, realtime_to_monotonic_nsec);
+                info.transmitted = (out.flags & MSG_CONFIRM) != 0;
+                handled = handleLoopFrame(bus, &canard_frame, &info);
+            }
+        }
+    }
+
+    recycleLoopBuffer(ring, buffer_id);
+    return handled;
+}
+
+/// The io_uring based loop
+static int16_t runIOUringLoop(SocketCANLoopState* state, uint64_t wake_at_usec)
+{
+    LoopRing* const ring = &state->ring;
+    for (uint8_t i = 0; i < state->num_buses; i++)
+    {
+        LoopBus* const bus = &state->buses[i];
+        if (!bus->rx_armed && (getFreeSQEs(ring) > 0))
+        {
+            submitLoopReceive(ring, bus, i);
+        }
+        if (bus->num_tx_ops_in_flight == 0)
+        {
+            submitLoopTransmit(ring, bus, i);
+        }
+    }
+
+    // One system call submits the operations and waits for the completions until the wake up time
+    __atomic_store_n(ring->sq_ktail, ring->sq_tail, __ATOMIC_RELEASE);
+    const unsigned to_submit = ring->sq_entries - getFreeSQEs(ring);
+    struct __kernel_timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    unsigned min_complete = 1;
+    if (wake_at_usec != UINT64_MAX)
+    {
+        const uint64_t now_usec = getMonotonicTimestampUSec();
+        const uint64_t wait_usec = (wake_at_usec > now_usec) ? (wake_at_usec - now_usec) : 0U;
+        ts.tv_sec = (long long)(wait_usec / 1000000U);
+        ts.tv_nsec = (long long)(wait_usec % 1000000U) * 1000LL;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        min_complete = (wait_usec > 0) ? 1U : 0U;
+    }
+    const int enter_result = ioUringEnter(ring->fd, to_submit, min_complete,
+                                          IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    if ((enter_result < 0) && (errno != ETIME) && (errno != EINTR))
+    {
+        return getErrorCode();
+    }
+
+    const int64_t realtime_to_monotonic_nsec = getTimestampNSec(CLOCK_MONOTONIC) - getTimestampNSec(CLOCK_REALTIME);
+    int16_t result = 0;
+    uint16_t num_frames = 0;
+    uint32_t head = *ring->cq_khead;
+    const uint32_t tail = __atomic_load_n(ring->cq_ktail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++)
+    {
+        const struct io_uring_cqe* const cqe = &ring->cqes[head & ring->cq_mask];
+        const uint8_t op = (uint8_t)(cqe->user_data & 0xFFU);
+        const uint8_t bus_index = (uint8_t)((cqe->user_data >> 8U) & 0xFFU);
+        const uint16_t slot_index = (uint16_t)((cqe->user_data >> 16U) & 0xFFFFU);
+        if (bus_index >= state->num_buses)
+        {
+            continue;
+        }
+        LoopBus* const bus = &state->buses[bus_index];
+
+        if (op == LOOP_OP_RECEIVE)
+        {
+            if (completeLoopReceive(ring, bus, cqe, realtime_to_monotonic_nsec))
+            {
+                num_frames++;
+            }
+            if ((cqe->flags & IORING_CQE_F_MORE) == 0)
+            {
+                bus->rx_armed = false;  // Re-armed in the next iteration
+            }
+            if ((cqe->res < 0) && (cqe->res != -ENOBUFS))
+            {
+                result = (int16_t)((cqe->res >= INT16_MIN) ? cqe->res : INT16_MIN);
+            }
+        }
+        else
+        {
+            const int16_t tx_result = completeLoopTransmit(bus, op, slot_index, cqe->res);
+            if (tx_result < 0)
+            {
+                result = tx_result;
+            }
+        }
+    }
+    __atomic_store_n(ring->cq_khead, head, __ATOMIC_RELEASE);
+
+    if (result < 0)
+    {
+        return result;
+    }
+    return (int16_t)((num_frames > INT16_MAX) ? INT16_MAX : num_frames);
+}
+
+/**
+ * Checks that the kernel supports the multishot reception into provided buffers (Linux 6.0),
+ * receiving a datagram through a throwaway ring.
+ */
+static bool probeIOUring(void)
+{
+    LoopRing ring;
+    if (initLoopRing(&ring) < 0)
+    {
+        return false;
+    }
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds) < 0)
+    {
+        closeLoopRing(&ring);
+        return false;
+    }
+
+    bool supported = false;
+    const uint8_t byte = 0;
+    if (write(fds[1], &byte, sizeof(byte)) == (ssize_t)sizeof(byte))
+    {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        struct io_uring_sqe* const sqe = getSQE(&ring, LOOP_OP_RECEIVE, 0, 0);
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = fds[0];
+        sqe->addr = (uint64_t)(uintptr_t)&msg;
+        sqe->len = 1;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = LOOP_BUFFER_GROUP;
+        __atomic_store_n(ring.sq_ktail, ring.sq_tail, __ATOMIC_RELEASE);
+        if (ioUringEnter(ring.fd, 1, 1, IORING_ENTER_GETEVENTS, NULL, 0) == 1)
+        {
+            const uint32_t head = *ring.cq_khead;
+            if (head != __atomic_load_n(ring.cq_ktail, __ATOMIC_ACQUIRE))
+            {
+                supported = ring.cqes[head & ring.cq_mask].res >= 0;
+            }
+        }
+    }
+
+    closeLoopRing(&ring);
+    (void)close(fds[0]);
+    (void)close(fds[1]);
+    return supported;
+}
+
+#endif // IO_URING_AVAILABLE
+
+int16_t socketcanLoopInit(SocketCANLoop* out_loop, bool allow_io_uring)
+{
+    void* const memory = mmap(NULL, sizeof(SocketCANLoopState), PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        return getErrorCode();
+    }
+    SocketCANLoopState* const state = (SocketCANLoopState*)memory;     // Zeroed by the kernel
+    state->io_uring = false;
+    state->epoll_fd = -1;
+    state->timer_fd = -1;
+    state->timer_armed_at_usec = UINT64_MAX;
+#if IO_URING_AVAILABLE
+    // Seccomp policies and the io_uring_disabled sysctl make the system calls fail, old kernels lack the features
+    state->io_uring = allow_io_uring && probeIOUring() && (initLoopRing(&state->ring) == 0);
+#else
+    (void)allow_io_uring;
+#endif
+
+    if (!state->io_uring)
+    {
+        state->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (state->epoll_fd < 0)
+        {
+            goto fail0;
+        }
+        state->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (state->timer_fd < 0)
+        {
+            goto fail1;
+        }
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = LOOP_TIMER_TOKEN;
+        if (epoll_ctl(state->epoll_fd, EPOLL_CTL_ADD, state->timer_fd, &event) < 0)
+        {
+            goto fail2;
+        }
+    }
+
+    out_loop->state = state;
+    return 0;
+
+fail2:
+    (void)close(state->timer_fd);
+fail1:
+    (void)close(state->epoll_fd);
+fail0:
+    {
+        const int16_t out = getErrorCode();
+        (void)munmap(memory, sizeof(SocketCANLoopState));
+        return out;
+    }
+}
+
+int16_t socketcanLoopClose(SocketCANLoop* loop)
+{
+#if IO_URING_AVAILABLE
+    if (loop->state->io_uring)
+    {
+        closeLoopRing(&loop->state->ring);
+    }
+#endif
+    if (!loop->state->io_uring)
+    {
+        (void)close(loop->state->timer_fd);
+        (void)close(loop->state->epoll_fd);
+    }
+    const int munmap_result = munmap(loop->state, sizeof(SocketCANLoopState));
+    loop->state = NULL;
+    return (int16_t)((munmap_result == 0) ? 0 : getErrorCode());
+}
+
+int16_t socketcanLoopAddBus(SocketCANLoop* loop, SocketCANInstance* socketcan, CanardInstance* canard)
+{
+    SocketCANLoopState* const state = loop->state;
+    if ((socketcan == NULL) || (canard == NULL))
+    {
+        return -EINVAL;
+    }
+    if (state->num_buses >= SOCKETCAN_LOOP_MAX_BUSES)
+    {
+        return -ENOSPC;
+    }
+
+    LoopBus* const bus = &state->buses[state->num_buses];
+    memset(bus, 0, sizeof(*bus));
+    bus->socketcan = socketcan;
+    bus->canard = canard;
+    bus->rx_msg.msg_namelen = (socketcan->num_ifaces > 0) ? sizeof(struct sockaddr_can) : 0U;
+    bus->rx_msg.msg_controllen = sizeof(ControlBuffer);
+
+    if (!state->io_uring)
+    {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = state->num_buses;
+        if (epoll_ctl(state->epoll_fd, EPOLL_CTL_ADD, socketcan->fd, &event) < 0)
+        {
+            return getErrorCode();
+        }
+        bus->epoll_events = EPOLLIN;
+    }
+
+    state->num_buses++;
+    return 0;
+}
+
+int16_t socketcanLoopRunUntil(SocketCANLoop* loop, uint64_t deadline_usec)
+{
+    SocketCANLoopState* const state = loop->state;
+
+    // Waking up for the library deadlines too, so that no periodic cleanup is needed
+    uint64_t wake_at_usec = deadline_usec;
+    for (uint8_t i = 0; i < state->num_buses; i++)
+    {
+        const uint64_t library_deadline_usec = canardGetNextDeadline(state->buses[i].canard);
+        if (library_deadline_usec < wake_at_usec)
+        {
+            wake_at_usec = library_deadline_usec;
+        }
+    }
+
+    int16_t result = 0;
+#if IO_URING_AVAILABLE
+    if (state->io_uring)
+    {
+        result = runIOUringLoop(state, wake_at_usec);
+    }
+    else
+#endif
+    {
+        result = runEpollLoop(state, wake_at_usec);
+    }
+
+    const uint64_t now_usec = getMonotonicTimestampUSec();
+    for (uint8_t i = 0; i < state->num_buses; i++)
+    {
+        if (canardGetNextDeadline(state->buses[i].canard) <= now_usec)
+        {
+            canardCleanupStaleTransfers(state->buses[i].canard, now_usec);
+        }
+    }
+    return result;
+}
+
+int16_t socketcanLoopRunOnce(SocketCANLoop* loop, int32_t timeout_msec)
+{
+    const uint64_t deadline_usec = (timeout_msec < 0) ? UINT64_MAX :
+                                   (getMonotonicTimestampUSec() + (uint64_t)timeout_msec * 1000U);
+    return socketcanLoopRunUntil(loop, deadline_usec);
+}
+
+bool socketcanLoopUsesIOUring(const SocketCANLoop* loop)
+{
+    return loop->state->io_uring;
+}
@@ -15,17 +15,70 @@ extern "C"
 {
 #endif
 
+/// The maximum number of frames transferred with one system call by the batch functions.
+#ifndef SOCKETCAN_MAX_BATCH_SIZE
+# define SOCKETCAN_MAX_BATCH_SIZE       64U
+#endif
+
+/// The maximum number of acceptance filters, see socketcanConfigureAcceptanceFilters().
+#ifndef SOCKETCAN_MAX_ACCEPTANCE_FILTERS
+# define SOCKETCAN_MAX_ACCEPTANCE_FILTERS   64U
+#endif
+
+/// The maximum number of interfaces served by one instance, see socketcanInitMultiIface().
+/// Cannot exceed 8, the width of CanardCANFrame.iface_mask.
+#ifndef SOCKETCAN_MAX_IFACES
+# define SOCKETCAN_MAX_IFACES           8U
+#endif
+
 typedef struct
 {
     int fd;
+    uint8_t num_ifaces;                         ///< Zero if the socket is bound to a single interface
+    int ifindices[SOCKETCAN_MAX_IFACES];        ///< Kernel interface index of every iface_id
 } SocketCANInstance;
 
+/**
+ * Details of a received frame, reported by socketcanReceiveBatch().
+ */
+typedef struct
+{
+    /**
+     * Kernel timestamp of the frame in microseconds, in the time base of CLOCK_MONOTONIC.
+     * Unlike a timestamp taken after the frame was read, it does not include the scheduling latency.
+     * If the frame was transmitted by this instance, it is the time when the transmission was completed.
+     */
+    uint64_t timestamp_usec;
+
+    /**
+     * True if the frame was transmitted by this instance, see socketcanEnableTransmitTimestamps().
+     * Such frames must not be passed to canardHandleRxFrame().
+     */
+    bool transmitted;
+} SocketCANFrameInfo;
+
 /**
  * Initializes the SocketCAN instance.
+ * The kernel timestamps received frames (SO_TIMESTAMPNS), see socketcanReceiveBatch().
+ * If the library is built with CANARD_ENABLE_CANFD, the socket accepts CAN FD frames as well as classic frames;
+ * the canfd field of a frame selects its format, and CAN FD frames require an interface with the CAN FD MTU.
  * Returns 0 on success, negative on error.
  */
 int16_t socketcanInit(SocketCANInstance* out_ins, const char* can_iface_name);
 
+/**
+ * Initializes the SocketCAN instance with one socket that serves several interfaces, e.g. redundant buses.
+ * The socket is bound to all CAN interfaces; the frames of the interfaces that are not served are dropped.
+ * The interfaces are named by can_iface_names; if num_ifaces is zero, all CAN interfaces are served
+ * (at most SOCKETCAN_MAX_IFACES) in the order of their kernel interface indices.
+ *
+ * The iface_id of a received frame is the index of its interface in this order.
+ * If the library is built with CANARD_MULTI_IFACE, frames are transmitted on the interfaces selected by
+ * their iface_mask (bit N selects iface_id N), otherwise on all interfaces.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanInitMultiIface(SocketCANInstance* out_ins, const char* const* can_iface_names, uint8_t num_ifaces);
+
 /**
  * Deinitializes the SocketCAN instance.
  * Returns 0 on success, negative on error.
@@ -42,16 +95,211 @@ int16_t socketcanTransmit(SocketCANInstance* ins, const CanardCANFrame* frame, i
 /**
  * Receives a CanardCANFrame from the CAN socket.
  * Use negative timeout to block infinitely.
+ * Use socketcanReceiveBatch() to obtain the kernel timestamp of the frame.
  * Returns 1 on successful reception, 0 on timeout, negative on error.
  */
 int16_t socketcanReceive(SocketCANInstance* ins, CanardCANFrame* out_frame, int32_t timeout_msec);
 
+/**
+ * Transmits up to num_frames CanardCANFrames (at most SOCKETCAN_MAX_BATCH_SIZE) with a single system call.
+ * The frames are written without waiting first; the function waits for the socket only if it is not writable.
+ * Use negative timeout to block infinitely.
+ * Returns the number of transmitted frames, which is less than num_frames if the socket buffer got full,
+ * 0 on timeout, negative on error.
+ * A frame that is transmitted on several interfaces takes one system call slot per interface; it is reported as
+ * transmitted once any of its copies has been written, repeating it would break the multi-frame transfers.
+ */
+int16_t socketcanTransmitBatch(SocketCANInstance* ins,
+                               const CanardCANFrame* frames,
+                               uint16_t num_frames,
+                               int32_t timeout_msec);
+
+/**
+ * Receives up to max_frames CanardCANFrames (at most SOCKETCAN_MAX_BATCH_SIZE) with a single system call.
+ * The frames that are already queued are read without waiting; the function waits only if there are none.
+ * If out_infos is not NULL, it receives the timestamp and the origin of every frame.
+ * Use negative timeout to block infinitely.
+ * Returns the number of received frames, 0 on timeout or if only frames of the interfaces that are not served
+ * were received, negative on error.
+ */
+int16_t socketcanReceiveBatch(SocketCANInstance* ins,
+                              CanardCANFrame* out_frames,
+                              SocketCANFrameInfo* out_infos,
+                              uint16_t max_frames,
+                              int32_t timeout_msec);
+
+/**
+ * Enables or disables the reception of the frames transmitted by this instance (CAN_RAW_RECV_OWN_MSGS).
+ * They are received once their transmission is completed, with the flag SocketCANFrameInfo.transmitted set,
+ * so their timestamps are the transmission timestamps. Disabled by default.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanEnableTransmitTimestamps(SocketCANInstance* ins, bool enable);
+
+/**
+ * Configures the acceptance filters of the socket (CAN_RAW_FILTER), so that the kernel drops the frames that
+ * pass none of the filters. The filters can be computed using canardComputeAcceptanceFilters().
+ * Zero filters reject all frames. By default the socket accepts all frames.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanConfigureAcceptanceFilters(SocketCANInstance* ins,
+                                            const CanardAcceptanceFilter* filters,
+                                            uint8_t num_filters);
+
 /**
  * Returns the file descriptor of the CAN socket.
  * Can be used for external IO multiplexing.
  */
 int socketcanGetSocketFileDescriptor(const SocketCANInstance* ins);
 
+/*
+ * Memory mapped reception.
+ * A PF_PACKET socket with a TPACKET_V3 ring buffer on the CAN interface lets the kernel store the frames in memory
+ * that is shared with the application, so no system calls are needed while frames are arriving.
+ * This suits bus loggers and gateways on busy buses. It needs the CAP_NET_RAW capability.
+ * The kernel hands the ring blocks over when they are full or after SOCKETCAN_RING_BLOCK_TIMEOUT_MSEC,
+ * which limits the added latency.
+ */
+
+/// Size of a ring block in bytes, must be a multiple of the page size.
+#ifndef SOCKETCAN_RING_BLOCK_SIZE
+# define SOCKETCAN_RING_BLOCK_SIZE      65536U
+#endif
+
+/// Number of blocks in the ring.
+#ifndef SOCKETCAN_RING_NUM_BLOCKS
+# define SOCKETCAN_RING_NUM_BLOCKS      16U
+#endif
+
+/// Time after which the kernel hands over a block that is not full.
+#ifndef SOCKETCAN_RING_BLOCK_TIMEOUT_MSEC
+# define SOCKETCAN_RING_BLOCK_TIMEOUT_MSEC  1U
+#endif
+
+typedef struct
+{
+    int fd;
+    int ifindex;                        ///< Kernel interface index of the interface
+    uint8_t* ring;                      ///< SOCKETCAN_RING_NUM_BLOCKS blocks mapped from the kernel
+    uint32_t current_block;             ///< The block that is being read
+    uint32_t num_remaining_packets;     ///< Unread packets in the current block, zero if it is not handed over yet
+    uint32_t next_packet_offset;        ///< Offset of the next unread packet in the current block
+} SocketCANRingInstance;
+
+/**
+ * Initializes the memory mapped reception from the interface.
+ * Only the CAN and CAN FD frames of the interface are received into the ring.
+ * Requires the CAP_NET_RAW capability.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanRingInit(SocketCANRingInstance* out_ins, const char* can_iface_name);
+
+/**
+ * Deinitializes the memory mapped reception.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanRingClose(SocketCANRingInstance* ins);
+
+/**
+ * Reads up to max_frames CanardCANFrames from the ring, like socketcanReceiveBatch().
+ * The frames are taken straight from the ring blocks; the function waits only if no block is handed over.
+ * The frames transmitted by the host are received once, when they are looped back.
+ * Use negative timeout to block infinitely.
+ * Returns the number of received frames, 0 on timeout, negative on error.
+ */
+int16_t socketcanRingReceiveBatch(SocketCANRingInstance* ins,
+                                  CanardCANFrame* out_frames,
+                                  SocketCANFrameInfo* out_infos,
+                                  uint16_t max_frames,
+                                  int32_t timeout_msec);
+
+/**
+ * Returns the file descriptor of the packet socket.
+ * Can be used for external IO multiplexing.
+ */
+int socketcanRingGetSocketFileDescriptor(const SocketCANRingInstance* ins);
+
+/*
+ * Event loop.
+ * Serves several buses from one thread, each of them with its own SocketCAN instance and library instance:
+ * it transmits the frames of the TX queues and passes the received frames to canardHandleRxFrame().
+ * Where the kernel supports it (Linux 6.0 or newer), the loop is built on io_uring: the sockets receive with
+ * multishot operations into a shared ring of provided buffers, and the frames of every TX queue are transmitted
+ * with a chain of linked send operations, so that one system call per iteration submits all transmissions and
+ * collects all receptions of all buses. Otherwise the loop falls back to epoll and the batch functions.
+ *
+ * The loop is tickless: it sleeps until I/O arrives or until the deadline of the application, e.g. its next
+ * scheduled publication, or the earliest deadline of the library instances (canardGetNextDeadline()), whichever
+ * is first. The expired library deadlines are serviced by the loop, the application needs no periodic cleanup.
+ */
+
+/// The maximum number of buses served by one loop.
+#ifndef SOCKETCAN_LOOP_MAX_BUSES
+# define SOCKETCAN_LOOP_MAX_BUSES       8U
+#endif
+
+/// The maximum number of frames of a bus that are being transmitted at once, one per interface copy.
+/// Cannot be less than SOCKETCAN_MAX_IFACES.
+#ifndef SOCKETCAN_LOOP_MAX_TX_IN_FLIGHT
+# define SOCKETCAN_LOOP_MAX_TX_IN_FLIGHT    16U
+#endif
+
+/// Number of receive buffers shared by the buses, must be a power of two.
+#ifndef SOCKETCAN_LOOP_NUM_RX_BUFFERS
+# define SOCKETCAN_LOOP_NUM_RX_BUFFERS  256U
+#endif
+
+typedef struct SocketCANLoopState SocketCANLoopState;
+
+typedef struct
+{
+    SocketCANLoopState* state;          ///< Allocated by socketcanLoopInit()
+} SocketCANLoop;
+
+/**
+ * Initializes the event loop. If allow_io_uring is false or io_uring is not usable, the loop uses epoll,
+ * with a timer file descriptor for the wake up time.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanLoopInit(SocketCANLoop* out_loop, bool allow_io_uring);
+
+/**
+ * Deinitializes the event loop. The frames that are being transmitted may be lost; the instances are not closed.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanLoopClose(SocketCANLoop* loop);
+
+/**
+ * Adds a bus to the loop: the frames received by the SocketCAN instance are passed to the library instance,
+ * and the TX queue of the library instance is transmitted through the SocketCAN instance.
+ * The frames transmitted by the SocketCAN instance itself (socketcanEnableTransmitTimestamps()) are dropped.
+ * Both instances must outlive the loop.
+ * Returns 0 on success, negative on error.
+ */
+int16_t socketcanLoopAddBus(SocketCANLoop* loop, SocketCANInstance* socketcan, CanardInstance* canard);
+
+/**
+ * Runs one iteration of the loop: starts the transmission of the queued frames of all buses,
+ * waits for an event until the deadline and processes all events that are pending.
+ * The deadline is in microseconds of CLOCK_MONOTONIC, the time base of the frame timestamps; UINT64_MAX means none.
+ * The wait also ends at the earliest deadline of the library instances, which is then serviced.
+ * The frames that are queued by the reception callbacks are transmitted in the next iteration.
+ * Returns the number of frames passed to canardHandleRxFrame(), 0 on timeout or if only transmissions were completed,
+ * negative on error. A frame that cannot be transmitted is dropped and its error is returned.
+ */
+int16_t socketcanLoopRunUntil(SocketCANLoop* loop, uint64_t deadline_usec);
+
+/**
+ * Same as socketcanLoopRunUntil() with a deadline relative to the current time.
+ * Use negative timeout to block infinitely.
+ */
+int16_t socketcanLoopRunOnce(SocketCANLoop* loop, int32_t timeout_msec);
+
+/**
+ * Returns true if the loop is built on io_uring, false if it uses epoll.
+ */
+bool socketcanLoopUsesIOUring(const SocketCANLoop* loop);
+
 #ifdef __cplusplus
 }
 #endif
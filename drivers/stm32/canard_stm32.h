@@ -87,12 +87,10 @@ typedef struct
 /**
  * ID and Mask of a hardware acceptance filter.
  * The ID and Mask fields support flags @ref CANARD_CAN_FRAME_EFF and @ref CANARD_CAN_FRAME_RTR.
+ * The filters can be computed from the accepted transfers using canardComputeAcceptanceFilters(),
+ * with at most @ref CANARD_STM32_NUM_ACCEPTANCE_FILTERS filters.
  */
-typedef struct
-{
-    uint32_t id;
-    uint32_t mask;
-} CanardSTM32AcceptanceFilterConfiguration;
+typedef CanardAcceptanceFilter CanardSTM32AcceptanceFilterConfiguration;
 
 /**
  * These parameters define the timings of the CAN controller.
@@ -28,8 +28,16 @@ except NameError:
 
 OUTPUT_HEADER_FILE_EXTENSION = 'h'
 OUTPUT_CODE_FILE_EXTENSION = 'c'
+OUTPUT_CPP_HEADER_FILE_EXTENSION = 'hpp'
 HEADER_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'data_type_template.tmpl')
 CODE_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'code_type_template.tmpl')
+CPP_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'cpp_type_template.tmpl')
+DISPATCH_HEADER_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'dispatch_template.tmpl')
+DISPATCH_CODE_TEMPLATE_FILENAME = os.path.join(os.path.dirname(__file__), 'dispatch_code_template.tmpl')
+DISPATCH_OUTPUT_FILENAME = 'canard_dsdl_dispatch'
+CODEC_RUNTIME_FILENAMES = [os.path.join(os.path.dirname(__file__), 'canard_dsdl_codec.h'),
+                           os.path.join(os.path.dirname(__file__), 'canard_dsdl_codec.c')]
+CODEC_MODES = ['unrolled', 'table']
 
 __all__ = ['run', 'logger', 'DsdlCompilerException']
 
@@ -38,7 +46,7 @@ class DsdlCompilerException(Exception):
 
 logger = logging.getLogger(__name__)
 
-def run(source_dirs, include_dirs, output_dir, header_only):
+def run(source_dirs, include_dirs, output_dir, header_only, codec='unrolled', cpp=False, dispatch=False):
     '''
     This function takes a list of root namespace directories (containing DSDL definition files to parse), a
     possibly empty list of search directories (containing DSDL definition files that can be referenced from the types
@@ -55,9 +63,15 @@ def run(source_dirs, include_dirs, output_dir, header_only):
                        automaitcally extended with source_dirs.
         output_dir     Output directory path. Will be created if doesn't exist.
         header_only    Weather to generated as header only library.
+        codec          'unrolled' emits dedicated encoding/decoding functions for every type,
+                       'table' emits field descriptor tables interpreted by canard_dsdl_codec.c.
+        cpp            Weather to generate C++17 headers (.hpp) on top of the C output.
+        dispatch       Weather to generate the dispatch table of all types with a default data type ID.
     '''
     assert isinstance(source_dirs, list)
     assert isinstance(include_dirs, list)
+    if codec not in CODEC_MODES:
+        die('Unknown codec mode: %s' % codec)
     output_dir = str(output_dir)
 
     types = run_parser(source_dirs, include_dirs + source_dirs)
@@ -65,7 +79,7 @@ def run(source_dirs, include_dirs, output_dir, header_only):
         die('No type definitions were found')
 
     logger.info('%d types total', len(types))
-    run_generator(types, output_dir, header_only)
+    run_generator(types, output_dir, header_only, codec, cpp, dispatch)
 
 # -----------------
 
@@ -113,12 +127,18 @@ def run_parser(source_dirs, search_dirs):
         die(ex)
     return types
 
-def run_generator(types, dest_dir, header_only):
+def run_generator(types, dest_dir, header_only, codec='unrolled', cpp=False, dispatch=False):
     try:
         header_template_expander = make_template_expander(HEADER_TEMPLATE_FILENAME)
         code_template_expander = make_template_expander(CODE_TEMPLATE_FILENAME)
+        cpp_template_expander = make_template_expander(CPP_TEMPLATE_FILENAME) if cpp else None
         dest_dir = os.path.abspath(dest_dir)  # Removing '..'
         makedirs(dest_dir)
+        if codec == 'table':
+            # The interpreter is shared by all types, it is copied once into the output root
+            for filename in CODEC_RUNTIME_FILENAMES:
+                with open(filename) as f:
+                    write_generated_data(os.path.join(dest_dir, os.path.basename(filename)), f.read(), header_only)
         for t in types:
             logger.info('Generating type %s', t.full_name)
             header_path_file_name = os.path.join(dest_dir, type_output_filename(t, OUTPUT_HEADER_FILE_EXTENSION))
@@ -126,6 +146,7 @@ def run_generator(types, dest_dir, header_only):
             t.header_filename = type_output_filename(t, OUTPUT_HEADER_FILE_EXTENSION)
             t.name_space_prefix = get_name_space_prefix(t)
             t.header_only = header_only
+            t.codec = codec
             header_text = generate_one_type(header_template_expander, t)
             code_text = generate_one_type(code_template_expander, t)
             write_generated_data(header_path_file_name, header_text, header_only)
@@ -134,10 +155,124 @@ def run_generator(types, dest_dir, header_only):
                 write_generated_data(header_path_file_name, code_text, header_only, True)
             else:
                 write_generated_data(code_filename, code_text, header_only)
+            if cpp:
+                cpp_header_filename = os.path.join(dest_dir, type_output_filename(t, OUTPUT_CPP_HEADER_FILE_EXTENSION))
+                cpp_text = generate_one_type(cpp_template_expander, t)
+                write_generated_data(cpp_header_filename, cpp_text, header_only)
+        if dispatch:
+            generate_dispatch(types, dest_dir, header_only)
     except Exception as ex:
         logger.info('Generator failure', exc_info=True)
         die(ex)
 
+def generate_dispatch(types, dest_dir, header_only):
+    d = make_dispatch_table(types)
+    d.header_only = header_only
+    header_text = generate_text(make_template_expander(DISPATCH_HEADER_TEMPLATE_FILENAME), d=d)
+    code_text = generate_text(make_template_expander(DISPATCH_CODE_TEMPLATE_FILENAME), d=d)
+    header_filename = os.path.join(dest_dir, DISPATCH_OUTPUT_FILENAME + '.' + OUTPUT_HEADER_FILE_EXTENSION)
+    write_generated_data(header_filename, header_text, header_only)
+    if header_only:
+        write_generated_data(header_filename, "\r\n" + code_text, header_only, True)
+    else:
+        code_filename = os.path.join(dest_dir, DISPATCH_OUTPUT_FILENAME + '.' + OUTPUT_CODE_FILE_EXTENSION)
+        write_generated_data(code_filename, code_text, header_only)
+
+class DispatchTable:
+    pass
+
+class DispatchEntry:
+    def __init__(self, t, transfer_type, transfer_type_value, suffix, max_bitlen):
+        self.type_name = get_name_space_prefix(t) + suffix
+        self.name = t.full_name
+        self.data_type_id = t.default_dtid
+        self.signature = t.get_data_type_signature()
+        self.crc_seed = compute_crc_seed(self.signature)
+        self.max_size = (max_bitlen + 7) // 8
+        self.transfer_type = transfer_type
+        self.key = (transfer_type_value << 16) | t.default_dtid
+
+def make_dispatch_table(types):
+    d = DispatchTable()
+    d.entries = []
+    d.includes = []
+    for t in types:
+        if t.default_dtid is None:
+            continue
+        d.includes.append(type_output_filename(t, OUTPUT_HEADER_FILE_EXTENSION))
+        if t.kind == t.KIND_SERVICE:
+            d.entries.append(DispatchEntry(t, 'CanardTransferTypeRequest', 1, 'Request', t.get_max_bitlen_request()))
+            d.entries.append(DispatchEntry(t, 'CanardTransferTypeResponse', 0, 'Response',
+                                           t.get_max_bitlen_response()))
+        else:
+            d.entries.append(DispatchEntry(t, 'CanardTransferTypeBroadcast', 2, '', t.get_max_bitlen()))
+    if not d.entries:
+        die('No types with a default data type ID, nothing to dispatch')
+
+    keys = [e.key for e in d.entries]
+    if len(set(keys)) != len(keys):
+        duplicates = [e.name for e in d.entries if keys.count(e.key) > 1]
+        die('Default data type ID collision: %s' % ', '.join(sorted(set(duplicates))))
+
+    d.bucket_multiplier = DISPATCH_BUCKET_MULTIPLIER
+    d.displacement_multiplier = DISPATCH_DISPLACEMENT_MULTIPLIER
+    d.slot_multiplier = DISPATCH_SLOT_MULTIPLIER
+    d.bucket_bits, d.slot_bits, d.displacements, slot_keys = compute_perfect_hash(keys)
+    d.slots = [0 if k is None else keys.index(k) + 1 for k in slot_keys]
+    d.slot_c_type = 'uint8_t' if len(d.entries) < 0xFF else 'uint16_t'
+
+    def table_lines(values, per_line):
+        return [', '.join('%dU' % v for v in values[i:i + per_line]) + ',' for i in range(0, len(values), per_line)]
+    d.displacement_lines = table_lines(d.displacements, 12)
+    d.slot_lines = table_lines(d.slots, 16)
+    return d
+
+DISPATCH_BUCKET_MULTIPLIER = 0x9E3779B1
+DISPATCH_DISPLACEMENT_MULTIPLIER = 0xC2B2AE35
+DISPATCH_SLOT_MULTIPLIER = 0x85EBCA6B
+
+def dispatch_bucket(key, bucket_bits):
+    return ((key * DISPATCH_BUCKET_MULTIPLIER) & 0xFFFFFFFF) >> (32 - bucket_bits)
+
+def dispatch_slot(key, displacement, slot_bits):
+    displaced = key ^ ((displacement * DISPATCH_DISPLACEMENT_MULTIPLIER) & 0xFFFFFFFF)
+    return ((displaced * DISPATCH_SLOT_MULTIPLIER) & 0xFFFFFFFF) >> (32 - slot_bits)
+
+def compute_perfect_hash(keys):
+    '''
+    Hash and displace: the keys are distributed into buckets by the first hash, then, starting from the largest
+    bucket, a displacement is searched for each bucket that places all of its keys into free slots with the
+    second hash. The table grows until this succeeds. Must match canardDispatchFind() in the dispatch template.
+    Returns (bucket_bits, slot_bits, displacements, slot_keys), unused slots have the key None.
+    '''
+    def place(bucket_bits, slot_bits):
+        buckets = [[] for _ in range(1 << bucket_bits)]
+        for k in keys:
+            buckets[dispatch_bucket(k, bucket_bits)].append(k)
+        displacements = [0] * len(buckets)
+        slot_keys = [None] * (1 << slot_bits)
+        for index in sorted(range(len(buckets)), key=lambda i: -len(buckets[i])):
+            bucket = buckets[index]
+            for displacement in range(0x10000):
+                slots = [dispatch_slot(k, displacement, slot_bits) for k in bucket]
+                if len(set(slots)) == len(slots) and all(slot_keys[s] is None for s in slots):
+                    break
+            else:
+                return None
+            displacements[index] = displacement
+            for k, s in zip(bucket, slots):
+                slot_keys[s] = k
+        return displacements, slot_keys
+
+    slot_bits = max(1, (len(keys) - 1).bit_length())
+    while slot_bits <= 16:
+        bucket_bits = max(1, slot_bits - 1)
+        result = place(bucket_bits, slot_bits)
+        if result:
+            return (bucket_bits, slot_bits) + result
+        slot_bits += 1
+    die('Could not compute the dispatch table hash')
+
 def write_generated_data(filename, data, header_only, append_file=False):
     dirname = os.path.dirname(filename)
     makedirs(dirname)
@@ -167,6 +302,20 @@ def get_max_size(bits, unsigned):
     else:
         return (2 ** (bits-1)) -1
 
+def compute_crc_seed(signature):
+    '''
+    Same as crcAddSignature(0xFFFF, signature) in libcanard: CRC-16-CCITT over the little-endian signature bytes.
+    '''
+    crc = 0xFFFF
+    for shift in range(0, 64, 8):
+        crc ^= ((signature >> shift) & 0xFF) << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
 def strip_name(name):
     return name.split('.')[-1]
 
@@ -285,6 +434,8 @@ def generate_one_type(template_expander, t):
         t.cpp_includes = fields_includes(t.request_fields + t.response_fields)
 
     t.cpp_namespace_components = t.full_name.split('.')[:-1]
+    t.cpp_short_name = t.full_name.split('.')[-1]
+    t.crc_seed = compute_crc_seed(t.get_data_type_signature())
     t.has_default_dtid = t.default_dtid is not None
 
     # Attribute types
@@ -313,6 +464,59 @@ def generate_one_type(template_expander, t):
                 a.name = ''
         return has_array
 
+    # Field descriptors for the table-driven codec
+    def inject_codec_info(attributes, union):
+        nested_types = []
+        for a in attributes:
+            value_type = a.type.value_type if a.type.category == t.CATEGORY_ARRAY else a.type
+            a.codec_nested = 0
+            if value_type.category == t.CATEGORY_VOID:
+                a.codec_kind = 'CANARD_CODEC_KIND_VOID'
+            elif value_type.category == t.CATEGORY_COMPOUND:
+                a.codec_kind = 'CANARD_CODEC_KIND_COMPOUND'
+                if a.cpp_type not in nested_types:
+                    nested_types.append(a.cpp_type)
+                a.codec_nested = nested_types.index(a.cpp_type)
+            elif value_type.kind == value_type.KIND_FLOAT:
+                a.codec_kind = 'CANARD_CODEC_KIND_FLOAT16' if a.bitlen == 16 else 'CANARD_CODEC_KIND_FLOAT'
+            elif value_type.kind == value_type.KIND_SIGNED_INT:
+                a.codec_kind = 'CANARD_CODEC_KIND_SIGNED'
+            else:
+                a.codec_kind = 'CANARD_CODEC_KIND_UNSIGNED'
+
+            flags = []
+            if a.type.category == t.CATEGORY_ARRAY and a.dynamic_array:
+                flags.append('CANARD_CODEC_FLAG_DYNAMIC_ARRAY')
+            if a.saturate:
+                flags.append('CANARD_CODEC_FLAG_SATURATE')
+            # Tail position: the last field of a structure, or any field of a union
+            if (a.last_item or union) and \
+               ((a.type.category == t.CATEGORY_ARRAY and a.dynamic_array and a.bitlen > 7) or
+                a.type.category == t.CATEGORY_COMPOUND):
+                flags.append('CANARD_CODEC_FLAG_TAO')
+            a.codec_flags = ' | '.join(flags) or '0'
+
+            a.codec_max_length = a.type.max_size if a.type.category == t.CATEGORY_ARRAY else 1
+            a.codec_bit_length = 0 if value_type.category == t.CATEGORY_COMPOUND else a.bitlen
+        return nested_types
+
+    # Layout properties, nested types included
+    def layout_flags(fields, union):
+        fixed_size = not union
+        has_dynamic_arrays = False
+        for a in fields:
+            field_type = a.type
+            if field_type.category == t.CATEGORY_ARRAY:
+                if field_type.mode == field_type.MODE_DYNAMIC:
+                    fixed_size = False
+                    has_dynamic_arrays = True
+                field_type = field_type.value_type
+            if field_type.category == t.CATEGORY_COMPOUND:
+                nested_fixed_size, nested_has_dynamic_arrays = layout_flags(field_type.fields, field_type.union)
+                fixed_size = fixed_size and nested_fixed_size
+                has_dynamic_arrays = has_dynamic_arrays or nested_has_dynamic_arrays
+        return fixed_size, has_dynamic_arrays
+
     def has_float16(attributes):
         has_float16 = False
         for a in attributes:
@@ -320,19 +524,32 @@ def generate_one_type(template_expander, t):
                 has_float16 = True
         return has_float16
 
+    def has_array_loop(attributes):
+        # Dynamic byte arrays are decoded with a single call, every other array is decoded in a loop
+        for a in attributes:
+            if a.type.category == t.CATEGORY_ARRAY and \
+               not (a.dynamic_array and a.cpp_type == 'uint8_t' and a.bitlen == 8):
+                return True
+        return False
+
     if t.kind == t.KIND_MESSAGE:
         t.has_array = inject_cpp_types(t.fields)
+        t.has_array_loop = has_array_loop(t.fields)
         t.has_float16 = has_float16(t.fields)
         inject_cpp_types(t.constants)
         t.all_attributes = t.fields + t.constants
         t.union = t.union and len(t.fields)
         if t.union:
             t.union = len(t.fields).bit_length()
+        t.codec_nested_types = inject_codec_info(t.fields, t.union)
+        t.fixed_size, t.has_dynamic_arrays = layout_flags(t.fields, t.union)
     else:
         t.request_has_array = inject_cpp_types(t.request_fields)
+        t.request_has_array_loop = has_array_loop(t.request_fields)
         t.request_has_float16 = has_float16(t.request_fields)
         inject_cpp_types(t.request_constants)
         t.response_has_array = inject_cpp_types(t.response_fields)
+        t.response_has_array_loop = has_array_loop(t.response_fields)
         t.response_has_float16 = has_float16(t.response_fields)
         inject_cpp_types(t.response_constants)
         t.all_attributes = t.request_fields + t.request_constants + t.response_fields + t.response_constants
@@ -342,6 +559,10 @@ def generate_one_type(template_expander, t):
             t.request_union = len(t.request_fields).bit_length()
         if t.response_union:
             t.response_union = len(t.response_fields).bit_length()
+        t.request_codec_nested_types = inject_codec_info(t.request_fields, t.request_union)
+        t.response_codec_nested_types = inject_codec_info(t.response_fields, t.response_union)
+        t.request_fixed_size, t.request_has_dynamic_arrays = layout_flags(t.request_fields, t.request_union)
+        t.response_fixed_size, t.response_has_dynamic_arrays = layout_flags(t.response_fields, t.response_union)
 
     # Constant properties
     def inject_constant_info(constants):
@@ -367,8 +588,10 @@ def generate_one_type(template_expander, t):
         t.KIND_SERVICE: '::uavcan::DataTypeKindService',
     }[t.kind]
 
-    # Generation
-    text = template_expander(t=t)  # t for Type
+    return generate_text(template_expander, t=t)  # t for Type
+
+def generate_text(template_expander, **args):
+    text = template_expander(**args)
     text = '\n'.join(x.rstrip() for x in text.splitlines())
     text = text.replace('\n\n\n\n\n', '\n\n').replace('\n\n\n\n', '\n\n').replace('\n\n\n', '\n\n')
     text = text.replace('{\n\n ', '{\n ')
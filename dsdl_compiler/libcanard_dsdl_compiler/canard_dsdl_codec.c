@@ -0,0 +1,466 @@
+/*
+ * UAVCAN table-driven codec for libcanard.
+ *
+ * Autogenerated, do not edit.
+ *
+ * This file is emitted by libcanard_dsdlc when the option --codec=table is used.
+ * It is shared by all generated data types; add it to the build once.
+ */
+
+#include "canard_dsdl_codec.h"
+#include <string.h>
+
+#ifndef CANARD_DSDL_ZERO_COPY
+#define CANARD_DSDL_ZERO_COPY false
+#endif
+
+/// Offset of the data pointer within the dynamic array structure {len; data*}, same for 8 and 16 bit lengths.
+#define DYNAMIC_ARRAY_DATA_OFFSET   (offsetof(struct { uint16_t len; void* data; }, data))
+
+typedef union
+{
+    bool     boolean;
+    uint8_t  u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+    int8_t   s8;
+    int16_t  s16;
+    int32_t  s32;
+    int64_t  s64;
+} ScalarStorage;
+
+static uint8_t getLengthPrefixBitLength(uint16_t max_length)
+{
+    uint8_t out = 0;
+    while ((max_length >> out) != 0U)
+    {
+        out++;
+    }
+    return out;
+}
+
+static uint16_t getElementBitLength(const CanardCodecType* type, const CanardCodecField* field)
+{
+    if (field->kind == CANARD_CODEC_KIND_COMPOUND)
+    {
+        return type->nested_types[field->nested]->max_bit_length;
+    }
+    return field->bit_length;
+}
+
+static uint16_t readDynamicArrayLength(const uint8_t* ptr, uint16_t max_length)
+{
+    if (max_length > 255U)
+    {
+        uint16_t len = 0;
+        memcpy(&len, ptr, sizeof(len));
+        return len;
+    }
+    return *ptr;
+}
+
+static void writeDynamicArrayLength(uint8_t* ptr, uint16_t max_length, uint16_t len)
+{
+    if (max_length > 255U)
+    {
+        memcpy(ptr, &len, sizeof(len));
+    }
+    else
+    {
+        *ptr = (uint8_t)len;
+    }
+}
+
+/**
+ * Applies the same saturation rules as the unrolled generated code.
+ */
+static void saturate(const CanardCodecField* field, const void* value, ScalarStorage* out)
+{
+    memcpy(out, value, field->element_size);
+    if (field->kind == CANARD_CODEC_KIND_SIGNED)
+    {
+        const int64_t max = (int64_t)((1ULL << (field->bit_length - 1U)) - 1U);
+        int64_t x = 0;
+        if      (field->element_size == 1U) { x = out->s8;  }
+        else if (field->element_size == 2U) { x = out->s16; }
+        else if (field->element_size == 4U) { x = out->s32; }
+        else                                { x = out->s64; }
+
+        x = (x > max) ? max : ((-x > max) ? -max : x);
+
+        if      (field->element_size == 1U) { out->s8  = (int8_t)x;  }
+        else if (field->element_size == 2U) { out->s16 = (int16_t)x; }
+        else if (field->element_size == 4U) { out->s32 = (int32_t)x; }
+        else                                { out->s64 = x;           }
+    }
+    else
+    {
+        const uint64_t max = (1ULL << field->bit_length) - 1U;
+        uint64_t x = 0;
+        if      (field->element_size == 1U) { x = out->u8;  }
+        else if (field->element_size == 2U) { x = out->u16; }
+        else if (field->element_size == 4U) { x = out->u32; }
+        else                                { x = out->u64; }
+
+        x = (x >= max) ? max : x;
+
+        if      (field->element_size == 1U) { out->u8  = (uint8_t)x;  }
+        else if (field->element_size == 2U) { out->u16 = (uint16_t)x; }
+        else if (field->element_size == 4U) { out->u32 = (uint32_t)x; }
+        else                                { out->u64 = x;            }
+    }
+}
+
+static uint32_t encodeType(const CanardCodecType* type,
+                           const uint8_t* source,
+                           void* msg_buf,
+                           uint32_t offset,
+                           bool root_item,
+                           bool tao_enabled);
+
+static uint32_t encodeElement(const CanardCodecType* type,
+                              const CanardCodecField* field,
+                              const uint8_t* element,
+                              void* msg_buf,
+                              uint32_t offset,
+                              bool tail_item,
+                              bool tao_enabled)
+{
+    if (field->kind == CANARD_CODEC_KIND_COMPOUND)
+    {
+        return encodeType(type->nested_types[field->nested], element, msg_buf, offset, tail_item, tao_enabled);
+    }
+
+    if (field->kind == CANARD_CODEC_KIND_FLOAT16)
+    {
+        float value = 0.0F;
+        memcpy(&value, element, sizeof(value));
+#ifndef CANARD_USE_FLOAT16_CAST
+        const uint16_t tmp_float = canardConvertNativeFloatToFloat16(value);
+#else
+        const CANARD_USE_FLOAT16_CAST tmp_float = (CANARD_USE_FLOAT16_CAST)value;
+#endif
+        canardEncodeScalar(msg_buf, offset, 16, &tmp_float);
+    }
+    else if ((field->flags & CANARD_CODEC_FLAG_SATURATE) != 0U)
+    {
+        ScalarStorage storage;
+        saturate(field, element, &storage);
+        canardEncodeScalar(msg_buf, offset, field->bit_length, &storage);
+    }
+    else
+    {
+        canardEncodeScalar(msg_buf, offset, field->bit_length, element);
+    }
+    return offset + field->bit_length;
+}
+
+static uint32_t encodeType(const CanardCodecType* type,
+                           const uint8_t* source,
+                           void* msg_buf,
+                           uint32_t offset,
+                           bool root_item,
+                           bool tao_enabled)
+{
+    uint8_t first = 0;
+    uint8_t last = type->num_fields;
+
+    if (type->union_tag_bit_length > 0U)
+    {
+        // The union tag is the first member of the structure
+        uint32_t tag = 0;
+        if      (type->union_tag_size == 1U) { tag = *source; }
+        else if (type->union_tag_size == 2U) { uint16_t x = 0; memcpy(&x, source, 2); tag = x; }
+        else                                 { memcpy(&tag, source, 4); }
+        CANARD_ASSERT(tag < type->num_fields);
+
+        const uint8_t tag_u8 = (uint8_t)tag;
+        canardEncodeScalar(msg_buf, offset, type->union_tag_bit_length, &tag_u8);
+        offset += type->union_tag_bit_length;
+        first = tag_u8;
+        last = (uint8_t)(tag_u8 + 1U);
+    }
+
+    for (uint8_t i = first; i < last; i++)
+    {
+        const CanardCodecField* const field = &type->fields[i];
+        if (field->kind == CANARD_CODEC_KIND_VOID)
+        {
+            offset += field->bit_length;
+            continue;
+        }
+
+        const uint8_t* data = source + field->offset;
+        uint16_t len = field->max_length;
+
+        if ((field->flags & CANARD_CODEC_FLAG_DYNAMIC_ARRAY) != 0U)
+        {
+            len = readDynamicArrayLength(data, field->max_length);
+            if (!root_item || !tao_enabled || ((field->flags & CANARD_CODEC_FLAG_TAO) == 0U))
+            {
+                const uint8_t prefix_bit_length = getLengthPrefixBitLength(field->max_length);
+                if (prefix_bit_length <= 8U)
+                {
+                    const uint8_t len_u8 = (uint8_t)len;
+                    canardEncodeScalar(msg_buf, offset, prefix_bit_length, &len_u8);
+                }
+                else
+                {
+                    canardEncodeScalar(msg_buf, offset, prefix_bit_length, &len);
+                }
+                offset += prefix_bit_length;
+            }
+            memcpy(&data, data + DYNAMIC_ARRAY_DATA_OFFSET, sizeof(data));
+        }
+
+        // A nested compound in the tail position inherits the tail array optimization of the enclosing type
+        const bool tail_item = root_item && ((field->flags & CANARD_CODEC_FLAG_TAO) != 0U) &&
+                               ((field->flags & CANARD_CODEC_FLAG_DYNAMIC_ARRAY) == 0U);
+        for (uint16_t c = 0; c < len; c++)
+        {
+            offset = encodeElement(type, field, data + (size_t)c * field->element_size, msg_buf, offset,
+                                   tail_item, tao_enabled);
+        }
+    }
+
+    return offset;
+}
+
+/**
+ * State shared by all nesting levels of one decoding call.
+ */
+typedef struct
+{
+    const CanardRxTransfer* transfer;
+    uint8_t** dyn_arr_buf;
+    const uint8_t* dyn_arr_buf_end;
+    bool tao_enabled;
+} DecodeContext;
+
+/**
+ * If 'dest' is NULL, the data is validated and skipped.
+ */
+static int32_t decodeType(const DecodeContext* ctx,
+                          const CanardCodecType* type,
+                          uint16_t payload_len,
+                          uint8_t* dest,
+                          int32_t offset);
+
+static int32_t decodeElement(const DecodeContext* ctx,
+                             const CanardCodecType* type,
+                             const CanardCodecField* field,
+                             uint16_t payload_len,
+                             uint8_t* element,
+                             int32_t offset)
+{
+    if (field->kind == CANARD_CODEC_KIND_COMPOUND)
+    {
+        return decodeType(ctx, type->nested_types[field->nested], payload_len, element, offset);
+    }
+
+    ScalarStorage scratch;
+    int16_t ret = 0;
+    if (field->kind == CANARD_CODEC_KIND_FLOAT16)
+    {
+#ifndef CANARD_USE_FLOAT16_CAST
+        uint16_t tmp_float = 0;
+#else
+        CANARD_USE_FLOAT16_CAST tmp_float = 0;
+#endif
+        ret = canardDecodeScalar(ctx->transfer, (uint32_t)offset, 16, false, &tmp_float);
+        if (element != NULL)
+        {
+#ifndef CANARD_USE_FLOAT16_CAST
+            const float value = canardConvertFloat16ToNativeFloat(tmp_float);
+#else
+            const float value = (float)tmp_float;
+#endif
+            memcpy(element, &value, sizeof(value));
+        }
+    }
+    else
+    {
+        ret = canardDecodeScalar(ctx->transfer, (uint32_t)offset, field->bit_length,
+                                 field->kind == CANARD_CODEC_KIND_SIGNED,
+                                 (element != NULL) ? (void*)element : (void*)&scratch);
+    }
+
+    if (ret != (int16_t)field->bit_length)
+    {
+        return (ret < 0) ? ret : -CANARD_ERROR_INTERNAL;
+    }
+    return offset + field->bit_length;
+}
+
+static int32_t decodeType(const DecodeContext* ctx,
+                          const CanardCodecType* type,
+                          uint16_t payload_len,
+                          uint8_t* dest,
+                          int32_t offset)
+{
+    uint8_t first = 0;
+    uint8_t last = type->num_fields;
+
+    if (type->union_tag_bit_length > 0U)
+    {
+        uint8_t tag = 0;
+        const int16_t ret = canardDecodeScalar(ctx->transfer, (uint32_t)offset, type->union_tag_bit_length, false, &tag);
+        if (ret != (int16_t)type->union_tag_bit_length)
+        {
+            return (ret < 0) ? ret : -CANARD_ERROR_INTERNAL;
+        }
+        if (tag >= type->num_fields)
+        {
+            return -CANARD_ERROR_INTERNAL;
+        }
+        if (dest != NULL)
+        {
+            const uint32_t tag_u32 = tag;
+            const uint16_t tag_u16 = tag;
+            if      (type->union_tag_size == 1U) { *dest = tag; }
+            else if (type->union_tag_size == 2U) { memcpy(dest, &tag_u16, 2); }
+            else                                 { memcpy(dest, &tag_u32, 4); }
+        }
+        offset += type->union_tag_bit_length;
+        first = tag;
+        last = (uint8_t)(tag + 1U);
+    }
+
+    for (uint8_t i = first; i < last; i++)
+    {
+        const CanardCodecField* const field = &type->fields[i];
+        if (field->kind == CANARD_CODEC_KIND_VOID)
+        {
+            offset += field->bit_length;
+            continue;
+        }
+
+        uint8_t* data = (dest != NULL) ? (dest + field->offset) : NULL;
+        uint16_t len = field->max_length;
+
+        if ((field->flags & CANARD_CODEC_FLAG_DYNAMIC_ARRAY) != 0U)
+        {
+            const uint16_t element_bit_length = getElementBitLength(type, field);
+            if ((payload_len > 0U) && ctx->tao_enabled && ((field->flags & CANARD_CODEC_FLAG_TAO) != 0U))
+            {
+                // Tail array optimization - the length is derived from the payload length
+                if ((int32_t)payload_len * 8 < offset)
+                {
+                    return -CANARD_ERROR_INTERNAL;
+                }
+                len = (uint16_t)((((int32_t)payload_len * 8) - offset) / element_bit_length);
+            }
+            else
+            {
+                const uint8_t prefix_bit_length = getLengthPrefixBitLength(field->max_length);
+                int16_t ret = 0;
+                if (prefix_bit_length <= 8U)
+                {
+                    uint8_t len_u8 = 0;
+                    ret = canardDecodeScalar(ctx->transfer, (uint32_t)offset, prefix_bit_length, false, &len_u8);
+                    len = len_u8;
+                }
+                else
+                {
+                    ret = canardDecodeScalar(ctx->transfer, (uint32_t)offset, prefix_bit_length, false, &len);
+                }
+                if (ret != (int16_t)prefix_bit_length)
+                {
+                    return (ret < 0) ? ret : -CANARD_ERROR_INTERNAL;
+                }
+                offset += prefix_bit_length;
+            }
+
+            if (len > field->max_length)
+            {
+                return -CANARD_ERROR_INTERNAL;
+            }
+
+            if ((data == NULL) || (ctx->dyn_arr_buf == NULL))
+            {
+                if (data != NULL)
+                {
+                    writeDynamicArrayLength(data, field->max_length, len);
+                }
+                if (field->kind != CANARD_CODEC_KIND_COMPOUND)
+                {
+                    offset += (int32_t)len * field->bit_length;     // Dynamic arrays are ignored if there's no storage
+                    continue;
+                }
+                data = NULL;                                        // Compound items are validated and skipped
+            }
+            else
+            {
+                writeDynamicArrayLength(data, field->max_length, len);
+                uint8_t* storage = *ctx->dyn_arr_buf;
+
+                if ((field->kind == CANARD_CODEC_KIND_UNSIGNED) && (field->bit_length == 8U))
+                {
+                    // Byte arrays are viewed in place or copied as a whole
+                    const int32_t ret = canardDecodeByteArray(ctx->transfer, (uint32_t)offset, len, CANARD_DSDL_ZERO_COPY,
+                                                              &storage, ctx->dyn_arr_buf, ctx->dyn_arr_buf_end);
+                    if (ret < 0)
+                    {
+                        return ret;
+                    }
+                    memcpy(data + DYNAMIC_ARRAY_DATA_OFFSET, &storage, sizeof(storage));
+                    offset += ret;
+                    continue;
+                }
+
+                const size_t size = (size_t)len * field->element_size;
+                if ((ctx->dyn_arr_buf_end != NULL) && ((size_t)(ctx->dyn_arr_buf_end - storage) < size))
+                {
+                    return -CANARD_ERROR_OUT_OF_MEMORY;
+                }
+                memcpy(data + DYNAMIC_ARRAY_DATA_OFFSET, &storage, sizeof(storage));
+                *ctx->dyn_arr_buf += size;
+                data = storage;
+            }
+        }
+
+        // Only a nested compound in the tail position receives the payload length, see encodeType()
+        const uint16_t nested_payload_len = (((field->flags & CANARD_CODEC_FLAG_TAO) != 0U) &&
+                                             ((field->flags & CANARD_CODEC_FLAG_DYNAMIC_ARRAY) == 0U)) ? payload_len : 0U;
+        for (uint16_t c = 0; c < len; c++)
+        {
+            uint8_t* const element = (data != NULL) ? (data + (size_t)c * field->element_size) : NULL;
+            offset = decodeElement(ctx, type, field, nested_payload_len, element, offset);
+            if (offset < 0)
+            {
+                return offset;
+            }
+        }
+    }
+
+    return offset;
+}
+
+uint32_t canardCodecEncode(const CanardCodecType* type,
+                           const void* source,
+                           void* msg_buf,
+                           uint32_t offset,
+                           bool tao_enabled)
+{
+    CANARD_ASSERT(type != NULL);
+    CANARD_ASSERT(source != NULL);
+    CANARD_ASSERT(msg_buf != NULL);
+    return encodeType(type, (const uint8_t*)source, msg_buf, offset, true, tao_enabled);
+}
+
+int32_t canardCodecDecode(const CanardCodecType* type,
+                          const CanardRxTransfer* transfer,
+                          uint16_t payload_len,
+                          void* dest,
+                          uint8_t** dyn_arr_buf,
+                          const uint8_t* dyn_arr_buf_end,
+                          int32_t offset,
+                          bool tao_enabled)
+{
+    CANARD_ASSERT(type != NULL);
+    CANARD_ASSERT(transfer != NULL);
+    CANARD_ASSERT(dest != NULL);
+    const DecodeContext ctx = { transfer, dyn_arr_buf, dyn_arr_buf_end, tao_enabled };
+    return decodeType(&ctx, type, payload_len, (uint8_t*)dest, offset);
+}
@@ -0,0 +1,99 @@
+/*
+ * UAVCAN table-driven codec for libcanard.
+ *
+ * Autogenerated, do not edit.
+ *
+ * This file is emitted by libcanard_dsdlc when the option --codec=table is used.
+ * Instead of generating dedicated encoding/decoding functions for every data type, the compiler emits
+ * a compact field descriptor table per type, which is interpreted at run time by the functions declared below.
+ */
+
+#ifndef CANARD_DSDL_CODEC_H
+#define CANARD_DSDL_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "canard.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Field kinds, see CanardCodecField.kind.
+ */
+#define CANARD_CODEC_KIND_VOID                  0U      ///< Padding, not stored in the C structure
+#define CANARD_CODEC_KIND_UNSIGNED              1U      ///< Unsigned integer or boolean
+#define CANARD_CODEC_KIND_SIGNED                2U      ///< Signed integer
+#define CANARD_CODEC_KIND_FLOAT                 3U      ///< float32 or float64, stored natively
+#define CANARD_CODEC_KIND_FLOAT16               4U      ///< float16, stored as native float
+#define CANARD_CODEC_KIND_COMPOUND              5U      ///< Nested data type
+
+/**
+ * Field flags, see CanardCodecField.flags.
+ */
+#define CANARD_CODEC_FLAG_DYNAMIC_ARRAY         1U      ///< Stored as {len, data*}, encoded with a length prefix
+#define CANARD_CODEC_FLAG_SATURATE              2U      ///< Saturate the value to its bit length when encoding
+#define CANARD_CODEC_FLAG_TAO                   4U      ///< Tail array optimization applies to this field
+
+/**
+ * Describes one field of a data type.
+ * Static arrays and plain scalars are both described as max_length consecutive elements stored in place.
+ */
+typedef struct
+{
+    uint16_t offset;            ///< Offset of the field within the C structure
+    uint16_t element_size;      ///< sizeof() of one element in the C structure
+    uint16_t max_length;        ///< Array capacity; 1 for scalar fields
+    uint8_t kind;               ///< See CANARD_CODEC_KIND_*
+    uint8_t bit_length;         ///< Encoded length of one element, in bits; unused for compound elements
+    uint8_t flags;              ///< See CANARD_CODEC_FLAG_*
+    uint8_t nested;             ///< Index in CanardCodecType.nested_types for compound elements
+} CanardCodecField;
+
+/**
+ * Describes one data type (a message, a service request, or a service response).
+ */
+typedef struct CanardCodecType
+{
+    const CanardCodecField* fields;
+    const struct CanardCodecType* const* nested_types;
+    uint16_t max_bit_length;    ///< Maximum encoded length of the type, in bits
+    uint8_t num_fields;
+    uint8_t union_tag_bit_length;   ///< Zero if the type is not a union
+    uint8_t union_tag_size;     ///< sizeof() of the union tag in the C structure
+} CanardCodecType;
+
+/**
+ * Encodes the structure pointed to by 'source' into 'msg_buf' starting at the specified bit offset.
+ * Returns the bit offset past the last encoded bit.
+ */
+uint32_t canardCodecEncode(const CanardCodecType* type,
+                           const void* source,
+                           void* msg_buf,
+                           uint32_t offset,
+                           bool tao_enabled);
+
+/**
+ * Decodes the transfer into the structure pointed to by 'dest' starting at the specified bit offset.
+ * Dynamic arrays are stored into the memory pointed to by dyn_arr_buf, which is advanced accordingly;
+ * if dyn_arr_buf is NULL, dynamic arrays are skipped. If dyn_arr_buf_end is not NULL, decoding fails with
+ * CANARD_ERROR_OUT_OF_MEMORY rather than writing past it.
+ * Byte arrays are decoded with canardDecodeByteArray(), see CANARD_DSDL_ZERO_COPY.
+ * Returns the bit offset past the last decoded bit, or a negative error code.
+ */
+int32_t canardCodecDecode(const CanardCodecType* type,
+                          const CanardRxTransfer* transfer,
+                          uint16_t payload_len,
+                          void* dest,
+                          uint8_t** dyn_arr_buf,
+                          const uint8_t* dyn_arr_buf_end,
+                          int32_t offset,
+                          bool tao_enabled);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // CANARD_DSDL_CODEC_H
@@ -0,0 +1,240 @@
+/*
+ * Memory allocator benchmark under multi-instance load: the built-in pool vs. custom allocators.
+ * Every thread runs its own pair of instances and passes multi-frame transfers from one to the other, so that the
+ * allocator serves TX items, RX states and RX buffer blocks. The custom allocators are a plain malloc()/free() and
+ * a thread-cached allocator that keeps the freed blocks in a per-thread free list and only calls malloc() to grow it.
+ * Build with -DCANARD_ENABLE_CUSTOM_ALLOCATOR=1.
+ *
+ * Usage: bench_allocators [max number of threads, default 8]
+ *
+ * This benchmark is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include <canard.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+
+#if !CANARD_ENABLE_CUSTOM_ALLOCATOR
+# error "This benchmark needs CANARD_ENABLE_CUSTOM_ALLOCATOR"
+#endif
+
+#define NUM_TRANSFERS               400000U         ///< Split among the threads
+#define MAX_THREADS                 8U
+#define PAYLOAD_LEN                 60U
+#define DATA_TYPE_ID                1000U
+#define DATA_TYPE_SIGNATURE         0x0123456789ABCDEFULL
+#define MEMORY_POOL_SIZE            16384U
+
+typedef enum
+{
+    ModePool,
+    ModeMalloc,
+    ModeThreadCache
+} Mode;
+
+static const char* const ModeNames[] = { "pool", "malloc", "cached" };
+
+typedef union ThreadCacheBlock_u
+{
+    uint8_t bytes[CANARD_MEM_BLOCK_SIZE];
+    union ThreadCacheBlock_u* next;
+} ThreadCacheBlock;
+
+typedef struct
+{
+    Mode mode;
+    uint32_t num_transfers;
+    uint32_t num_received;
+    uint64_t pool_tx[MEMORY_POOL_SIZE / 8U];
+    uint64_t pool_rx[MEMORY_POOL_SIZE / 8U];
+} Worker;
+
+static __thread ThreadCacheBlock* g_thread_cache;
+
+
+static uint64_t getMonotonicTimestampUSec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    {
+        abort();
+    }
+    return (uint64_t)(ts.tv_sec * 1000000LL + ts.tv_nsec / 1000LL);
+}
+
+static void* mallocAllocate(CanardMemoryAllocator* self, size_t size)
+{
+    (void)self;
+    return malloc(size);
+}
+
+static void mallocDeallocate(CanardMemoryAllocator* self, void* pointer)
+{
+    (void)self;
+    free(pointer);
+}
+
+static void* cachedAllocate(CanardMemoryAllocator* self, size_t size)
+{
+    (void)self;
+    (void)size;
+    ThreadCacheBlock* const block = g_thread_cache;
+    if (block == NULL)
+    {
+        return malloc(sizeof(ThreadCacheBlock));
+    }
+    g_thread_cache = block->next;
+    return block;
+}
+
+static void cachedDeallocate(CanardMemoryAllocator* self, void* pointer)
+{
+    (void)self;
+    ThreadCacheBlock* const block = (ThreadCacheBlock*)pointer;
+    block->next = g_thread_cache;
+    g_thread_cache = block;
+}
+
+static void releaseThreadCache(void)
+{
+    while (g_thread_cache != NULL)
+    {
+        ThreadCacheBlock* const next = g_thread_cache->next;
+        free(g_thread_cache);
+        g_thread_cache = next;
+    }
+}
+
+static CanardMemoryAllocator g_malloc_allocator = { mallocAllocate, mallocDeallocate };
+static CanardMemoryAllocator g_cached_allocator = { cachedAllocate, cachedDeallocate };
+
+static bool shouldAcceptTransfer(const CanardInstance* ins,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t source_node_id)
+{
+    (void)ins;
+    (void)transfer_type;
+    (void)source_node_id;
+    *out_data_type_signature = DATA_TYPE_SIGNATURE;
+    return data_type_id == DATA_TYPE_ID;
+}
+
+static void onTransferReceived(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    (void)transfer;
+    ((Worker*)canardGetUserReference(ins))->num_received++;
+}
+
+static void initInstance(Worker* worker, CanardInstance* ins, uint64_t* pool, uint8_t node_id)
+{
+    canardInit(ins, pool, MEMORY_POOL_SIZE, onTransferReceived, shouldAcceptTransfer, worker);
+    if (worker->mode != ModePool)
+    {
+        const int16_t res = canardSetMemoryAllocator(ins, (worker->mode == ModeMalloc) ? &g_malloc_allocator :
+                                                                                         &g_cached_allocator);
+        if (res < 0)
+        {
+            fprintf(stderr, "Failed to set the allocator: %d\n", res);
+            exit(1);
+        }
+    }
+    canardSetLocalNodeID(ins, node_id);
+}
+
+static void* workerThread(void* arg)
+{
+    Worker* const worker = (Worker*)arg;
+    CanardInstance tx;
+    CanardInstance rx;
+    initInstance(worker, &tx, worker->pool_tx, 10);
+    initInstance(worker, &rx, worker->pool_rx, 20);
+
+    uint8_t payload[PAYLOAD_LEN];
+    uint8_t transfer_id = 0;
+    uint64_t timestamp_usec = 1000;
+    for (uint32_t i = 0; i < worker->num_transfers; i++)
+    {
+        memset(payload, (int)(i & 0xFFU), sizeof(payload));
+        const int16_t res = canardBroadcast(&tx, DATA_TYPE_SIGNATURE, DATA_TYPE_ID, &transfer_id,
+                                            CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload));
+        if (res <= 0)
+        {
+            fprintf(stderr, "Broadcast failed: %d\n", res);
+            exit(1);
+        }
+        for (const CanardCANFrame* frame = canardPeekTxQueue(&tx); frame != NULL; frame = canardPeekTxQueue(&tx))
+        {
+            (void)canardHandleRxFrame(&rx, frame, timestamp_usec++);
+            canardPopTxQueue(&tx);
+        }
+    }
+
+    canardCleanupStaleTransfers(&rx, UINT64_MAX / 2U);
+    releaseThreadCache();
+    return NULL;
+}
+
+static void run(Mode mode, unsigned num_threads)
+{
+    static Worker workers[MAX_THREADS];
+    memset(workers, 0, sizeof(workers));
+
+    const uint64_t started_at = getMonotonicTimestampUSec();
+    pthread_t threads[MAX_THREADS];
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        workers[i].mode = mode;
+        workers[i].num_transfers = NUM_TRANSFERS / num_threads;
+        if (pthread_create(&threads[i], NULL, workerThread, &workers[i]) != 0)
+        {
+            fprintf(stderr, "Failed to start a thread\n");
+            exit(1);
+        }
+    }
+    uint64_t num_received = 0;
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+        num_received += workers[i].num_received;
+    }
+    const double elapsed_sec = (double)(getMonotonicTimestampUSec() - started_at) * 1e-6;
+
+    const uint64_t expected = (uint64_t)(NUM_TRANSFERS / num_threads) * num_threads;
+    if (num_received != expected)
+    {
+        fprintf(stderr, "Received %llu transfers instead of %llu\n",
+                (unsigned long long)num_received, (unsigned long long)expected);
+        exit(1);
+    }
+    printf("%-7s %u threads %12.0f transfers/s\n", ModeNames[mode], num_threads, (double)num_received / elapsed_sec);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned max_threads = (argc > 1) ? (unsigned)atoi(argv[1]) : MAX_THREADS;
+    if ((max_threads < 1U) || (max_threads > MAX_THREADS))
+    {
+        fprintf(stderr, "The number of threads must be from 1 to %u\n", MAX_THREADS);
+        return 1;
+    }
+
+    for (unsigned n = 1; n <= max_threads; n *= 2U)
+    {
+        run(ModePool, n);
+        run(ModeMalloc, n);
+        run(ModeThreadCache, n);
+    }
+    return 0;
+}
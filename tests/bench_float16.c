@@ -0,0 +1,86 @@
+/*
+ * Float16 conversion benchmark: scalar functions vs. the array functions.
+ * Build with e.g. -O2 -mf16c to compare with hardware conversion, or -DCANARD_ENABLE_FLOAT16_LUT=1.
+ *
+ * This benchmark is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include <canard.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+
+#define NUM_VALUES                  4096U
+#define NUM_ROUNDS                  2000U
+
+static float g_floats[NUM_VALUES];
+static uint16_t g_halfs[NUM_VALUES];
+
+
+static uint64_t getMonotonicTimestampNSec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    {
+        abort();
+    }
+    return (uint64_t)(ts.tv_sec * 1000000000LL + ts.tv_nsec);
+}
+
+static void report(const char* name, uint64_t started_at)
+{
+    const double elapsed_ns = (double)(getMonotonicTimestampNSec() - started_at);
+    printf("%-28s %8.3f elements/ns\n", name, ((double)NUM_VALUES * NUM_ROUNDS) / elapsed_ns);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < NUM_VALUES; i++)
+    {
+        g_floats[i] = ((float)i - (float)(NUM_VALUES / 2U)) * 0.37F;
+    }
+
+    uint64_t started_at = getMonotonicTimestampNSec();
+    for (uint32_t round = 0; round < NUM_ROUNDS; round++)
+    {
+        for (uint32_t i = 0; i < NUM_VALUES; i++)
+        {
+            g_halfs[i] = canardConvertNativeFloatToFloat16(g_floats[i]);
+        }
+    }
+    report("float -> float16, scalar", started_at);
+
+    started_at = getMonotonicTimestampNSec();
+    for (uint32_t round = 0; round < NUM_ROUNDS; round++)
+    {
+        canardConvertNativeFloatArrayToFloat16(g_floats, g_halfs, NUM_VALUES);
+    }
+    report("float -> float16, array", started_at);
+
+    started_at = getMonotonicTimestampNSec();
+    for (uint32_t round = 0; round < NUM_ROUNDS; round++)
+    {
+        for (uint32_t i = 0; i < NUM_VALUES; i++)
+        {
+            g_floats[i] = canardConvertFloat16ToNativeFloat(g_halfs[i]);
+        }
+    }
+    report("float16 -> float, scalar", started_at);
+
+    started_at = getMonotonicTimestampNSec();
+    for (uint32_t round = 0; round < NUM_ROUNDS; round++)
+    {
+        canardConvertFloat16ArrayToNativeFloat(g_halfs, g_floats, NUM_VALUES);
+    }
+    report("float16 -> float, array", started_at);
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+/*
+ * Allocation throughput benchmark with 1 to 8 threads: a mutex-protected pool vs. the lock-free shared pool, used
+ * directly and through a CanardSharedPoolContext per thread. Every thread allocates a burst of blocks and frees
+ * them again, as a library instance does with the frames of a transfer. The mutex-protected pool is the same free
+ * list as the built-in pool, with a global mutex around it.
+ * Build with -DCANARD_ENABLE_LOCK_FREE_POOL=1.
+ *
+ * Usage: bench_lock_free_pool [max number of threads, default 8]
+ *
+ * This benchmark is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include <canard.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+
+#if !CANARD_ENABLE_LOCK_FREE_POOL
+# error "This benchmark needs CANARD_ENABLE_LOCK_FREE_POOL"
+#endif
+
+#define NUM_ALLOCATIONS             8000000U        ///< Split among the threads
+#define MAX_THREADS                 8U
+#define BURST_SIZE                  6U
+#define NUM_POOL_BLOCKS             1024U
+
+typedef enum
+{
+    ModeMutex,
+    ModeLockFree,
+    ModeContext
+} Mode;
+
+static const char* const ModeNames[] = { "mutex", "lock-free", "context" };
+
+typedef union MutexPoolBlock_u
+{
+    uint8_t bytes[CANARD_MEM_BLOCK_SIZE];
+    union MutexPoolBlock_u* next;
+} MutexPoolBlock;
+
+typedef struct
+{
+    CanardMemoryAllocator base;
+    pthread_mutex_t mutex;
+    MutexPoolBlock* free_list;
+} MutexPool;
+
+typedef struct
+{
+    Mode mode;
+    uint32_t num_bursts;
+    uint64_t num_failures;
+} Worker;
+
+static MutexPoolBlock g_arena[NUM_POOL_BLOCKS];
+static MutexPool g_mutex_pool;
+static CanardSharedPool g_shared_pool;
+
+
+static uint64_t getMonotonicTimestampUSec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    {
+        abort();
+    }
+    return (uint64_t)(ts.tv_sec * 1000000LL + ts.tv_nsec / 1000LL);
+}
+
+static void* mutexPoolAllocate(CanardMemoryAllocator* self, size_t size)
+{
+    MutexPool* const pool = (MutexPool*)(void*)self;
+    (void)size;
+    (void)pthread_mutex_lock(&pool->mutex);
+    MutexPoolBlock* const block = pool->free_list;
+    if (block != NULL)
+    {
+        pool->free_list = block->next;
+    }
+    (void)pthread_mutex_unlock(&pool->mutex);
+    return block;
+}
+
+static void mutexPoolDeallocate(CanardMemoryAllocator* self, void* pointer)
+{
+    MutexPool* const pool = (MutexPool*)(void*)self;
+    MutexPoolBlock* const block = (MutexPoolBlock*)pointer;
+    (void)pthread_mutex_lock(&pool->mutex);
+    block->next = pool->free_list;
+    pool->free_list = block;
+    (void)pthread_mutex_unlock(&pool->mutex);
+}
+
+static void initMutexPool(void)
+{
+    g_mutex_pool.base.allocate = mutexPoolAllocate;
+    g_mutex_pool.base.deallocate = mutexPoolDeallocate;
+    (void)pthread_mutex_init(&g_mutex_pool.mutex, NULL);
+    g_mutex_pool.free_list = NULL;
+    for (size_t i = 0; i < NUM_POOL_BLOCKS; i++)
+    {
+        g_arena[i].next = g_mutex_pool.free_list;
+        g_mutex_pool.free_list = &g_arena[i];
+    }
+}
+
+static void* workerThread(void* arg)
+{
+    Worker* const worker = (Worker*)arg;
+    CanardSharedPoolContext context;
+    canardInitSharedPoolContext(&context, &g_shared_pool);
+
+    CanardMemoryAllocator* allocator = &g_mutex_pool.base;
+    if (worker->mode == ModeLockFree)
+    {
+        allocator = &g_shared_pool.base;
+    }
+    else if (worker->mode == ModeContext)
+    {
+        allocator = &context.base;
+    }
+
+    void* blocks[BURST_SIZE];
+    for (uint32_t i = 0; i < worker->num_bursts; i++)
+    {
+        for (size_t k = 0; k < BURST_SIZE; k++)
+        {
+            blocks[k] = allocator->allocate(allocator, CANARD_MEM_BLOCK_SIZE);
+            if (blocks[k] == NULL)
+            {
+                worker->num_failures++;
+            }
+            else
+            {
+                *(uint8_t*)blocks[k] = (uint8_t)i;
+            }
+        }
+        for (size_t k = 0; k < BURST_SIZE; k++)
+        {
+            if (blocks[k] != NULL)
+            {
+                allocator->deallocate(allocator, blocks[k]);
+            }
+        }
+    }
+
+    canardFlushSharedPoolContext(&context);
+    return NULL;
+}
+
+static void run(Mode mode, unsigned num_threads)
+{
+    static Worker workers[MAX_THREADS];
+    memset(workers, 0, sizeof(workers));
+    if (mode == ModeMutex)
+    {
+        initMutexPool();
+    }
+    else
+    {
+        canardInitSharedPool(&g_shared_pool, g_arena, sizeof(g_arena));
+    }
+
+    const uint64_t started_at = getMonotonicTimestampUSec();
+    pthread_t threads[MAX_THREADS];
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        workers[i].mode = mode;
+        workers[i].num_bursts = NUM_ALLOCATIONS / BURST_SIZE / num_threads;
+        if (pthread_create(&threads[i], NULL, workerThread, &workers[i]) != 0)
+        {
+            fprintf(stderr, "Failed to start a thread\n");
+            exit(1);
+        }
+    }
+    uint64_t num_failures = 0;
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+        num_failures += workers[i].num_failures;
+    }
+    const double elapsed_sec = (double)(getMonotonicTimestampUSec() - started_at) * 1e-6;
+
+    if (num_failures > 0)
+    {
+        fprintf(stderr, "%llu allocations failed\n", (unsigned long long)num_failures);
+        exit(1);
+    }
+    if (mode == ModeMutex)
+    {
+        (void)pthread_mutex_destroy(&g_mutex_pool.mutex);
+    }
+    else if (canardGetSharedPoolStatistics(&g_shared_pool).current_usage_blocks != 0)
+    {
+        fprintf(stderr, "Blocks were lost\n");
+        exit(1);
+    }
+
+    const double num_allocations = (double)(NUM_ALLOCATIONS / BURST_SIZE / num_threads) * BURST_SIZE * num_threads;
+    printf("%-9s %u threads %8.1f M allocations/s\n", ModeNames[mode], num_threads,
+           num_allocations / elapsed_sec * 1e-6);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned max_threads = (argc > 1) ? (unsigned)atoi(argv[1]) : MAX_THREADS;
+    if ((max_threads < 1U) || (max_threads > MAX_THREADS))
+    {
+        fprintf(stderr, "The number of threads must be from 1 to %u\n", MAX_THREADS);
+        return 1;
+    }
+
+    for (unsigned n = 1; n <= max_threads; n *= 2U)
+    {
+        run(ModeMutex, n);
+        run(ModeLockFree, n);
+        run(ModeContext, n);
+    }
+    return 0;
+}
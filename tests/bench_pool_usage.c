@@ -0,0 +1,147 @@
+/*
+ * Memory pool usage on mixed classic and CAN FD traffic, with and without the pool size classes.
+ * The TX instance enqueues a mix of classic and FD transfers; the RX instance keeps a classic and an FD multi-frame
+ * transfer in progress for every source node. The memory in use is reported in bytes, counting whole blocks.
+ * Build with -DCANARD_ENABLE_CANFD=1, and with or without -DCANARD_ENABLE_SIZE_CLASSES=1.
+ *
+ * This benchmark is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+#include <canard.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !CANARD_ENABLE_CANFD
+# error "This benchmark needs CANARD_ENABLE_CANFD"
+#endif
+
+#define NUM_TX_ROUNDS               50U
+#define NUM_RX_NODES                50U
+#define CLASSIC_DATA_TYPE_ID        1000U
+#define FD_DATA_TYPE_ID             1001U
+#define DATA_TYPE_SIGNATURE         0x0123456789ABCDEFULL
+#define MEMORY_POOL_SIZE            (1024U * 1024U)
+
+static uint64_t g_tx_memory_pool[MEMORY_POOL_SIZE / 8U];
+static uint64_t g_rx_memory_pool[MEMORY_POOL_SIZE / 8U];
+static uint64_t g_generator_memory_pool[MEMORY_POOL_SIZE / 8U];
+
+
+static bool shouldAcceptTransfer(const CanardInstance* ins,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t source_node_id)
+{
+    (void)ins;
+    (void)transfer_type;
+    (void)source_node_id;
+    *out_data_type_signature = DATA_TYPE_SIGNATURE;
+    return (data_type_id == CLASSIC_DATA_TYPE_ID) || (data_type_id == FD_DATA_TYPE_ID);
+}
+
+static void onTransferReceived(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    (void)ins;
+    (void)transfer;
+}
+
+static void broadcast(CanardInstance* ins, uint16_t data_type_id, uint8_t* transfer_id,
+                      const uint8_t* payload, uint16_t payload_len, bool canfd)
+{
+    const int16_t res = canardBroadcast(ins, DATA_TYPE_SIGNATURE, data_type_id, transfer_id,
+                                        CANARD_TRANSFER_PRIORITY_LOW, payload, payload_len, canfd);
+    if (res <= 0)
+    {
+        fprintf(stderr, "Broadcast failed: %d\n", res);
+        exit(1);
+    }
+}
+
+/**
+ * Returns the number of bytes taken by the allocated blocks.
+ */
+static size_t getUsedBytes(CanardInstance* ins)
+{
+#if CANARD_ENABLE_SIZE_CLASSES
+    static const size_t BlockSizes[CANARD_POOL_NUM_SIZE_CLASSES] =
+    {
+        CANARD_POOL_SMALL_BLOCK_SIZE,
+        CANARD_POOL_MEDIUM_BLOCK_SIZE,
+        CANARD_POOL_LARGE_BLOCK_SIZE
+    };
+    size_t used = 0;
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        used += canardGetPoolSizeClassStatistics(ins, i).current_usage_blocks * BlockSizes[i];
+    }
+    return used;
+#else
+    return canardGetPoolAllocatorStatistics(ins).current_usage_blocks * (size_t)CANARD_MEM_BLOCK_SIZE;
+#endif
+}
+
+int main(void)
+{
+    uint8_t payload[300];
+    for (size_t i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = (uint8_t)i;
+    }
+
+    /*
+     * TX: classic single and multi-frame transfers, FD single frame transfers of various lengths, FD multi-frame
+     */
+    CanardInstance tx;
+    canardInit(&tx, g_tx_memory_pool, sizeof(g_tx_memory_pool), onTransferReceived, shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(&tx, 10);
+    uint8_t tx_transfer_id = 0;
+    for (uint32_t round = 0; round < NUM_TX_ROUNDS; round++)
+    {
+        broadcast(&tx, CLASSIC_DATA_TYPE_ID, &tx_transfer_id, payload, 7, false);
+        broadcast(&tx, CLASSIC_DATA_TYPE_ID, &tx_transfer_id, payload, 30, false);
+        broadcast(&tx, FD_DATA_TYPE_ID, &tx_transfer_id, payload, 24, true);
+        broadcast(&tx, FD_DATA_TYPE_ID, &tx_transfer_id, payload, 60, true);
+        broadcast(&tx, FD_DATA_TYPE_ID, &tx_transfer_id, payload, 150, true);
+    }
+    const CanardPoolAllocatorStatistics tx_stats = canardGetPoolAllocatorStatistics(&tx);
+
+    /*
+     * RX: every node sends all but the last frame of a classic and of an FD multi-frame transfer
+     */
+    CanardInstance generator;
+    CanardInstance rx;
+    canardInit(&rx, g_rx_memory_pool, sizeof(g_rx_memory_pool), onTransferReceived, shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(&rx, 20);
+    uint64_t timestamp_usec = 1000;
+    for (uint8_t node_id = 30; node_id < 30U + NUM_RX_NODES; node_id++)
+    {
+        canardInit(&generator, g_generator_memory_pool, sizeof(g_generator_memory_pool),
+                   onTransferReceived, shouldAcceptTransfer, NULL);
+        canardSetLocalNodeID(&generator, node_id);
+        uint8_t rx_transfer_id = 0;
+        broadcast(&generator, CLASSIC_DATA_TYPE_ID, &rx_transfer_id, payload, 100, false);
+        broadcast(&generator, FD_DATA_TYPE_ID, &rx_transfer_id, payload, 300, true);
+        for (const CanardCANFrame* frame = canardPeekTxQueue(&generator);
+             frame != NULL;
+             frame = canardPeekTxQueue(&generator))
+        {
+            const bool end_of_transfer = (frame->data[frame->data_len - 1U] & 0x40U) != 0;
+            if (!end_of_transfer)
+            {
+                (void)canardHandleRxFrame(&rx, frame, timestamp_usec++);
+            }
+            canardPopTxQueue(&generator);
+        }
+    }
+    const CanardPoolAllocatorStatistics rx_stats = canardGetPoolAllocatorStatistics(&rx);
+
+    printf("%-12s TX %5u blocks %8zu bytes, RX %5u blocks %8zu bytes, total %8zu bytes\n",
+           CANARD_ENABLE_SIZE_CLASSES ? "size classes" : "single size",
+           (unsigned)tx_stats.current_usage_blocks, getUsedBytes(&tx),
+           (unsigned)rx_stats.current_usage_blocks, getUsedBytes(&rx),
+           getUsedBytes(&tx) + getUsedBytes(&rx));
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * SocketCAN throughput benchmark: single frame vs. batched transmission and reception.
+ * Frames are sent from one socket and received on another socket bound to the same interface.
+ *
+ * Setup a virtual CAN interface first:
+ *   modprobe vcan
+ *   ip link add dev vcan0 type vcan
+ *   ip link set up vcan0
+ * Usage: bench_socketcan [iface, default vcan0]
+ *
+ * This benchmark is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include <canard.h>
+#include <socketcan.h>      // CAN backend driver for SocketCAN, distributed with Libcanard
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+
+#define NUM_FRAMES                  200000U
+#define BATCH_SIZE                  32U
+#define TIMEOUT_MSEC                1000
+
+
+static uint64_t getMonotonicTimestampUSec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    {
+        abort();
+    }
+    return (uint64_t)(ts.tv_sec * 1000000LL + ts.tv_nsec / 1000LL);
+}
+
+/**
+ * Sends NUM_FRAMES frames in batches of batch_size frames, receiving each batch before sending the next one,
+ * so that the socket buffers never overflow.
+ */
+static void run(SocketCANInstance* tx, SocketCANInstance* rx, uint16_t batch_size, const char* name)
+{
+    CanardCANFrame frames[BATCH_SIZE];
+    memset(frames, 0, sizeof(frames));
+    for (uint16_t i = 0; i < BATCH_SIZE; i++)
+    {
+        frames[i].id = CANARD_CAN_FRAME_EFF | (0x10000U + i);
+        frames[i].data_len = 8;
+        memset(frames[i].data, (int)i, frames[i].data_len);
+    }
+
+    const uint64_t started_at = getMonotonicTimestampUSec();
+    uint32_t transferred = 0;
+    while (transferred < NUM_FRAMES)
+    {
+        uint16_t sent = 0;
+        while (sent < batch_size)
+        {
+            const int16_t res = (batch_size == 1) ?
+                socketcanTransmit(tx, &frames[0], TIMEOUT_MSEC) :
+                socketcanTransmitBatch(tx, &frames[sent], (uint16_t)(batch_size - sent), TIMEOUT_MSEC);
+            if (res <= 0)
+            {
+                fprintf(stderr, "Transmission failed: %d\n", res);
+                exit(1);
+            }
+            sent = (uint16_t)(sent + res);
+        }
+
+        uint16_t received = 0;
+        while (received < batch_size)
+        {
+            const int16_t res = (batch_size == 1) ?
+                socketcanReceive(rx, &frames[0], TIMEOUT_MSEC) :
+                socketcanReceiveBatch(rx, &frames[received], NULL, (uint16_t)(batch_size - received),
+                                      TIMEOUT_MSEC);
+            if (res <= 0)
+            {
+                fprintf(stderr, "Reception failed: %d\n", res);
+                exit(1);
+            }
+            received = (uint16_t)(received + res);
+        }
+        transferred += batch_size;
+    }
+
+    const double elapsed_sec = (double)(getMonotonicTimestampUSec() - started_at) * 1e-6;
+    printf("%-24s %10.0f frames/s\n", name, (double)transferred / elapsed_sec);
+}
+
+int main(int argc, char** argv)
+{
+    const char* const iface = (argc > 1) ? argv[1] : "vcan0";
+
+    SocketCANInstance tx;
+    SocketCANInstance rx;
+    int16_t res = socketcanInit(&tx, iface);
+    if (res >= 0)
+    {
+        res = socketcanInit(&rx, iface);
+    }
+    if (res < 0)
+    {
+        fprintf(stderr, "Failed to open %s: %d\n", iface, res);
+        return 1;
+    }
+
+    run(&tx, &rx, 1, "single frame");
+    run(&tx, &rx, BATCH_SIZE, "batched (recvmmsg/sendmmsg)");
+
+    (void)socketcanClose(&tx);
+    (void)socketcanClose(&rx);
+    return 0;
+}
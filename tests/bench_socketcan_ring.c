@@ -0,0 +1,144 @@
+/*
+ * SocketCAN reception benchmark: memory mapped ring vs. the socket reads.
+ * Bursts of frames are transmitted to the interface, where three receivers get a copy of every frame:
+ * a CAN socket read one frame at a time, a CAN socket read in batches, and the memory mapped ring.
+ * The processor time spent in each receiver is reported per frame.
+ *
+ * Setup a virtual CAN interface first:
+ *   modprobe vcan
+ *   ip link add dev vcan0 type vcan
+ *   ip link set up vcan0
+ * Usage: bench_socketcan_ring [iface, default vcan0]
+ * The ring needs the CAP_NET_RAW capability, e.g. run as root.
+ *
+ * This benchmark is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include <canard.h>
+#include <socketcan.h>      // CAN backend driver for SocketCAN, distributed with Libcanard
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+
+#define NUM_ROUNDS                  500U
+#define BURST_SIZE                  100U        ///< Fits the default socket receive buffer
+#define BATCH_SIZE                  32U
+#define TIMEOUT_MSEC                1000
+
+
+static uint64_t getThreadCPUTimeNSec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    {
+        abort();
+    }
+    return (uint64_t)(ts.tv_sec * 1000000000LL + ts.tv_nsec);
+}
+
+static void fail(const char* what, int res)
+{
+    fprintf(stderr, "%s failed: %d\n", what, res);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    const char* const iface = (argc > 1) ? argv[1] : "vcan0";
+
+    SocketCANInstance tx;
+    SocketCANInstance rx_single;
+    SocketCANInstance rx_batch;
+    SocketCANRingInstance rx_ring;
+    int16_t res = socketcanInit(&tx, iface);
+    res = (int16_t)((res < 0) ? res : socketcanInit(&rx_single, iface));
+    res = (int16_t)((res < 0) ? res : socketcanInit(&rx_batch, iface));
+    if (res < 0)
+    {
+        fail("Opening the sockets", res);
+    }
+    res = socketcanRingInit(&rx_ring, iface);
+    if (res < 0)
+    {
+        fail("Opening the ring", res);
+    }
+
+    CanardCANFrame frames[BATCH_SIZE];
+    memset(frames, 0, sizeof(frames));
+    for (uint16_t i = 0; i < BATCH_SIZE; i++)
+    {
+        frames[i].id = CANARD_CAN_FRAME_EFF | (0x10000U + i);
+        frames[i].data_len = 8;
+        memset(frames[i].data, (int)i, frames[i].data_len);
+    }
+
+    uint64_t single_nsec = 0;
+    uint64_t batch_nsec = 0;
+    uint64_t ring_nsec = 0;
+    for (uint32_t round = 0; round < NUM_ROUNDS; round++)
+    {
+        for (uint16_t sent = 0; sent < BURST_SIZE;)
+        {
+            const uint16_t num_frames = (uint16_t)(((BURST_SIZE - sent) < BATCH_SIZE) ? (BURST_SIZE - sent) : BATCH_SIZE);
+            res = socketcanTransmitBatch(&tx, frames, num_frames, TIMEOUT_MSEC);
+            if (res <= 0)
+            {
+                fail("Transmission", res);
+            }
+            sent = (uint16_t)(sent + res);
+        }
+
+        uint64_t started_at = getThreadCPUTimeNSec();
+        for (uint16_t received = 0; received < BURST_SIZE; received++)
+        {
+            res = socketcanReceive(&rx_single, &frames[0], TIMEOUT_MSEC);
+            if (res <= 0)
+            {
+                fail("Reception", res);
+            }
+        }
+        single_nsec += getThreadCPUTimeNSec() - started_at;
+
+        started_at = getThreadCPUTimeNSec();
+        for (uint16_t received = 0; received < BURST_SIZE; received = (uint16_t)(received + res))
+        {
+            res = socketcanReceiveBatch(&rx_batch, frames, NULL, BATCH_SIZE, TIMEOUT_MSEC);
+            if (res <= 0)
+            {
+                fail("Batch reception", res);
+            }
+        }
+        batch_nsec += getThreadCPUTimeNSec() - started_at;
+
+        // Waiting for the ring block to be handed over takes no processor time
+        started_at = getThreadCPUTimeNSec();
+        for (uint16_t received = 0; received < BURST_SIZE; received = (uint16_t)(received + res))
+        {
+            res = socketcanRingReceiveBatch(&rx_ring, frames, NULL, BATCH_SIZE, TIMEOUT_MSEC);
+            if (res <= 0)
+            {
+                fail("Ring reception", res);
+            }
+        }
+        ring_nsec += getThreadCPUTimeNSec() - started_at;
+    }
+
+    const double num_frames = (double)NUM_ROUNDS * BURST_SIZE;
+    printf("%-28s %8.1f ns/frame\n", "read, one frame per call", (double)single_nsec / num_frames);
+    printf("%-28s %8.1f ns/frame\n", "recvmmsg, batched", (double)batch_nsec / num_frames);
+    printf("%-28s %8.1f ns/frame\n", "memory mapped ring", (double)ring_nsec / num_frames);
+
+    (void)socketcanRingClose(&rx_ring);
+    (void)socketcanClose(&tx);
+    (void)socketcanClose(&rx_single);
+    (void)socketcanClose(&rx_batch);
+    return 0;
+}
@@ -0,0 +1,255 @@
+/*
+ * Multi-threaded publication benchmark: a global mutex around the library instance vs. the TX staging queue.
+ * Every publisher thread broadcasts single frame transfers as fast as it can, one IO thread empties the TX queue.
+ * With the mutex, the publishers call canardBroadcast() and the IO thread peeks and pops the frames under the lock;
+ * with the staging queue, the publishers stage the transfers and the IO thread drains them into the instance.
+ * Build with -DCANARD_ENABLE_TX_STAGING=1.
+ *
+ * Usage: bench_tx_staging [max number of publisher threads, default 16]
+ *
+ * This benchmark is distributed under the terms of CC0 (public domain dedication).
+ * More info: https://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+// This is needed to enable necessary declarations in sys/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#include <canard.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+
+#if !CANARD_ENABLE_TX_STAGING
+# error "This benchmark needs CANARD_ENABLE_TX_STAGING"
+#endif
+
+#define NUM_TRANSFERS               400000U         ///< Split among the publishers
+#define MAX_PUBLISHERS              16U
+#define DRAIN_BATCH_SIZE            64U
+#define DATA_TYPE_ID                1000U
+#define MEMORY_POOL_SIZE            16384U
+
+typedef enum
+{
+    ModeMutex,
+    ModeStaging
+} Mode;
+
+typedef struct
+{
+    Mode mode;
+    uint32_t num_transfers_per_publisher;
+    unsigned num_publishers;
+
+    CanardInstance canard;
+    pthread_mutex_t canard_mutex;
+    CanardTxStaging staging;
+
+    unsigned num_publishers_done;                   ///< Protected by done_mutex
+    pthread_mutex_t done_mutex;
+
+    uint64_t num_frames_sent;                       ///< IO thread only
+    uint64_t num_retries;                           ///< Protected by done_mutex, summed up at the end
+} Benchmark;
+
+static uint8_t g_canard_memory_pool[MEMORY_POOL_SIZE];
+
+
+static uint64_t getMonotonicTimestampUSec(void)
+{
+    struct timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    {
+        abort();
+    }
+    return (uint64_t)(ts.tv_sec * 1000000LL + ts.tv_nsec / 1000LL);
+}
+
+static bool shouldAcceptTransfer(const CanardInstance* ins,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t source_node_id)
+{
+    (void)ins;
+    (void)out_data_type_signature;
+    (void)data_type_id;
+    (void)transfer_type;
+    (void)source_node_id;
+    return false;
+}
+
+static void onTransferReceived(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    (void)ins;
+    (void)transfer;
+}
+
+static bool areAllPublishersDone(Benchmark* bench)
+{
+    (void)pthread_mutex_lock(&bench->done_mutex);
+    const bool done = bench->num_publishers_done == bench->num_publishers;
+    (void)pthread_mutex_unlock(&bench->done_mutex);
+    return done;
+}
+
+/**
+ * Publishes the transfers; when the TX queue or the staging queue is full, yields to the IO thread and retries.
+ */
+static void* publisherThread(void* arg)
+{
+    Benchmark* const bench = (Benchmark*)arg;
+    uint8_t transfer_id = 0;
+    uint64_t num_retries = 0;
+    for (uint32_t i = 0; i < bench->num_transfers_per_publisher; i++)
+    {
+        uint8_t payload[7];
+        memset(payload, (int)(i & 0xFFU), sizeof(payload));
+        for (;;)
+        {
+            int16_t res = 0;
+            if (bench->mode == ModeMutex)
+            {
+                (void)pthread_mutex_lock(&bench->canard_mutex);
+                res = canardBroadcast(&bench->canard, 0, DATA_TYPE_ID, &transfer_id,
+                                      CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload));
+                (void)pthread_mutex_unlock(&bench->canard_mutex);
+            }
+            else
+            {
+                res = canardTxStagingBroadcast(&bench->staging, 0, DATA_TYPE_ID, &transfer_id,
+                                               CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload));
+            }
+            if (res >= 0)
+            {
+                break;
+            }
+            if (res != -CANARD_ERROR_OUT_OF_MEMORY)
+            {
+                fprintf(stderr, "Publication failed: %d\n", res);
+                exit(1);
+            }
+            num_retries++;
+            (void)sched_yield();
+        }
+    }
+
+    (void)pthread_mutex_lock(&bench->done_mutex);
+    bench->num_publishers_done++;
+    bench->num_retries += num_retries;
+    (void)pthread_mutex_unlock(&bench->done_mutex);
+    return NULL;
+}
+
+/**
+ * Pops all frames from the TX queue; a real application would hand them over to the CAN driver here.
+ */
+static void transmitAll(Benchmark* bench)
+{
+    while (canardPeekTxQueue(&bench->canard) != NULL)
+    {
+        canardPopTxQueue(&bench->canard);
+        bench->num_frames_sent++;
+    }
+}
+
+static void runIOThread(Benchmark* bench)
+{
+    for (;;)
+    {
+        const bool done = areAllPublishersDone(bench);
+        if (bench->mode == ModeMutex)
+        {
+            (void)pthread_mutex_lock(&bench->canard_mutex);
+            transmitAll(bench);
+            (void)pthread_mutex_unlock(&bench->canard_mutex);
+        }
+        else
+        {
+            int16_t res = 0;
+            while ((res = canardTxStagingDrain(&bench->staging, &bench->canard, DRAIN_BATCH_SIZE)) > 0)
+            {
+                transmitAll(bench);
+            }
+            if (res < 0)
+            {
+                fprintf(stderr, "Drain failed: %d\n", res);
+                exit(1);
+            }
+        }
+        if (done)
+        {
+            break;
+        }
+        (void)sched_yield();
+    }
+}
+
+static void run(Mode mode, unsigned num_publishers)
+{
+    static Benchmark bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.mode = mode;
+    bench.num_publishers = num_publishers;
+    bench.num_transfers_per_publisher = NUM_TRANSFERS / num_publishers;
+    canardInit(&bench.canard, g_canard_memory_pool, sizeof(g_canard_memory_pool),
+               onTransferReceived, shouldAcceptTransfer, NULL);
+    canardSetLocalNodeID(&bench.canard, 20);
+    canardTxStagingInit(&bench.staging);
+    (void)pthread_mutex_init(&bench.canard_mutex, NULL);
+    (void)pthread_mutex_init(&bench.done_mutex, NULL);
+
+    const uint64_t started_at = getMonotonicTimestampUSec();
+    pthread_t publishers[MAX_PUBLISHERS];
+    for (unsigned i = 0; i < num_publishers; i++)
+    {
+        if (pthread_create(&publishers[i], NULL, publisherThread, &bench) != 0)
+        {
+            fprintf(stderr, "Failed to start a publisher\n");
+            exit(1);
+        }
+    }
+    runIOThread(&bench);
+    for (unsigned i = 0; i < num_publishers; i++)
+    {
+        (void)pthread_join(publishers[i], NULL);
+    }
+    const double elapsed_sec = (double)(getMonotonicTimestampUSec() - started_at) * 1e-6;
+
+    const uint64_t expected = (uint64_t)bench.num_transfers_per_publisher * num_publishers;
+    if (bench.num_frames_sent != expected)
+    {
+        fprintf(stderr, "Sent %llu frames instead of %llu\n",
+                (unsigned long long)bench.num_frames_sent, (unsigned long long)expected);
+        exit(1);
+    }
+    printf("%-8s %2u publishers %12.0f transfers/s %10llu retries\n",
+           (mode == ModeMutex) ? "mutex" : "staging", num_publishers,
+           (double)bench.num_frames_sent / elapsed_sec, (unsigned long long)bench.num_retries);
+
+    (void)pthread_mutex_destroy(&bench.canard_mutex);
+    (void)pthread_mutex_destroy(&bench.done_mutex);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned max_publishers = (argc > 1) ? (unsigned)atoi(argv[1]) : MAX_PUBLISHERS;
+    if ((max_publishers < 1U) || (max_publishers > MAX_PUBLISHERS))
+    {
+        fprintf(stderr, "The number of publishers must be from 1 to %u\n", MAX_PUBLISHERS);
+        return 1;
+    }
+
+    for (unsigned n = 1; n <= max_publishers; n *= 2U)
+    {
+        run(ModeMutex, n);
+        run(ModeStaging, n);
+    }
+    return 0;
+}
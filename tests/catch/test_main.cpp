@@ -25,4 +25,6 @@
 // For speedy compilation, the file that contains CATCH_CONFIG_MAIN should not contain any actual tests.
 // https://github.com/catchorg/Catch2/blob/master/docs/slow-compiles.md
 #define CATCH_CONFIG_MAIN
+// This version of Catch sizes its signal stack with SIGSTKSZ, which is not a constant in recent glibc versions
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"  // NOLINT
@@ -305,13 +305,8 @@ static bool shouldAcceptTransfer(const CanardInstance* ins,
 /**
  * This function is called at 1 Hz rate from the main loop.
  */
-static void process1HzTasks(uint64_t timestamp_usec)
+static void process1HzTasks(void)
 {
-    /*
-     * Purging transfers that are no longer transmitted. This will occasionally free up some memory.
-     */
-    canardCleanupStaleTransfers(&g_canard, timestamp_usec);
-
     /*
      * Printing the memory usage statistics.
      */
@@ -382,17 +377,17 @@ static void processTxRxOnce(SocketCANInstance* socketcan, int32_t timeout_msec)
         }
     }
 
-    // Receiving
+    // Receiving, the frame is timestamped by the kernel
     CanardCANFrame rx_frame;
-    const uint64_t timestamp = getMonotonicTimestampUSec();
-    const int16_t rx_res = socketcanReceive(socketcan, &rx_frame, timeout_msec);
+    SocketCANFrameInfo rx_info;
+    const int16_t rx_res = socketcanReceiveBatch(socketcan, &rx_frame, &rx_info, 1, timeout_msec);
     if (rx_res < 0)             // Failure - report
     {
         (void)fprintf(stderr, "Receive error %d, errno '%s'\n", rx_res, strerror(errno));
     }
     else if (rx_res > 0)        // Success - process the frame
     {
-        canardHandleRxFrame(&g_canard, &rx_frame, timestamp);
+        canardHandleRxFrame(&g_canard, &rx_frame, rx_info.timestamp_usec);
     }
     else
     {
@@ -516,14 +511,29 @@ int main(int argc, char** argv)
 
     for (;;)
     {
-        processTxRxOnce(&socketcan, 10);
+        /*
+         * Sleeping until a frame arrives, the periodic tasks are due, or the library has work to do,
+         * instead of waking up at a fixed rate.
+         */
+        const uint64_t library_deadline = canardGetNextDeadline(&g_canard);
+        const uint64_t wake_at = (library_deadline < next_1hz_service_at) ? library_deadline : next_1hz_service_at;
+        const uint64_t now = getMonotonicTimestampUSec();
+        processTxRxOnce(&socketcan, (wake_at > now) ? (int32_t)((wake_at - now + 999U) / 1000U) : 0);
 
         const uint64_t ts = getMonotonicTimestampUSec();
 
+        /*
+         * Purging transfers that are no longer transmitted. This will occasionally free up some memory.
+         */
+        if (ts >= library_deadline)
+        {
+            canardCleanupStaleTransfers(&g_canard, ts);
+        }
+
         if (ts >= next_1hz_service_at)
         {
             next_1hz_service_at += 1000000;
-            process1HzTasks(ts);
+            process1HzTasks();
         }
     }
 
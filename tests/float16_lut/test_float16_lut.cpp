@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * These tests are built with the table-driven float16 conversion enabled; it must match the arithmetic conversion
+ * that is used otherwise bit for bit, except for the rounding of ties.
+ */
+
+#include <catch.hpp>
+#include <canard.h>
+#include <cstring>
+
+
+static uint32_t floatToBits(float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsToFloat(uint32_t bits)
+{
+    float value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * The arithmetic conversion of canard.c, used when CANARD_ENABLE_FLOAT16_LUT is not set.
+ */
+static uint16_t referenceNativeFloatToFloat16(float value)
+{
+    const uint32_t f32inf = 255UL << 23U;
+    const uint32_t f16inf = 31UL << 23U;
+    const float magic = bitsToFloat(15UL << 23U);
+    const uint32_t sign_mask = 0x80000000UL;
+    const uint32_t round_mask = 0xFFFFF000UL;
+
+    uint32_t in = floatToBits(value);
+    const uint32_t sign = in & sign_mask;
+    in ^= sign;
+
+    uint16_t out = 0;
+    if (in >= f32inf)
+    {
+        out = (in > f32inf) ? uint16_t(0x7FFFU) : uint16_t(0x7C00U);
+    }
+    else
+    {
+        in &= round_mask;
+        in = floatToBits(bitsToFloat(in) * magic);
+        in -= round_mask;
+        if (in > f16inf)
+        {
+            in = f16inf;
+        }
+        out = uint16_t(in >> 13U);
+    }
+    return uint16_t(out | (sign >> 16U));
+}
+
+static uint32_t referenceFloat16ToNativeFloat(uint16_t value)
+{
+    const float magic = bitsToFloat((254UL - 15UL) << 23U);
+    const float was_inf_nan = bitsToFloat((127UL + 16UL) << 23U);
+
+    uint32_t out = floatToBits(bitsToFloat(uint32_t(value & 0x7FFFU) << 13U) * magic);
+    if (bitsToFloat(out) >= was_inf_nan)
+    {
+        out |= 255UL << 23U;
+    }
+    return out | (uint32_t(value & 0x8000U) << 16U);
+}
+
+/**
+ * The arithmetic conversion rounds exact ties between two float16 values away from zero, while the tables round them
+ * to even like IEEE 754 (and F16C) do. These are the only values where the two differ.
+ */
+static bool isTie(float value)
+{
+    const uint32_t bits = floatToBits(value);
+    const uint32_t exponent = (bits >> 23U) & 0xFFU;
+    if ((exponent < 102U) || (exponent > 142U))
+    {
+        return false;
+    }
+    const uint32_t significand = (bits & 0x7FFFFFUL) | 0x800000UL;
+    const uint32_t shift = (exponent < 113U) ? (126U - exponent) : 13U;     // Subnormal float16 values lose more bits
+    return (significand & ((1UL << shift) - 1U)) == (1UL << (shift - 1U));
+}
+
+static void checkFromNative(float value)
+{
+    const uint16_t reference = referenceNativeFloatToFloat16(value);
+    const uint16_t lut = canardConvertNativeFloatToFloat16(value);
+    if (isTie(value))
+    {
+        REQUIRE(0 == (lut & 1U));
+        REQUIRE(((reference == lut) || (reference == lut + 1U)));
+    }
+    else
+    {
+        REQUIRE(reference == lut);
+    }
+}
+
+
+TEST_CASE("Float16Lut, ToNativeAllValues")
+{
+    for (uint32_t i = 0; i <= 0xFFFFU; i++)
+    {
+        const uint16_t half = uint16_t(i);
+        REQUIRE(referenceFloat16ToNativeFloat(half) == floatToBits(canardConvertFloat16ToNativeFloat(half)));
+    }
+}
+
+
+TEST_CASE("Float16Lut, FromNativeAllValues")
+{
+    // Every float16 value, the midpoints between neighbours where the rounding decides, and the floats next to them
+    for (uint32_t i = 0; i <= 0xFFFFU; i++)
+    {
+        const uint32_t bits = floatToBits(canardConvertFloat16ToNativeFloat(uint16_t(i)));
+        const uint32_t next = floatToBits(canardConvertFloat16ToNativeFloat(uint16_t(i + 1U)));
+        const bool has_next = ((i & 0x7FFFU) < 0x7BFFU);
+        const uint32_t midpoint = has_next ? (bits + ((next - bits) / 2U)) : bits;
+
+        for (uint32_t probe : { bits, bits + 1U, midpoint - 1U, midpoint, midpoint + 1U })
+        {
+            checkFromNative(bitsToFloat(probe));
+        }
+    }
+}
+
+
+TEST_CASE("Float16Lut, FromNativeSweep")
+{
+    // A strided sweep over all floats, including the ones far outside of the float16 range
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFULL; bits += 4099U)
+    {
+        checkFromNative(bitsToFloat(uint32_t(bits)));
+    }
+}
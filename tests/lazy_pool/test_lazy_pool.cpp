@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * These tests are built with the lazy pool initialization enabled, with and without the pool size classes.
+ */
+
+#include "../test_helpers.hpp"
+#include <vector>
+
+
+static const uint8_t UntouchedByte = 0xA5;
+
+/**
+ * Enqueues a classic single frame transfer; returns the result of canardBroadcast().
+ */
+static int16_t broadcastSingleFrame(CanardInstance* ins, uint8_t* transfer_id)
+{
+    const uint8_t payload[7] = {};
+    return canardBroadcast(ins, DataTypeSignature, DataTypeID, transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                           payload, sizeof(payload)
+#if CANARD_ENABLE_CANFD
+                           , false
+#endif
+                           );
+}
+
+/**
+ * Returns the number of bytes from the start of the arena up to the last modified byte.
+ */
+static size_t getTouchedSize(const std::vector<uint8_t>& arena)
+{
+    size_t size = arena.size();
+    while ((size > 0) && (arena[size - 1U] == UntouchedByte))
+    {
+        size--;
+    }
+    return size;
+}
+
+TEST_CASE("LazyPool, InitDoesNotTouchTheArena")
+{
+    std::vector<uint8_t> arena(1024U * 1024U, UntouchedByte);
+    CanardInstance ins;
+    canardInit(&ins, &arena[0], arena.size(), onTransferReceived, shouldAcceptTransfer, nullptr);
+    REQUIRE(0 == getTouchedSize(arena));
+
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+#if CANARD_ENABLE_SIZE_CLASSES
+    CanardPoolBlockCount capacity = 0;
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        capacity = CanardPoolBlockCount(capacity + canardGetPoolSizeClassStatistics(&ins, i).capacity_blocks);
+    }
+    REQUIRE(capacity == stats.capacity_blocks);
+#else
+    REQUIRE(arena.size() / CANARD_MEM_BLOCK_SIZE == stats.capacity_blocks);
+#endif
+    REQUIRE(0 == stats.current_usage_blocks);
+    REQUIRE(0 == stats.peak_usage_blocks);
+}
+
+TEST_CASE("LazyPool, OnlyUsedBlocksAreTouched")
+{
+    std::vector<uint8_t> arena(64U * 1024U, UntouchedByte);
+    CanardInstance ins;
+    canardInit(&ins, &arena[0], arena.size(), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+
+    // The freed blocks are reused, so the touched memory does not grow beyond the peak usage
+    uint8_t transfer_id = 0;
+    for (int round = 0; round < 100; round++)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            REQUIRE(1 == broadcastSingleFrame(&ins, &transfer_id));
+        }
+        while (canardPeekTxQueue(&ins) != nullptr)
+        {
+            canardPopTxQueue(&ins);
+        }
+    }
+
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(0 == stats.current_usage_blocks);
+    REQUIRE(5 == stats.peak_usage_blocks);
+    REQUIRE(getTouchedSize(arena) > 0);
+    REQUIRE(getTouchedSize(arena) <= 5U * CANARD_MEM_BLOCK_SIZE);
+}
+
+TEST_CASE("LazyPool, WholeArenaCanBeAllocated")
+{
+    std::vector<uint8_t> arena(4096, UntouchedByte);
+    CanardInstance ins;
+    canardInit(&ins, &arena[0], arena.size(), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+    const CanardPoolBlockCount capacity = canardGetPoolAllocatorStatistics(&ins).capacity_blocks;
+    REQUIRE(capacity > 0);
+
+    // Twice: from the untouched part of the arena first, then from the free list
+    uint8_t transfer_id = 0;
+    for (int round = 0; round < 2; round++)
+    {
+        for (CanardPoolBlockCount i = 0; i < capacity; i++)
+        {
+            REQUIRE(1 == broadcastSingleFrame(&ins, &transfer_id));
+        }
+        REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == broadcastSingleFrame(&ins, &transfer_id));
+
+        CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+        REQUIRE(capacity == stats.current_usage_blocks);
+        REQUIRE(capacity == stats.peak_usage_blocks);
+
+        while (canardPeekTxQueue(&ins) != nullptr)
+        {
+            canardPopTxQueue(&ins);
+        }
+        stats = canardGetPoolAllocatorStatistics(&ins);
+        REQUIRE(0 == stats.current_usage_blocks);
+        REQUIRE(capacity == stats.peak_usage_blocks);
+    }
+}
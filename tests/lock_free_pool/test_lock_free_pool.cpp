@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * These tests are built with the lock-free shared pool enabled, with and without the lazy pool initialization.
+ */
+
+#include "../test_helpers.hpp"
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+
+static const size_t NumThreads = 4;
+
+TEST_CASE("LockFreePool, ContextCachesBlocks")
+{
+    static uint64_t arena[(64U * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardSharedPool pool;
+    canardInitSharedPool(&pool, arena, sizeof(arena));
+    CanardSharedPoolContext context;
+    canardInitSharedPoolContext(&context, &pool);
+
+    // The first allocation takes half of the magazine from the pool
+    void* const block = context.base.allocate(&context.base, CANARD_MEM_BLOCK_SIZE);
+    REQUIRE(block != nullptr);
+    REQUIRE(CANARD_POOL_MAGAZINE_SIZE / 2U == canardGetSharedPoolStatistics(&pool).current_usage_blocks);
+
+    // The magazine overflows into the pool by half
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < CANARD_POOL_MAGAZINE_SIZE * 2U; i++)
+    {
+        blocks.push_back(context.base.allocate(&context.base, CANARD_MEM_BLOCK_SIZE));
+        REQUIRE(blocks.back() != nullptr);
+    }
+    context.base.deallocate(&context.base, block);
+    for (void* p : blocks)
+    {
+        context.base.deallocate(&context.base, p);
+    }
+    REQUIRE(canardGetSharedPoolStatistics(&pool).current_usage_blocks <= CANARD_POOL_MAGAZINE_SIZE);
+    REQUIRE(canardGetSharedPoolStatistics(&pool).current_usage_blocks >= CANARD_POOL_MAGAZINE_SIZE / 2U);
+
+    canardFlushSharedPoolContext(&context);
+    const CanardPoolAllocatorStatistics stats = canardGetSharedPoolStatistics(&pool);
+    REQUIRE(0 == stats.current_usage_blocks);
+    REQUIRE(stats.peak_usage_blocks > CANARD_POOL_MAGAZINE_SIZE * 2U);
+}
+
+TEST_CASE("LockFreePool, ConcurrentAllocations")
+{
+    static const size_t NumBlocks = 64;
+    static const size_t MaxBlocksPerThread = 24;
+    static uint64_t arena[(NumBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardSharedPool pool;
+    canardInitSharedPool(&pool, arena, sizeof(arena));
+
+    // Half of the threads use the pool directly, the others through their contexts
+    std::atomic<unsigned> num_errors(0);
+    std::atomic<unsigned> num_exhausted(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < NumThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            CanardSharedPoolContext context;
+            canardInitSharedPoolContext(&context, &pool);
+            CanardMemoryAllocator* const allocator = ((t % 2U) == 0U) ? &pool.base : &context.base;
+
+            // Every block is filled with a pattern of its owner, which must be intact when it is freed
+            std::mt19937 random(static_cast<unsigned>(t));
+            std::vector<uint8_t*> blocks;
+            for (int i = 0; i < 200000; i++)
+            {
+                if (((random() % 2U) == 0U) && (blocks.size() < MaxBlocksPerThread))
+                {
+                    uint8_t* const block = static_cast<uint8_t*>(allocator->allocate(allocator,
+                                                                                     CANARD_MEM_BLOCK_SIZE));
+                    if (block == nullptr)
+                    {
+                        num_exhausted++;
+                        continue;
+                    }
+                    std::memset(block, int(t + 1U), CANARD_MEM_BLOCK_SIZE);
+                    blocks.push_back(block);
+                }
+                else if (!blocks.empty())
+                {
+                    uint8_t* const block = blocks.back();
+                    blocks.pop_back();
+                    for (size_t k = 0; k < CANARD_MEM_BLOCK_SIZE; k++)
+                    {
+                        if (block[k] != uint8_t(t + 1U))
+                        {
+                            num_errors++;
+                            break;
+                        }
+                    }
+                    allocator->deallocate(allocator, block);
+                }
+            }
+            for (uint8_t* block : blocks)
+            {
+                allocator->deallocate(allocator, block);
+            }
+            canardFlushSharedPoolContext(&context);
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(0 == num_errors);
+
+    // No block was lost or duplicated
+    CanardPoolAllocatorStatistics stats = canardGetSharedPoolStatistics(&pool);
+    REQUIRE(0 == stats.current_usage_blocks);
+    REQUIRE(stats.peak_usage_blocks <= NumBlocks);
+    std::set<void*> blocks;
+    for (void* p = pool.base.allocate(&pool.base, 1); p != nullptr; p = pool.base.allocate(&pool.base, 1))
+    {
+        REQUIRE(blocks.insert(p).second);
+    }
+    REQUIRE(NumBlocks == blocks.size());
+    REQUIRE(NumBlocks == canardGetSharedPoolStatistics(&pool).current_usage_blocks);
+}
+
+TEST_CASE("LockFreePool, ConcurrentInstances")
+{
+    static const unsigned NumTransfers = 2000;
+    static uint64_t arena[(256U * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardSharedPool pool;
+    canardInitSharedPool(&pool, arena, sizeof(arena));
+
+    // Every thread passes multi-frame transfers between its own pair of instances
+    std::atomic<unsigned> num_errors(0);
+    std::vector<unsigned> num_received(NumThreads, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < NumThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            CanardSharedPoolContext context;
+            canardInitSharedPoolContext(&context, &pool);
+            CanardInstance tx;
+            CanardInstance rx;
+            canardInit(&tx, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+            canardInit(&rx, nullptr, 0, onTransferReceived, shouldAcceptTransfer, &num_received[t]);
+            if ((canardAttachSharedPoolContext(&tx, &context, 32) < 0) ||
+                (canardAttachSharedPoolContext(&rx, &context, 32) < 0))
+            {
+                num_errors++;
+                return;
+            }
+            canardSetLocalNodeID(&tx, uint8_t(10U + t));
+            canardSetLocalNodeID(&rx, uint8_t(20U + t));
+
+            const uint8_t payload[60] = {};
+            uint8_t transfer_id = 0;
+            uint64_t timestamp = 1000;
+            for (unsigned i = 0; i < NumTransfers; i++)
+            {
+                if (canardBroadcast(&tx, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                    payload, sizeof(payload)) <= 0)
+                {
+                    num_errors++;
+                    break;
+                }
+                for (const CanardCANFrame* frame = canardPeekTxQueue(&tx);
+                     frame != nullptr;
+                     frame = canardPeekTxQueue(&tx))
+                {
+                    if (canardHandleRxFrame(&rx, frame, timestamp++) < 0)
+                    {
+                        num_errors++;
+                    }
+                    canardPopTxQueue(&tx);
+                }
+            }
+            canardCleanupStaleTransfers(&rx, timestamp + 10000000U);
+            if ((canardGetPoolAllocatorStatistics(&tx).current_usage_blocks != 0) ||
+                (canardGetPoolAllocatorStatistics(&rx).current_usage_blocks != 0))
+            {
+                num_errors++;
+            }
+            canardFlushSharedPoolContext(&context);
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(0 == num_errors);
+    REQUIRE(std::vector<unsigned>(NumThreads, NumTransfers) == num_received);
+    REQUIRE(0 == canardGetSharedPoolStatistics(&pool).current_usage_blocks);
+}
+
+TEST_CASE("LockFreePool, HeadWidth")
+{
+    // Where a 64-bit compare-exchange is lock-free, the free list head has a 32-bit generation tag
+#if defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+    REQUIRE(8 == sizeof(CanardPoolLockFreeHead));
+#endif
+    REQUIRE(sizeof(CanardPoolLockFreeHead) >= 2U * sizeof(CanardPoolBlockCount));
+}
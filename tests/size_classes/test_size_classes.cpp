@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * These tests are built with CAN FD, the pool size classes and the custom allocator enabled.
+ */
+
+#include "../test_helpers.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+
+/**
+ * Returns the index of the smallest size class that fits the given number of bytes.
+ */
+static uint8_t sizeClassOf(size_t size)
+{
+    if (size <= CANARD_POOL_SMALL_BLOCK_SIZE)
+    {
+        return 0;
+    }
+    if (size <= CANARD_POOL_MEDIUM_BLOCK_SIZE)
+    {
+        return 1;
+    }
+    return 2;
+}
+
+static std::vector<CanardPoolBlockCount> getUsage(CanardInstance* ins)
+{
+    std::vector<CanardPoolBlockCount> usage;
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        usage.push_back(canardGetPoolSizeClassStatistics(ins, i).current_usage_blocks);
+    }
+    return usage;
+}
+
+static void collectPayload(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    auto received = static_cast<std::vector<std::vector<uint8_t>>*>(canardGetUserReference(ins));
+    std::vector<uint8_t> payload(transfer->payload_len);
+    for (uint16_t i = 0; i < transfer->payload_len; i++)
+    {
+        REQUIRE(8 == canardDecodeScalar(transfer, i * 8U, 8, false, &payload[i]));
+    }
+    received->push_back(payload);
+}
+
+TEST_CASE("SizeClasses, ArenaIsSplitByShares")
+{
+    static const size_t ArenaSize = 8192;
+    static uint64_t arena[ArenaSize / 8U];
+    CanardInstance ins;
+    canardInit(&ins, arena, ArenaSize, onTransferReceived, shouldAcceptTransfer, nullptr);
+
+    const size_t small_blocks = ArenaSize * CANARD_POOL_SMALL_SHARE_PERCENT / 100U / CANARD_POOL_SMALL_BLOCK_SIZE;
+    const size_t medium_blocks = ArenaSize * CANARD_POOL_MEDIUM_SHARE_PERCENT / 100U / CANARD_POOL_MEDIUM_BLOCK_SIZE;
+    const size_t large_blocks = (ArenaSize - small_blocks * CANARD_POOL_SMALL_BLOCK_SIZE -
+                                 medium_blocks * CANARD_POOL_MEDIUM_BLOCK_SIZE) / CANARD_POOL_LARGE_BLOCK_SIZE;
+
+    REQUIRE(small_blocks ==  canardGetPoolSizeClassStatistics(&ins, 0).capacity_blocks);
+    REQUIRE(medium_blocks == canardGetPoolSizeClassStatistics(&ins, 1).capacity_blocks);
+    REQUIRE(large_blocks ==  canardGetPoolSizeClassStatistics(&ins, 2).capacity_blocks);
+
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(small_blocks + medium_blocks + large_blocks == stats.capacity_blocks);
+    REQUIRE(0 == stats.current_usage_blocks);
+    REQUIRE(0 == stats.peak_usage_blocks);
+}
+
+TEST_CASE("SizeClasses, TxFramesTakeSmallestClass")
+{
+    static uint64_t arena[1024];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+
+    const size_t header_size = sizeof(void*) + offsetof(CanardCANFrame, data);
+    uint8_t payload[63];
+    for (uint8_t i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = i;
+    }
+
+    struct
+    {
+        uint16_t payload_len;
+        bool canfd;
+        uint8_t frame_data_len;
+    } const cases[] = {
+        { 7,  false, 8 },
+        { 12, true,  16 },
+        { 30, true,  32 },
+        { 63, true,  64 },
+    };
+
+    uint8_t transfer_id = 0;
+    std::vector<CanardPoolBlockCount> expected_usage(CANARD_POOL_NUM_SIZE_CLASSES, 0);
+    for (const auto& c : cases)
+    {
+        REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                     CANARD_TRANSFER_PRIORITY_LOW, payload, c.payload_len, c.canfd));
+        expected_usage[sizeClassOf(header_size + c.frame_data_len)]++;
+        REQUIRE(expected_usage == getUsage(&ins));
+
+        const CanardCANFrame* const frame = canardPeekTxQueue(&ins);
+        REQUIRE(frame != nullptr);
+        REQUIRE(c.frame_data_len == frame->data_len);
+        REQUIRE(c.canfd == frame->canfd);
+        REQUIRE(0 == std::memcmp(frame->data, payload, c.payload_len));
+        REQUIRE((0xC0U | ((transfer_id - 1U) & 31U)) == frame->data[frame->data_len - 1U]);
+        canardPopTxQueue(&ins);
+        std::fill(expected_usage.begin(), expected_usage.end(), 0);
+        REQUIRE(expected_usage == getUsage(&ins));
+    }
+
+    // Every classic frame of a multi-frame transfer takes a block of its own size class
+    REQUIRE(4 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                 CANARD_TRANSFER_PRIORITY_LOW, payload, 20, false));
+    REQUIRE(4 == getUsage(&ins)[sizeClassOf(header_size + CANARD_CAN_FRAME_MAX_DATA_LEN)]);
+    REQUIRE(4 == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+}
+
+TEST_CASE("SizeClasses, PeekedFrameIsComplete")
+{
+    // Heap blocks of exactly the requested size, so that a read past a trimmed frame is caught by sanitizers
+    CanardMemoryAllocator allocator;
+    allocator.allocate = [](CanardMemoryAllocator*, size_t size) { return std::malloc(size); };
+    allocator.deallocate = [](CanardMemoryAllocator*, void* pointer) { std::free(pointer); };
+
+    CanardInstance ins;
+    canardInit(&ins, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+    REQUIRE(0 == canardSetMemoryAllocator(&ins, &allocator));
+
+    // The size class statistics do not apply to the custom allocator
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_SIZE_CLASSES; i++)
+    {
+        REQUIRE(0 == canardGetPoolSizeClassStatistics(&ins, i).capacity_blocks);
+    }
+
+    // The second transfer goes to the head of the queue; the peeked frames can be copied by value
+    const uint8_t payload[63] = {1, 2, 3};
+    uint8_t transfer_id = 0;
+    REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                 CANARD_TRANSFER_PRIORITY_LOW, payload, 3, false));
+    CanardCANFrame frame = *canardPeekTxQueue(&ins);
+    REQUIRE(4 == frame.data_len);
+    REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                 CANARD_TRANSFER_PRIORITY_HIGH, payload, sizeof(payload), true));
+    frame = *canardPeekTxQueue(&ins);
+    REQUIRE(64 == frame.data_len);
+    REQUIRE(frame.canfd);
+    REQUIRE(0 == std::memcmp(frame.data, payload, sizeof(payload)));
+    canardPopTxQueue(&ins);
+    frame = *canardPeekTxQueue(&ins);
+    REQUIRE(4 == frame.data_len);
+    REQUIRE(!frame.canfd);
+    REQUIRE(0 == std::memcmp(frame.data, payload, 3));
+    canardPopTxQueue(&ins);
+    REQUIRE(nullptr == canardPeekTxQueue(&ins));
+}
+
+TEST_CASE("SizeClasses, ExhaustedClassFallsBackToLarger")
+{
+    static uint64_t arena[128];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+
+    const CanardPoolAllocatorStatistics small = canardGetPoolSizeClassStatistics(&ins, 0);
+    const CanardPoolAllocatorStatistics medium = canardGetPoolSizeClassStatistics(&ins, 1);
+    const CanardPoolAllocatorStatistics large = canardGetPoolSizeClassStatistics(&ins, 2);
+    REQUIRE(small.capacity_blocks > 0);
+    REQUIRE(medium.capacity_blocks > 0);
+    REQUIRE(large.capacity_blocks > 0);
+
+    // Classic single frame transfers fill up all classes, starting from the smallest
+    const uint8_t payload[7] = {1, 2, 3, 4, 5, 6, 7};
+    uint8_t transfer_id = 0;
+    const size_t total = size_t(small.capacity_blocks) + medium.capacity_blocks + large.capacity_blocks;
+    for (size_t i = 0; i < total; i++)
+    {
+        REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                     CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload), false));
+        const std::vector<CanardPoolBlockCount> usage = getUsage(&ins);
+        REQUIRE(usage[0] == std::min<size_t>(i + 1, small.capacity_blocks));
+        REQUIRE(usage[2] == ((i + 1 > size_t(small.capacity_blocks) + medium.capacity_blocks) ?
+                             i + 1 - small.capacity_blocks - medium.capacity_blocks : 0));
+    }
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                                           CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload),
+                                                           false));
+
+    CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(total == stats.current_usage_blocks);
+    REQUIRE(total == stats.peak_usage_blocks);
+
+    // Every block goes back to its own class
+    while (canardPeekTxQueue(&ins) != nullptr)
+    {
+        canardPopTxQueue(&ins);
+    }
+    REQUIRE(std::vector<CanardPoolBlockCount>(CANARD_POOL_NUM_SIZE_CLASSES, 0) == getUsage(&ins));
+    REQUIRE(small.capacity_blocks == canardGetPoolSizeClassStatistics(&ins, 0).peak_usage_blocks);
+    REQUIRE(medium.capacity_blocks == canardGetPoolSizeClassStatistics(&ins, 1).peak_usage_blocks);
+    REQUIRE(large.capacity_blocks == canardGetPoolSizeClassStatistics(&ins, 2).peak_usage_blocks);
+    stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(0 == stats.current_usage_blocks);
+    REQUIRE(total == stats.peak_usage_blocks);
+}
+
+TEST_CASE("SizeClasses, MultiFrameReception")
+{
+    static uint64_t tx_arena[1024];
+    static uint64_t rx_arena[1024];
+    std::vector<std::vector<uint8_t>> received;
+    CanardInstance tx;
+    CanardInstance rx;
+    canardInit(&tx, tx_arena, sizeof(tx_arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardInit(&rx, rx_arena, sizeof(rx_arena), collectPayload, shouldAcceptTransfer, &received);
+    canardSetLocalNodeID(&tx, 10);
+    canardSetLocalNodeID(&rx, 20);
+
+    std::vector<uint8_t> payload(300);
+    for (size_t i = 0; i < payload.size(); i++)
+    {
+        payload[i] = uint8_t(i * 7U);
+    }
+
+    // A classic and an FD transfer from the same node, received through the same RX state
+    uint8_t transfer_id = 0;
+    REQUIRE(canardBroadcast(&tx, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                            payload.data(), 100, false) > 1);
+    REQUIRE(canardBroadcast(&tx, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                            payload.data(), 300, true) > 1);
+
+    uint64_t timestamp = 1000;
+    for (const CanardCANFrame* frame = canardPeekTxQueue(&tx); frame != nullptr; frame = canardPeekTxQueue(&tx))
+    {
+        REQUIRE(0 == canardHandleRxFrame(&rx, frame, timestamp++));
+        canardPopTxQueue(&tx);
+    }
+    REQUIRE(0 == canardGetPoolAllocatorStatistics(&tx).current_usage_blocks);
+
+    REQUIRE(2 == received.size());
+    REQUIRE(std::vector<uint8_t>(payload.begin(), payload.begin() + 100) == received[0]);
+    // The padding of the last CAN FD frame is a part of the received payload
+    REQUIRE(received[1].size() >= payload.size());
+    REQUIRE(payload == std::vector<uint8_t>(received[1].begin(), received[1].begin() + 300));
+    REQUIRE(std::vector<uint8_t>(received[1].size() - 300, 0) ==
+            std::vector<uint8_t>(received[1].begin() + 300, received[1].end()));
+
+    // The payload buffers are released, the RX states stay in their class
+    std::vector<CanardPoolBlockCount> expected_usage(CANARD_POOL_NUM_SIZE_CLASSES, 0);
+    expected_usage[sizeClassOf(CANARD_RX_STATE_BLOCK_SIZE)] = 1;
+    REQUIRE(expected_usage == getUsage(&rx));
+    REQUIRE(canardGetPoolSizeClassStatistics(&rx, sizeClassOf(CANARD_BUFFER_BLOCK_SIZE)).peak_usage_blocks >=
+            (300U - CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE) / CANARD_BUFFER_BLOCK_DATA_SIZE);
+}
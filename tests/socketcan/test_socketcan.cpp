@@ -0,0 +1,599 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+/*
+ * These tests are built with CAN FD enabled. They use the interface vcan0 if it exists and is in FD mode:
+ *   modprobe vcan
+ *   ip link add dev vcan0 type vcan
+ *   ip link set vcan0 mtu 72
+ *   ip link set up vcan0
+ * Otherwise the frame format is checked over a pair of connected datagram sockets.
+ * The multi-interface test needs another interface, vcan1, which can be in either mode.
+ */
+
+#include <catch.hpp>
+#include <socketcan.h>
+#include <cerrno>
+#include <cstring>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ctime>
+#include <linux/can.h>
+#include <unistd.h>
+
+
+static const char* const TestIface = "vcan0";
+static const char* const SecondTestIface = "vcan1";
+
+static CanardCANFrame makeFrame(uint32_t id, uint8_t data_len, bool canfd, bool brs)
+{
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.data_len = data_len;
+    frame.canfd = canfd;
+    frame.brs = brs;
+    for (uint8_t i = 0; i < data_len; i++)
+    {
+        frame.data[i] = uint8_t(i + data_len);
+    }
+    return frame;
+}
+
+static bool ifaceExists(const char* name)
+{
+    return if_nametoindex(name) != 0;
+}
+
+static bool isTestIfaceFD()
+{
+    const int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct ifreq ifr;
+    std::memset(&ifr, 0, sizeof(ifr));
+    std::strncpy(ifr.ifr_name, TestIface, IFNAMSIZ - 1);
+    const bool is_fd = (ioctl(fd, SIOCGIFMTU, &ifr) == 0) && (ifr.ifr_mtu == CANFD_MTU);
+    (void)close(fd);
+    return is_fd;
+}
+
+static uint64_t getMonotonicTimestampUSec()
+{
+    struct timespec ts;
+    std::memset(&ts, 0, sizeof(ts));
+    REQUIRE(0 == clock_gettime(CLOCK_MONOTONIC, &ts));
+    return uint64_t(ts.tv_sec) * 1000000ULL + uint64_t(ts.tv_nsec) / 1000ULL;
+}
+
+static void checkEqual(const CanardCANFrame& a, const CanardCANFrame& b)
+{
+    REQUIRE(a.id == b.id);
+    REQUIRE(a.data_len == b.data_len);
+    REQUIRE(a.canfd == b.canfd);
+    REQUIRE(a.brs == b.brs);
+    REQUIRE(0 == std::memcmp(a.data, b.data, a.data_len));
+}
+
+/**
+ * Sends classic and FD frames through one socket and receives them with another.
+ */
+static void checkMixedFrames(SocketCANInstance* tx, SocketCANInstance* rx)
+{
+    const CanardCANFrame frames[] = {
+        makeFrame(0x1234567U | CANARD_CAN_FRAME_EFF, 8, false, false),
+        makeFrame(0x1234568U | CANARD_CAN_FRAME_EFF, 64, true, true),
+        makeFrame(0x123U, 3, false, false),
+        makeFrame(0x1234569U | CANARD_CAN_FRAME_EFF, 12, true, false),
+    };
+    const uint16_t num_frames = uint16_t(sizeof(frames) / sizeof(frames[0]));
+
+    REQUIRE(num_frames == socketcanTransmitBatch(tx, frames, num_frames, 1000));
+
+    CanardCANFrame received[num_frames];
+    uint16_t num_received = 0;
+    while (num_received < num_frames)
+    {
+        const int16_t res = socketcanReceiveBatch(rx, &received[num_received], nullptr,
+                                                  uint16_t(num_frames - num_received), 1000);
+        REQUIRE(res > 0);
+        num_received = uint16_t(num_received + res);
+    }
+    for (uint16_t i = 0; i < num_frames; i++)
+    {
+        checkEqual(frames[i], received[i]);
+    }
+
+    // Nothing else is expected
+    CanardCANFrame frame;
+    REQUIRE(0 == socketcanReceive(rx, &frame, 0));
+}
+
+
+TEST_CASE("SocketCAN, FDOnVirtualInterface")
+{
+    if (!isTestIfaceFD())
+    {
+        WARN("Interface " << TestIface << " does not exist or is not in CAN FD mode, skipping");
+        return;
+    }
+
+    SocketCANInstance tx;
+    SocketCANInstance rx;
+    REQUIRE(0 == socketcanInit(&tx, TestIface));
+    REQUIRE(0 == socketcanInit(&rx, TestIface));
+
+    checkMixedFrames(&tx, &rx);
+
+    // The transmitted frame is received back by the transmitting instance, timestamped on completion
+    REQUIRE(0 == socketcanEnableTransmitTimestamps(&tx, true));
+    const CanardCANFrame frame = makeFrame(0x1234567U | CANARD_CAN_FRAME_EFF, 32, true, true);
+    const uint64_t started_at = getMonotonicTimestampUSec();
+    REQUIRE(1 == socketcanTransmit(&tx, &frame, 1000));
+
+    CanardCANFrame received;
+    SocketCANFrameInfo info;
+    REQUIRE(1 == socketcanReceiveBatch(&tx, &received, &info, 1, 1000));
+    checkEqual(frame, received);
+    REQUIRE(info.transmitted);
+    REQUIRE(info.timestamp_usec >= started_at);
+    REQUIRE(info.timestamp_usec <= getMonotonicTimestampUSec());
+
+    REQUIRE(1 == socketcanReceiveBatch(&rx, &received, &info, 1, 1000));
+    checkEqual(frame, received);
+    REQUIRE(!info.transmitted);
+    REQUIRE(info.timestamp_usec >= started_at);
+
+    REQUIRE(0 == socketcanClose(&tx));
+    REQUIRE(0 == socketcanClose(&rx));
+}
+
+TEST_CASE("SocketCAN, MultiIfaceOnVirtualInterfaces")
+{
+    if (!ifaceExists(TestIface) || !ifaceExists(SecondTestIface))
+    {
+        WARN("Interfaces " << TestIface << " and " << SecondTestIface << " do not exist, skipping");
+        return;
+    }
+
+    const char* const iface_names[] = { TestIface, SecondTestIface };
+    SocketCANInstance multi;
+    SocketCANInstance single[2];
+    REQUIRE(0 == socketcanInitMultiIface(&multi, iface_names, 2));
+    REQUIRE(multi.num_ifaces == 2);
+    REQUIRE(0 == socketcanInit(&single[0], TestIface));
+    REQUIRE(0 == socketcanInit(&single[1], SecondTestIface));
+
+    // Transmission is routed by the interface mask
+    CanardCANFrame frames[3] = {
+        makeFrame(0x1000001U | CANARD_CAN_FRAME_EFF, 8, false, false),
+        makeFrame(0x1000002U | CANARD_CAN_FRAME_EFF, 8, false, false),
+        makeFrame(0x1000003U | CANARD_CAN_FRAME_EFF, 8, false, false),
+    };
+    frames[0].iface_mask = 1U;
+    frames[1].iface_mask = 2U;
+    frames[2].iface_mask = 3U;
+    REQUIRE(3 == socketcanTransmitBatch(&multi, frames, 3, 1000));
+
+    CanardCANFrame received[3];
+    REQUIRE(2 == socketcanReceiveBatch(&single[0], received, nullptr, 3, 1000));
+    REQUIRE(received[0].id == frames[0].id);
+    REQUIRE(received[1].id == frames[2].id);
+    REQUIRE(2 == socketcanReceiveBatch(&single[1], received, nullptr, 3, 1000));
+    REQUIRE(received[0].id == frames[1].id);
+    REQUIRE(received[1].id == frames[2].id);
+
+    // Reception reports the interface
+    REQUIRE(1 == socketcanTransmit(&single[1], &frames[1], 1000));
+    REQUIRE(1 == socketcanTransmit(&single[0], &frames[0], 1000));
+    uint16_t num_received = 0;
+    while (num_received < 2)
+    {
+        const int16_t res = socketcanReceiveBatch(&multi, &received[num_received], nullptr,
+                                                  uint16_t(2 - num_received), 1000);
+        REQUIRE(res > 0);
+        num_received = uint16_t(num_received + res);
+    }
+    for (uint16_t i = 0; i < 2; i++)
+    {
+        REQUIRE(received[i].iface_id == ((received[i].id == frames[1].id) ? 1U : 0U));
+    }
+
+    // All CAN interfaces
+    SocketCANInstance all;
+    REQUIRE(0 == socketcanInitMultiIface(&all, nullptr, 0));
+    REQUIRE(all.num_ifaces >= 2);
+
+    REQUIRE(0 == socketcanClose(&all));
+    REQUIRE(0 == socketcanClose(&multi));
+    REQUIRE(0 == socketcanClose(&single[0]));
+    REQUIRE(0 == socketcanClose(&single[1]));
+}
+
+TEST_CASE("SocketCAN, RingOnVirtualInterface")
+{
+    if (!isTestIfaceFD())
+    {
+        WARN("Interface " << TestIface << " does not exist or is not in CAN FD mode, skipping");
+        return;
+    }
+    SocketCANRingInstance ring;
+    const int16_t ring_result = socketcanRingInit(&ring, TestIface);
+    if (ring_result == -EPERM)
+    {
+        WARN("The ring needs the CAP_NET_RAW capability, skipping");
+        return;
+    }
+    REQUIRE(0 == ring_result);
+
+    SocketCANInstance tx;
+    REQUIRE(0 == socketcanInit(&tx, TestIface));
+    const CanardCANFrame frames[] = {
+        makeFrame(0x1234567U | CANARD_CAN_FRAME_EFF, 8, false, false),
+        makeFrame(0x1234568U | CANARD_CAN_FRAME_EFF, 64, true, true),
+        makeFrame(0x123U, 3, false, false),
+    };
+    const uint64_t started_at = getMonotonicTimestampUSec();
+    REQUIRE(3 == socketcanTransmitBatch(&tx, frames, 3, 1000));
+
+    // The frames transmitted by the host are seen once
+    CanardCANFrame received[4];
+    SocketCANFrameInfo infos[4];
+    uint16_t num_received = 0;
+    while (num_received < 3)
+    {
+        const int16_t res = socketcanRingReceiveBatch(&ring, &received[num_received], &infos[num_received],
+                                                      uint16_t(4 - num_received), 1000);
+        REQUIRE(res > 0);
+        num_received = uint16_t(num_received + res);
+    }
+    REQUIRE(num_received == 3);
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        checkEqual(frames[i], received[i]);
+        REQUIRE(infos[i].timestamp_usec >= started_at);
+        REQUIRE(infos[i].timestamp_usec <= getMonotonicTimestampUSec());
+    }
+    REQUIRE(0 == socketcanRingReceiveBatch(&ring, received, infos, 4, 10));
+
+    REQUIRE(0 == socketcanClose(&tx));
+    REQUIRE(0 == socketcanRingClose(&ring));
+}
+
+TEST_CASE("SocketCAN, RingOnLoopback")
+{
+    // No CAN interface is needed to check that everything else is kept out of the ring
+    SocketCANRingInstance ring;
+    REQUIRE(0 > socketcanRingInit(&ring, "nonexistent0"));
+    const int16_t ring_result = socketcanRingInit(&ring, "lo");
+    if (ring_result == -EPERM)
+    {
+        WARN("The ring needs the CAP_NET_RAW capability, skipping");
+        return;
+    }
+    REQUIRE(0 == ring_result);
+    REQUIRE(socketcanRingGetSocketFileDescriptor(&ring) >= 0);
+
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    REQUIRE(fd >= 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(9);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    // The Ethernet, IP and UDP headers make up a packet of the size of a CAN FD frame
+    const uint8_t payload[CANFD_MTU - 42U] = {};
+    for (int i = 0; i < 100; i++)
+    {
+        REQUIRE(ssize_t(sizeof(payload)) == sendto(fd, payload, sizeof(payload), 0,
+                                                   reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)));
+    }
+    REQUIRE(0 == close(fd));
+
+    CanardCANFrame received[4];
+    SocketCANFrameInfo infos[4];
+    REQUIRE(0 == socketcanRingReceiveBatch(&ring, received, infos, 4, 10));
+    REQUIRE(0 == socketcanRingReceiveBatch(&ring, received, nullptr, 4, 0));
+
+    REQUIRE(0 == socketcanRingClose(&ring));
+    REQUIRE(-1 == socketcanRingGetSocketFileDescriptor(&ring));
+}
+
+TEST_CASE("SocketCAN, Timestamps")
+{
+    int fds[2];
+    REQUIRE(0 == socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds));
+    SocketCANInstance tx = SocketCANInstance();
+    SocketCANInstance rx = SocketCANInstance();
+    tx.fd = fds[0];
+    rx.fd = fds[1];
+
+    const CanardCANFrame frames[] = {
+        makeFrame(0x1234567U | CANARD_CAN_FRAME_EFF, 8, false, false),
+        makeFrame(0x1234568U | CANARD_CAN_FRAME_EFF, 8, false, false),
+    };
+    CanardCANFrame received[2];
+    SocketCANFrameInfo infos[2];
+
+    // Without kernel timestamps the time of reception is reported
+    uint64_t started_at = getMonotonicTimestampUSec();
+    REQUIRE(1 == socketcanTransmit(&tx, &frames[0], 0));
+    REQUIRE(1 == socketcanReceiveBatch(&rx, received, infos, 2, 0));
+    REQUIRE(infos[0].timestamp_usec >= started_at);
+    REQUIRE(infos[0].timestamp_usec <= getMonotonicTimestampUSec());
+    REQUIRE(!infos[0].transmitted);
+
+    // Kernel timestamps are converted into the monotonic time base
+    const int enable = 1;
+    REQUIRE(0 == setsockopt(rx.fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)));
+    started_at = getMonotonicTimestampUSec();
+    REQUIRE(2 == socketcanTransmitBatch(&tx, frames, 2, 0));
+    const uint64_t sent_at = getMonotonicTimestampUSec();
+    (void)usleep(20000);
+    REQUIRE(2 == socketcanReceiveBatch(&rx, received, infos, 2, 0));
+    for (unsigned i = 0; i < 2; i++)
+    {
+        checkEqual(frames[i], received[i]);
+        REQUIRE(!infos[i].transmitted);
+        REQUIRE(infos[i].timestamp_usec + 1000U >= started_at);     // The clocks are not sampled atomically
+        REQUIRE(infos[i].timestamp_usec <= sent_at + 1000U);
+    }
+
+    REQUIRE(0 == socketcanClose(&tx));
+    REQUIRE(0 == socketcanClose(&rx));
+}
+
+TEST_CASE("SocketCAN, FDFrameFormat")
+{
+    // A datagram socket pair keeps the frame sizes, that is the MTUs, like a CAN socket does
+    int fds[2];
+    REQUIRE(0 == socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds));
+    SocketCANInstance tx = SocketCANInstance();
+    SocketCANInstance rx = SocketCANInstance();
+    tx.fd = fds[0];
+    rx.fd = fds[1];
+
+    checkMixedFrames(&tx, &rx);
+
+    // A classic frame is written with the classic MTU and the SocketCAN flags
+    const CanardCANFrame frame = makeFrame(0x1FFFFFFFU | CANARD_CAN_FRAME_EFF, 5, false, false);
+    REQUIRE(1 == socketcanTransmit(&tx, &frame, 0));
+    struct can_frame raw;
+    REQUIRE(CAN_MTU == read(rx.fd, &raw, sizeof(raw)));
+    REQUIRE(raw.can_id == (0x1FFFFFFFU | CAN_EFF_FLAG));
+    REQUIRE(raw.can_dlc == 5);
+
+    // Frames of invalid size are rejected
+    const uint8_t garbage[CAN_MTU + 1] = {};
+    REQUIRE(sizeof(garbage) == size_t(write(tx.fd, garbage, sizeof(garbage))));
+    CanardCANFrame received;
+    REQUIRE(-EIO == socketcanReceive(&rx, &received, 0));
+
+    REQUIRE(0 == socketcanClose(&tx));
+    REQUIRE(0 == socketcanClose(&rx));
+}
+
+TEST_CASE("SocketCAN, BitRateSwitchSetting")
+{
+    int fds[2];
+    REQUIRE(0 == socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds));
+    SocketCANInstance tx = SocketCANInstance();
+    tx.fd = fds[0];
+
+    static uint8_t memory_pool[1024];
+    CanardInstance ins;
+    canardInit(&ins, memory_pool, sizeof(memory_pool), nullptr, nullptr, nullptr);
+    canardSetLocalNodeID(&ins, 10);
+    const uint8_t payload[20] = {};
+    uint8_t transfer_id = 0;
+
+    // The bit rate switch is used by default, for CAN FD frames only
+    REQUIRE(1 == canardBroadcast(&ins, 0x1234U, 100, &transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM,
+                                 payload, sizeof(payload), 1U, true));
+    REQUIRE(1 == canardBroadcast(&ins, 0x1234U, 100, &transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM,
+                                 payload, 5, 1U, false));
+    canardSetCanFdBitRateSwitch(&ins, false);
+    REQUIRE(1 == canardBroadcast(&ins, 0x1234U, 100, &transfer_id, CANARD_TRANSFER_PRIORITY_MEDIUM,
+                                 payload, sizeof(payload), 1U, true));
+
+    const bool expected_canfd[3] = { true, false, true };
+    const bool expected_brs[3] = { true, false, false };
+    for (unsigned i = 0; i < 3; i++)
+    {
+        const CanardCANFrame* const frame = canardPeekTxQueue(&ins);
+        REQUIRE(frame != nullptr);
+        REQUIRE(frame->canfd == expected_canfd[i]);
+        REQUIRE(frame->brs == expected_brs[i]);
+        REQUIRE(1 == socketcanTransmit(&tx, frame, 0));
+        canardPopTxQueue(&ins);
+
+        if (expected_canfd[i])
+        {
+            struct canfd_frame raw;
+            REQUIRE(CANFD_MTU == read(fds[1], &raw, sizeof(raw)));
+            REQUIRE(((raw.flags & CANFD_BRS) != 0) == expected_brs[i]);
+        }
+        else
+        {
+            struct can_frame raw;
+            REQUIRE(CAN_MTU == read(fds[1], &raw, sizeof(raw)));
+        }
+    }
+    REQUIRE(canardPeekTxQueue(&ins) == nullptr);
+
+    REQUIRE(0 == socketcanClose(&tx));
+    REQUIRE(0 == close(fds[1]));
+}
+
+struct LoopNode
+{
+    CanardInstance canard;
+    uint8_t memory_pool[1024];
+    unsigned num_received;
+    uint64_t last_timestamp_usec;
+    uint8_t last_source_node_id;
+};
+
+static void onLoopReception(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    LoopNode* const node = static_cast<LoopNode*>(canardGetUserReference(ins));
+    node->num_received++;
+    node->last_timestamp_usec = transfer->timestamp_usec;
+    node->last_source_node_id = transfer->source_node_id;
+}
+
+static bool shouldAcceptLoop(const CanardInstance*, uint64_t* out_data_type_signature, uint16_t data_type_id,
+                             CanardTransferType transfer_type, uint8_t)
+{
+    *out_data_type_signature = 0;
+    return (data_type_id == 100U) && (transfer_type == CanardTransferTypeBroadcast);
+}
+
+/**
+ * Two buses over datagram socket pairs: the loop serves one end of each pair, the test the other one.
+ */
+static void checkLoop(bool allow_io_uring)
+{
+    SocketCANLoop loop;
+    REQUIRE(0 == socketcanLoopInit(&loop, allow_io_uring));
+    if (allow_io_uring && !socketcanLoopUsesIOUring(&loop))
+    {
+        WARN("io_uring is not usable, the loop falls back to poll()");
+    }
+
+    static LoopNode nodes[2];
+    SocketCANInstance instances[2];
+    int peers[2];
+    for (unsigned i = 0; i < 2; i++)
+    {
+        int fds[2];
+        REQUIRE(0 == socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds));
+        instances[i] = SocketCANInstance();
+        instances[i].fd = fds[0];
+        peers[i] = fds[1];
+        std::memset(&nodes[i], 0, sizeof(nodes[i]));
+        canardInit(&nodes[i].canard, nodes[i].memory_pool, sizeof(nodes[i].memory_pool),
+                   onLoopReception, shouldAcceptLoop, &nodes[i]);
+        canardSetLocalNodeID(&nodes[i].canard, uint8_t(10 + i));
+        REQUIRE(0 == socketcanLoopAddBus(&loop, &instances[i], &nodes[i].canard));
+    }
+
+    // A multi-frame transfer on the first bus and a single frame one on the second bus
+    const uint8_t payload[20] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+    uint8_t transfer_ids[2] = { 0, 0 };
+    REQUIRE(4 == canardBroadcast(&nodes[0].canard, 0x1234U, 100, &transfer_ids[0], CANARD_TRANSFER_PRIORITY_MEDIUM,
+                                 payload, sizeof(payload), 1U, false));
+    REQUIRE(1 == canardBroadcast(&nodes[1].canard, 0x1234U, 100, &transfer_ids[1], CANARD_TRANSFER_PRIORITY_MEDIUM,
+                                 payload, 5, 1U, false));
+
+    const unsigned expected_frames[2] = { 4, 1 };
+    unsigned num_frames[2] = { 0, 0 };
+    for (unsigned iteration = 0; (iteration < 100) && ((num_frames[0] < 4) || (num_frames[1] < 1)); iteration++)
+    {
+        REQUIRE(socketcanLoopRunOnce(&loop, 10) >= 0);
+        for (unsigned i = 0; i < 2; i++)
+        {
+            struct can_frame raw;
+            while (read(peers[i], &raw, sizeof(raw)) == CAN_MTU)
+            {
+                const uint8_t tail = raw.data[raw.can_dlc - 1U];
+                REQUIRE(((tail & 0x80U) != 0) == (num_frames[i] == 0));                     // Start of transfer
+                REQUIRE(((tail & 0x40U) != 0) == (num_frames[i] + 1U == expected_frames[i])); // End of transfer
+                REQUIRE(((tail & 0x20U) != 0) == ((num_frames[i] % 2U) == 1U));             // Toggle
+                REQUIRE((raw.can_id & CAN_EFF_MASK & 0x7FU) == 10U + i);
+                num_frames[i]++;
+            }
+        }
+    }
+    REQUIRE(num_frames[0] == 4);
+    REQUIRE(num_frames[1] == 1);
+    REQUIRE(canardPeekTxQueue(&nodes[0].canard) == nullptr);
+
+    // A frame written to the second bus is received by the second node only
+    struct can_frame raw;
+    std::memset(&raw, 0, sizeof(raw));
+    raw.can_id = CAN_EFF_FLAG | (16U << 24U) | (100U << 8U) | 42U;
+    raw.can_dlc = 3;
+    raw.data[0] = 0xAA;
+    raw.data[1] = 0xBB;
+    raw.data[2] = 0xC0;                 // Single frame transfer, ID 0
+    const uint64_t started_at = getMonotonicTimestampUSec();
+    REQUIRE(CAN_MTU == write(peers[1], &raw, CAN_MTU));
+
+    int16_t num_handled = 0;
+    for (unsigned iteration = 0; (iteration < 100) && (num_handled == 0); iteration++)
+    {
+        num_handled = socketcanLoopRunOnce(&loop, 10);
+        REQUIRE(num_handled >= 0);
+    }
+    REQUIRE(num_handled == 1);
+    REQUIRE(nodes[0].num_received == 0);
+    REQUIRE(nodes[1].num_received == 1);
+    REQUIRE(nodes[1].last_source_node_id == 42);
+    REQUIRE(nodes[1].last_timestamp_usec >= started_at);
+    REQUIRE(nodes[1].last_timestamp_usec <= getMonotonicTimestampUSec());
+
+    // Nothing else happens
+    REQUIRE(0 == socketcanLoopRunOnce(&loop, 10));
+
+    // Without events the loop sleeps until the deadline
+    uint64_t wake_at = getMonotonicTimestampUSec() + 20000U;
+    REQUIRE(0 == socketcanLoopRunUntil(&loop, wake_at));
+    uint64_t woke_at = getMonotonicTimestampUSec();
+    REQUIRE(woke_at >= wake_at);
+    REQUIRE(woke_at < wake_at + 200000U);
+
+    // The loop wakes up for the library deadline and removes the stale transfer state
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.id = CANARD_CAN_FRAME_EFF | (16U << 24U) | (100U << 8U) | 43U;
+    frame.data_len = 1;
+    frame.data[0] = 0xC0;
+    REQUIRE(0 == canardHandleRxFrame(&nodes[0].canard, &frame, getMonotonicTimestampUSec() - 1980000U));
+    wake_at = canardGetNextDeadline(&nodes[0].canard);
+    REQUIRE(wake_at < getMonotonicTimestampUSec() + 20000U);
+    REQUIRE(0 == socketcanLoopRunUntil(&loop, UINT64_MAX));
+    woke_at = getMonotonicTimestampUSec();
+    REQUIRE(woke_at >= wake_at);
+    REQUIRE(woke_at < wake_at + 200000U);
+    REQUIRE(canardGetNextDeadline(&nodes[0].canard) == UINT64_MAX);
+
+    REQUIRE(0 == socketcanLoopClose(&loop));
+    for (unsigned i = 0; i < 2; i++)
+    {
+        REQUIRE(0 == socketcanClose(&instances[i]));
+        REQUIRE(0 == close(peers[i]));
+    }
+}
+
+TEST_CASE("SocketCAN, Loop")
+{
+    checkLoop(true);
+    checkLoop(false);
+}
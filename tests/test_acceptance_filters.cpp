@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+#include <catch.hpp>
+#include <cstdlib>
+#include "canard_internals.h"
+
+static const CanardAcceptedTransfer* g_accepted_transfers = nullptr;
+static uint16_t g_num_accepted_transfers = 0;
+
+static void onTransferReceived(CanardInstance*, CanardRxTransfer*)
+{
+}
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t*,
+                                 uint16_t data_type_id,
+                                 CanardTransferType transfer_type,
+                                 uint8_t)
+{
+    for (uint16_t i = 0; i < g_num_accepted_transfers; i++)
+    {
+        if ((g_accepted_transfers[i].data_type_id == data_type_id) &&
+            (g_accepted_transfers[i].transfer_type == transfer_type))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isAccepted(const CanardAcceptanceFilter* filters, int16_t num_filters, uint32_t id)
+{
+    for (int16_t i = 0; i < num_filters; i++)
+    {
+        if ((id & filters[i].mask) == (filters[i].id & filters[i].mask))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Feeds random single frame transfers to the library and compares its verdict with the filters.
+ * The frames that the library wants must always pass; if exact is set, the unwanted ones must not pass either.
+ */
+static void checkAgainstLibrary(const CanardAcceptedTransfer* accepted_transfers,
+                                uint16_t num_accepted_transfers,
+                                uint8_t local_node_id,
+                                const CanardAcceptanceFilter* filters,
+                                int16_t num_filters,
+                                bool exact)
+{
+    uint8_t canard_memory_pool[1024];
+    CanardInstance canard;
+    canardInit(&canard, canard_memory_pool, sizeof(canard_memory_pool),
+               onTransferReceived, shouldAcceptTransfer, nullptr);
+    if (local_node_id != CANARD_BROADCAST_NODE_ID)
+    {
+        canardSetLocalNodeID(&canard, local_node_id);
+    }
+    g_accepted_transfers = accepted_transfers;
+    g_num_accepted_transfers = num_accepted_transfers;
+
+    std::srand(42);
+    unsigned num_wanted = 0;
+    for (unsigned i = 0; i < 50000; i++)
+    {
+        // Random IDs would almost never hit the accepted data types, so half of them reuse the accepted ones
+        uint32_t id = (uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16U)) & CANARD_CAN_EXT_ID_MASK;
+        if ((i % 2U) == 0)
+        {
+            const CanardAcceptedTransfer& tr = accepted_transfers[i / 2U % num_accepted_transfers];
+            if (tr.transfer_type == CanardTransferTypeBroadcast)
+            {
+                id = (id & ~0xFFFF80U) | (uint32_t(tr.data_type_id) << 8U);
+                if ((i % 8U) == 0)
+                {
+                    id &= ~0x7FU;               // Anonymous
+                }
+            }
+            else
+            {
+                id = (id & ~0xFF8080U) | (uint32_t(tr.data_type_id) << 16U) | 0x80U;
+                id |= (tr.transfer_type == CanardTransferTypeRequest) ? 0x8000U : 0U;
+                if ((i % 4U) == 0)
+                {
+                    id = (id & ~0x7F00U) | (uint32_t(local_node_id) << 8U);
+                }
+            }
+        }
+        id |= CANARD_CAN_FRAME_EFF;
+
+        CanardCANFrame frame = CanardCANFrame();
+        frame.id = id;
+        frame.data[0] = uint8_t(0xC0U | (i & 31U));
+        frame.data_len = 1;
+        const int16_t result = canardHandleRxFrame(&canard, &frame, i);
+        if ((local_node_id == CANARD_BROADCAST_NODE_ID) && ((id & 0x80U) != 0))
+        {
+            continue;       // An anonymous node takes service frames addressed to node 0, which cannot exist
+        }
+        const bool wanted = (result != -CANARD_ERROR_RX_NOT_WANTED) && (result != -CANARD_ERROR_RX_WRONG_ADDRESS);
+        if (wanted)
+        {
+            num_wanted++;
+            REQUIRE(isAccepted(filters, num_filters, id));
+        }
+        else if (exact && ((id & 0x7FU) != 0))      // Anonymous frames also pass the non-anonymous filters
+        {
+            REQUIRE(!isAccepted(filters, num_filters, id));
+        }
+    }
+    REQUIRE(num_wanted > 1000);
+}
+
+TEST_CASE("AcceptanceFilters, Exact")
+{
+    const CanardAcceptedTransfer accepted[] = {
+        { 341, CanardTransferTypeBroadcast },       // NodeStatus
+        { 1, CanardTransferTypeBroadcast },         // Allocation, also anonymous
+        { 1, CanardTransferTypeRequest },           // GetNodeInfo
+        { 11, CanardTransferTypeResponse },
+        { 341, CanardTransferTypeBroadcast },       // Duplicates need no filters
+    };
+    CanardAcceptanceFilter filters[14];
+
+    const int16_t num_filters = canardComputeAcceptanceFilters(accepted, 5, 42, filters, 14);
+    REQUIRE(num_filters == 5);
+    checkAgainstLibrary(accepted, 5, 42, filters, num_filters, true);
+
+    // Standard and RTR frames never pass
+    REQUIRE(isAccepted(filters, num_filters, CANARD_CAN_FRAME_EFF | (341U << 8U) | 10U));
+    REQUIRE(!isAccepted(filters, num_filters, (341U << 8U) | 10U));
+    REQUIRE(!isAccepted(filters, num_filters, CANARD_CAN_FRAME_RTR | CANARD_CAN_FRAME_EFF | (341U << 8U) | 10U));
+
+    // Anonymous nodes cannot receive service transfers
+    REQUIRE(3 == canardComputeAcceptanceFilters(accepted, 5, CANARD_BROADCAST_NODE_ID, filters, 14));
+    checkAgainstLibrary(accepted, 5, CANARD_BROADCAST_NODE_ID, filters, 3, true);
+
+    // Nothing accepted, nothing passes
+    REQUIRE(0 == canardComputeAcceptanceFilters(nullptr, 0, 42, nullptr, 0));
+}
+
+TEST_CASE("AcceptanceFilters, Budget")
+{
+    CanardAcceptedTransfer accepted[40];
+    for (uint16_t i = 0; i < 20; i++)
+    {
+        accepted[i].data_type_id = uint16_t(20000U + i);
+        accepted[i].transfer_type = CanardTransferTypeBroadcast;
+        accepted[20U + i].data_type_id = uint16_t(100U + i * 7U);
+        accepted[20U + i].transfer_type = (i % 2U) ? CanardTransferTypeRequest : CanardTransferTypeResponse;
+    }
+
+    for (uint8_t max_filters = 1; max_filters <= 40; max_filters++)
+    {
+        CanardAcceptanceFilter filters[40];
+        const int16_t num_filters = canardComputeAcceptanceFilters(accepted, 40, 127, filters, max_filters);
+        REQUIRE(num_filters == max_filters);
+        checkAgainstLibrary(accepted, 40, 127, filters, num_filters, max_filters == 40);
+
+        // Each additional filter lets fewer unwanted IDs through
+        uint64_t num_passing = 0;
+        for (int16_t i = 0; i < num_filters; i++)
+        {
+            num_passing += countAcceptedIDs(filters[i]);
+        }
+        if (max_filters == 1)
+        {
+            REQUIRE(num_passing < (1ULL << 29U));
+        }
+        if (max_filters == 40)
+        {
+            REQUIRE(num_passing == 40ULL * countAcceptedIDs(filters[0]));
+        }
+    }
+}
+
+TEST_CASE("AcceptanceFilters, Merging")
+{
+    CanardAcceptanceFilter a = { CANARD_CAN_FRAME_EFF | 0x1200U, CANARD_CAN_FRAME_EFF | 0xFF00U };
+    CanardAcceptanceFilter b = { CANARD_CAN_FRAME_EFF | 0x1300U, CANARD_CAN_FRAME_EFF | 0xFF00U };
+    const CanardAcceptanceFilter merged = mergeAcceptanceFilters(a, b);
+    REQUIRE(merged.id == (CANARD_CAN_FRAME_EFF | 0x1200U));
+    REQUIRE(merged.mask == (CANARD_CAN_FRAME_EFF | 0xFE00U));
+    REQUIRE(countAcceptedIDs(a) == (1U << 21U));
+    REQUIRE(countAcceptedIDs(merged) == (1U << 22U));
+
+    // The cheapest pair is merged once the set is full
+    CanardAcceptanceFilter filters[2] = { a, { CANARD_CAN_FRAME_EFF | 0x8000U, CANARD_CAN_FRAME_EFF | 0xFF00U } };
+    uint8_t num_filters = 2;
+    addAcceptanceFilter(filters, &num_filters, 2, b);
+    REQUIRE(num_filters == 2);
+    REQUIRE(filters[0].id == merged.id);
+    REQUIRE(filters[0].mask == merged.mask);
+    REQUIRE(filters[1].id == (CANARD_CAN_FRAME_EFF | 0x8000U));
+
+    // A filter that is covered by an existing one is not added
+    addAcceptanceFilter(filters, &num_filters, 3, b);
+    REQUIRE(num_filters == 2);
+}
+
+TEST_CASE("AcceptanceFilters, InvalidArguments")
+{
+    const CanardAcceptedTransfer accepted[] = {
+        { 341, CanardTransferTypeBroadcast },
+        { 256, CanardTransferTypeRequest },         // Service data type IDs are 8 bit wide
+    };
+    CanardAcceptanceFilter filters[4];
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardComputeAcceptanceFilters(accepted, 1, 42, filters, 0));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardComputeAcceptanceFilters(accepted, 1, 42, nullptr, 4));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardComputeAcceptanceFilters(nullptr, 1, 42, filters, 4));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardComputeAcceptanceFilters(accepted, 1, 128, filters, 4));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardComputeAcceptanceFilters(accepted, 2, 42, filters, 4));
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+#include "test_helpers.hpp"
+#include <cstdlib>
+#include <set>
+
+#if CANARD_ENABLE_CUSTOM_ALLOCATOR
+
+/**
+ * Heap allocator that keeps track of its blocks and can be limited to a number of blocks.
+ */
+struct TestAllocator
+{
+    CanardMemoryAllocator base;
+    std::set<void*> blocks;
+    size_t max_blocks = 1000;
+    size_t max_requested_size = 0;
+
+    TestAllocator()
+    {
+        base.allocate = [](CanardMemoryAllocator* self, size_t size) -> void*
+        {
+            TestAllocator* const allocator = reinterpret_cast<TestAllocator*>(self);
+            allocator->max_requested_size = std::max(allocator->max_requested_size, size);
+            if (allocator->blocks.size() >= allocator->max_blocks)
+            {
+                return nullptr;
+            }
+            void* const p = std::malloc(size);
+            allocator->blocks.insert(p);
+            return p;
+        };
+        base.deallocate = [](CanardMemoryAllocator* self, void* pointer)
+        {
+            TestAllocator* const allocator = reinterpret_cast<TestAllocator*>(self);
+            REQUIRE(1 == allocator->blocks.erase(pointer));
+            std::free(pointer);
+        };
+    }
+};
+
+static void storePayloadLength(CanardInstance* ins, CanardRxTransfer* transfer)
+{
+    *static_cast<uint16_t*>(canardGetUserReference(ins)) = transfer->payload_len;
+}
+
+TEST_CASE("CustomAllocator, Transfers")
+{
+    TestAllocator tx_allocator;
+    TestAllocator rx_allocator;
+    uint16_t received_len = 0;
+    CanardInstance tx;
+    CanardInstance rx;
+    canardInit(&tx, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardInit(&rx, nullptr, 0, storePayloadLength, shouldAcceptTransfer, &received_len);
+    REQUIRE(0 == canardSetMemoryAllocator(&tx, &tx_allocator.base));
+    REQUIRE(0 == canardSetMemoryAllocator(&rx, &rx_allocator.base));
+    canardSetLocalNodeID(&tx, 10);
+    canardSetLocalNodeID(&rx, 20);
+
+    const uint8_t payload[100] = {};
+    uint8_t transfer_id = 0;
+    const int16_t num_frames = canardBroadcast(&tx, DataTypeSignature, DataTypeID, &transfer_id,
+                                               CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload));
+    REQUIRE(num_frames > 1);
+    REQUIRE(size_t(num_frames) == tx_allocator.blocks.size());
+    REQUIRE(CANARD_POOL_MAX_BLOCKS == canardGetPoolAllocatorStatistics(&tx).capacity_blocks);
+    REQUIRE(CanardPoolBlockCount(num_frames) == canardGetPoolAllocatorStatistics(&tx).current_usage_blocks);
+
+    uint64_t timestamp = 1000;
+    for (const CanardCANFrame* frame = canardPeekTxQueue(&tx); frame != nullptr; frame = canardPeekTxQueue(&tx))
+    {
+        REQUIRE(0 == canardHandleRxFrame(&rx, frame, timestamp++));
+        canardPopTxQueue(&tx);
+    }
+    REQUIRE(sizeof(payload) == received_len);
+    REQUIRE(tx_allocator.blocks.empty());
+    REQUIRE(tx_allocator.max_requested_size <= CANARD_MEM_BLOCK_SIZE);
+    REQUIRE(rx_allocator.max_requested_size <= CANARD_MEM_BLOCK_SIZE);
+
+    // The RX state is kept after the transfer, the payload buffers are released
+    REQUIRE(1 == rx_allocator.blocks.size());
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&rx);
+    REQUIRE(1 == stats.current_usage_blocks);
+    REQUIRE(stats.peak_usage_blocks > 1);
+
+    canardCleanupStaleTransfers(&rx, timestamp + 10000000U);
+    REQUIRE(rx_allocator.blocks.empty());
+    REQUIRE(0 == canardGetPoolAllocatorStatistics(&rx).current_usage_blocks);
+}
+
+TEST_CASE("CustomAllocator, OutOfMemory")
+{
+    TestAllocator allocator;
+    allocator.max_blocks = 2;
+    CanardInstance ins;
+    canardInit(&ins, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+    REQUIRE(0 == canardSetMemoryAllocator(&ins, &allocator.base));
+    canardSetLocalNodeID(&ins, 10);
+
+    const uint8_t payload[7] = {};
+    uint8_t transfer_id = 0;
+    REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, sizeof(payload)));
+    REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, sizeof(payload)));
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                                           CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload)));
+#if CANARD_ENABLE_POOL_QUOTAS
+    REQUIRE(1 == canardGetPoolAllocatorStatistics(&ins).categories[CanardPoolCategoryTx].failed_allocations);
+#endif
+
+    while (canardPeekTxQueue(&ins) != nullptr)
+    {
+        canardPopTxQueue(&ins);
+    }
+    REQUIRE(allocator.blocks.empty());
+}
+
+TEST_CASE("CustomAllocator, InvalidArguments")
+{
+    static uint64_t arena[(16U * CANARD_MEM_BLOCK_SIZE) / 8U];
+    TestAllocator allocator;
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 10);
+
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSetMemoryAllocator(&ins, nullptr));
+    CanardMemoryAllocator incomplete = allocator.base;
+    incomplete.deallocate = nullptr;
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSetMemoryAllocator(&ins, &incomplete));
+
+    // The instance cannot switch allocators while it holds blocks of the pool
+    const uint8_t payload[7] = {};
+    uint8_t transfer_id = 0;
+    REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, sizeof(payload)));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSetMemoryAllocator(&ins, &allocator.base));
+    canardPopTxQueue(&ins);
+    REQUIRE(0 == canardSetMemoryAllocator(&ins, &allocator.base));
+    REQUIRE(allocator.blocks.empty());
+}
+
+#endif
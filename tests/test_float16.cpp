@@ -61,3 +61,43 @@ TEST_CASE("Float16, BackAndForth")
         x += 0.5F;
     }
 }
+
+
+TEST_CASE("Float16, Arrays")
+{
+    // Odd length, so that the hardware accelerated path (if any) is followed by the scalar path
+    static const size_t Count = 203;
+    float values[Count];
+    for (size_t i = 0; i < Count; i++)
+    {
+        values[i] = (float(i) - 100.0F) * 0.37F;
+    }
+    values[0] = std::nanf("");
+    values[1] = 999999.0F;
+    values[2] = -65519.0F;
+
+    uint16_t halfs[Count];
+    canardConvertNativeFloatArrayToFloat16(values, halfs, Count);
+    REQUIRE(0b0111110000000000 == (halfs[0] & 0b0111110000000000));   // nan, the payload may differ
+    REQUIRE(0 != (halfs[0] & 0b0000001111111111));
+    REQUIRE(0b0111110000000000 == halfs[1]);                            // +inf
+    REQUIRE(0b1111101111111111 == halfs[2]);                            // -max
+    for (size_t i = 3; i < Count; i++)
+    {
+        REQUIRE(canardConvertNativeFloatToFloat16(values[i]) == halfs[i]);
+    }
+
+    float back[Count];
+    canardConvertFloat16ArrayToNativeFloat(halfs, back, Count);
+    REQUIRE(bool(std::isnan(back[0])));
+    REQUIRE(std::isinf(back[1]));
+    for (size_t i = 2; i < Count; i++)
+    {
+        REQUIRE(canardConvertFloat16ToNativeFloat(halfs[i]) == Approx(back[i]));
+        REQUIRE(values[i] == Approx(back[i]).epsilon(0.001));
+    }
+
+    // Empty arrays are allowed
+    canardConvertNativeFloatArrayToFloat16(nullptr, nullptr, 0);
+    canardConvertFloat16ArrayToNativeFloat(nullptr, nullptr, 0);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+/*
+ * Fixture shared by the tests of the optional features: one broadcast data type, the callbacks of an instance that
+ * receives it, and a generator instance that turns a transfer into frames for the instance under test.
+ */
+
+#ifndef CANARD_TEST_HELPERS_HPP
+#define CANARD_TEST_HELPERS_HPP
+
+#include <catch.hpp>
+#include <canard.h>
+
+
+static const uint64_t DataTypeSignature = 0x0123456789ABCDEFULL;
+static const uint16_t DataTypeID = 1000;
+
+/**
+ * Counts the received transfers in the unsigned integer that the user reference of the instance points to, if any.
+ */
+inline void onTransferReceived(CanardInstance* ins, CanardRxTransfer*)
+{
+    unsigned* const num_received = static_cast<unsigned*>(canardGetUserReference(ins));
+    if (num_received != nullptr)
+    {
+        (*num_received)++;
+    }
+}
+
+/**
+ * Accepts the transfers of DataTypeID.
+ */
+inline bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t data_type_id,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    *out_data_type_signature = DataTypeSignature;
+    return data_type_id == DataTypeID;
+}
+
+/**
+ * Broadcasts a transfer of payload_len zero bytes from the given node with a generator instance and passes its
+ * classic frames to the receiver; if incomplete is set, the last frame is not passed.
+ * Returns the first error, or zero.
+ */
+inline int16_t receiveTransfer(CanardInstance* rx, uint8_t source_node_id, uint8_t priority,
+                               uint16_t payload_len, bool incomplete, uint64_t timestamp_usec)
+{
+    static uint64_t generator_arena[(64U * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance generator;
+    canardInit(&generator, generator_arena, sizeof(generator_arena), onTransferReceived, shouldAcceptTransfer,
+               nullptr);
+    canardSetLocalNodeID(&generator, source_node_id);
+
+    uint8_t payload[256] = {};
+    uint8_t transfer_id = 0;
+    REQUIRE(payload_len <= sizeof(payload));
+    REQUIRE(canardBroadcast(&generator, DataTypeSignature, DataTypeID, &transfer_id, priority,
+                            payload, payload_len
+#if CANARD_ENABLE_CANFD
+                            , false
+#endif
+                            ) > 0);
+
+    int16_t result = 0;
+    for (const CanardCANFrame* frame = canardPeekTxQueue(&generator);
+         frame != nullptr;
+         frame = canardPeekTxQueue(&generator))
+    {
+        const bool end_of_transfer = (frame->data[frame->data_len - 1U] & 0x40U) != 0;
+        if ((!end_of_transfer || !incomplete) && (result == 0))
+        {
+            const int16_t res = canardHandleRxFrame(rx, frame, timestamp_usec);
+            result = (res < 0) ? res : 0;
+        }
+        canardPopTxQueue(&generator);
+    }
+    return result;
+}
+
+#endif
@@ -52,5 +52,5 @@ TEST_CASE("Init, UserReference")
                &shouldAcceptTransferMock,
                reinterpret_cast<void*>(12345));
 
-    REQUIRE(12345 == reinterpret_cast<int>(canardGetUserReference(&ins)));
+    REQUIRE(12345 == reinterpret_cast<std::uintptr_t>(canardGetUserReference(&ins)));
 }
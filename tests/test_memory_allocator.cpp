@@ -23,6 +23,7 @@
  */
 
 #include <catch.hpp>
+#include <vector>
 #include "canard_internals.h"
 
 
@@ -106,3 +107,47 @@ TEST_CASE("MemoryAllocatorTestGroup, CanFreeBlock")
     REQUIRE(0 ==                allocator.statistics.current_usage_blocks);
     REQUIRE(1 ==                allocator.statistics.peak_usage_blocks);
 }
+
+#if CANARD_ENABLE_LARGE_POOL
+
+TEST_CASE("MemoryAllocatorTestGroup, LargeArena")
+{
+    // 8 MiB is well beyond the 65535 block limit of the 16-bit pool
+    static const size_t ArenaSize = 8U * 1024U * 1024U;
+    static const size_t NumBlocks = ArenaSize / CANARD_MEM_BLOCK_SIZE;
+    REQUIRE(NumBlocks > 0xFFFFU);
+
+    std::vector<CanardPoolAllocatorBlock> arena(NumBlocks);
+    CanardInstance ins;
+    canardInit(&ins, &arena[0], ArenaSize, NULL, NULL, NULL);
+
+    CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(NumBlocks == stats.capacity_blocks);
+    REQUIRE(0 ==         stats.current_usage_blocks);
+    REQUIRE(0 ==         stats.peak_usage_blocks);
+
+    // Every block of the arena can be allocated
+    std::vector<void*> blocks;
+    for (void* block = allocateBlock(&ins.allocator); block != NULL; block = allocateBlock(&ins.allocator))
+    {
+        REQUIRE(block >= static_cast<void*>(&arena.front()));
+        REQUIRE(block <= static_cast<void*>(&arena.back()));
+        blocks.push_back(block);
+    }
+    REQUIRE(NumBlocks == blocks.size());
+
+    stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(NumBlocks == stats.current_usage_blocks);
+    REQUIRE(NumBlocks == stats.peak_usage_blocks);
+
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        freeBlock(&ins.allocator, blocks[i]);
+    }
+
+    stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(0 ==         stats.current_usage_blocks);
+    REQUIRE(NumBlocks == stats.peak_usage_blocks);
+}
+
+#endif
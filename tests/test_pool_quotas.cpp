@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+#include "test_helpers.hpp"
+
+#if CANARD_ENABLE_POOL_QUOTAS
+
+static const size_t NumPoolBlocks = 64;
+
+TEST_CASE("PoolQuotas, CategoryStatistics")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+
+    const uint8_t payload[20] = {};
+    uint8_t transfer_id = 0;
+    REQUIRE(4 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, sizeof(payload)));
+    REQUIRE(0 == receiveTransfer(&ins, 30, CANARD_TRANSFER_PRIORITY_LOW, 100, true, 1000));
+
+    CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+    const CanardPoolBlockCount rx_payload_blocks = stats.categories[CanardPoolCategoryRxPayload].current_usage_blocks;
+    REQUIRE(4 == stats.categories[CanardPoolCategoryTx].current_usage_blocks);
+    REQUIRE(1 == stats.categories[CanardPoolCategoryRxState].current_usage_blocks);
+    REQUIRE(rx_payload_blocks > 0);
+    REQUIRE(5U + rx_payload_blocks == stats.current_usage_blocks);
+
+    while (canardPeekTxQueue(&ins) != nullptr)
+    {
+        canardPopTxQueue(&ins);
+    }
+    canardCleanupStaleTransfers(&ins, 100000000);
+
+    stats = canardGetPoolAllocatorStatistics(&ins);
+    for (uint8_t i = 0; i < CANARD_POOL_NUM_CATEGORIES; i++)
+    {
+        REQUIRE(0 == stats.categories[i].current_usage_blocks);
+        REQUIRE(0 == stats.categories[i].failed_allocations);
+    }
+    REQUIRE(4 == stats.categories[CanardPoolCategoryTx].peak_usage_blocks);
+    REQUIRE(1 == stats.categories[CanardPoolCategoryRxState].peak_usage_blocks);
+    REQUIRE(rx_payload_blocks == stats.categories[CanardPoolCategoryRxPayload].peak_usage_blocks);
+    REQUIRE(0 == stats.current_usage_blocks);
+}
+
+TEST_CASE("PoolQuotas, ReservationProtectsTx")
+{
+    static const CanardPoolBlockCount TxReserve = 8;
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 20);
+    REQUIRE(0 == canardSetPoolQuota(&ins, CanardPoolCategoryTx, TxReserve, CANARD_POOL_MAX_BLOCKS));
+
+    // A flood of incoming transfers from many nodes runs out of memory, but never touches the reserve
+    int num_failures = 0;
+    for (uint8_t node_id = 30; node_id < 60; node_id++)
+    {
+        const int16_t res = receiveTransfer(&ins, node_id, CANARD_TRANSFER_PRIORITY_LOW, 200, true, 1000);
+        if (res == -CANARD_ERROR_OUT_OF_MEMORY)
+        {
+            num_failures++;
+        }
+    }
+    REQUIRE(num_failures > 0);
+
+    CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(stats.peak_usage_blocks == stats.capacity_blocks - TxReserve);
+    REQUIRE(stats.categories[CanardPoolCategoryRxState].failed_allocations +
+            stats.categories[CanardPoolCategoryRxPayload].failed_allocations > 0);
+    REQUIRE(0 == stats.categories[CanardPoolCategoryTx].current_usage_blocks);
+
+    // The reserved blocks are left for the own publications
+    const uint8_t payload[7] = {};
+    uint8_t transfer_id = 0;
+    const CanardPoolBlockCount free_blocks = stats.capacity_blocks - stats.current_usage_blocks;
+    for (CanardPoolBlockCount i = 0; i < free_blocks; i++)
+    {
+        REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                     payload, sizeof(payload)));
+    }
+    REQUIRE(free_blocks >= TxReserve);
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                                           CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload)));
+    stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(1 == stats.categories[CanardPoolCategoryTx].failed_allocations);
+}
+
+TEST_CASE("PoolQuotas, CapLimitsRxPayload")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    REQUIRE(0 == canardSetPoolQuota(&ins, CanardPoolCategoryRxPayload, 0, 3));
+
+    // A small transfer fits the cap, a large one does not
+    REQUIRE(0 == receiveTransfer(&ins, 30, CANARD_TRANSFER_PRIORITY_LOW, 40, true, 1000));
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == receiveTransfer(&ins, 31, CANARD_TRANSFER_PRIORITY_LOW, 200, true, 1000));
+
+    const CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&ins);
+    REQUIRE(3 == stats.categories[CanardPoolCategoryRxPayload].peak_usage_blocks);
+    REQUIRE(1 == stats.categories[CanardPoolCategoryRxPayload].failed_allocations);
+    REQUIRE(2 == stats.categories[CanardPoolCategoryRxState].current_usage_blocks);
+    REQUIRE(stats.current_usage_blocks < stats.capacity_blocks - 3U);
+}
+
+TEST_CASE("PoolQuotas, InvalidQuotas")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSetPoolQuota(&ins, CanardPoolCategoryTx, 10, 9));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSetPoolQuota(&ins, CanardPoolCategory(CANARD_POOL_NUM_CATEGORIES),
+                                                                 0, 10));
+
+    // The reservations cannot exceed the pool capacity together
+    REQUIRE(0 == canardSetPoolQuota(&ins, CanardPoolCategoryTx, NumPoolBlocks / 2U, NumPoolBlocks));
+    REQUIRE(0 == canardSetPoolQuota(&ins, CanardPoolCategoryRxState, NumPoolBlocks / 2U, NumPoolBlocks));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardSetPoolQuota(&ins, CanardPoolCategoryRxPayload, 1, 1));
+    REQUIRE(0 == canardSetPoolQuota(&ins, CanardPoolCategoryRxState, NumPoolBlocks / 2U - 1U, NumPoolBlocks));
+    REQUIRE(0 == canardSetPoolQuota(&ins, CanardPoolCategoryRxPayload, 1, 1));
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+#include "test_helpers.hpp"
+#include "canard_internals.h"
+
+#if CANARD_ENABLE_RX_STATE_EVICTION
+
+static const size_t NumPoolBlocks = 8;
+
+static bool hasRxState(CanardInstance* ins, uint8_t source_node_id)
+{
+    // Same layout as the transfer descriptor in canard.c
+    const uint32_t transfer_descriptor = uint32_t(DataTypeID) | (uint32_t(CanardTransferTypeBroadcast) << 16U) |
+                                         (uint32_t(source_node_id) << 18U);
+    return findRxState(ins->rx_states, transfer_descriptor) != nullptr;
+}
+
+TEST_CASE("RxEviction, IdleStatesLeastRecentlyUsedFirst")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    unsigned num_received = 0;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, &num_received);
+
+    // Single frame transfers leave idle states that fill up the pool
+    for (uint8_t i = 0; i < NumPoolBlocks; i++)
+    {
+        REQUIRE(0 == receiveTransfer(&ins, uint8_t(30U + i), CANARD_TRANSFER_PRIORITY_LOW, 3, false, 1000U + i));
+    }
+    REQUIRE(NumPoolBlocks == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+
+    // The node that was heard from the longest ago makes room for a new one, even for a low priority transfer
+    REQUIRE(0 == receiveTransfer(&ins, 31, CANARD_TRANSFER_PRIORITY_LOW, 3, false, 2000));
+    REQUIRE(0 == receiveTransfer(&ins, 50, CANARD_TRANSFER_PRIORITY_LOWEST, 3, false, 2001));
+    REQUIRE(!hasRxState(&ins, 30));
+    REQUIRE(hasRxState(&ins, 31));
+    REQUIRE(hasRxState(&ins, 50));
+    REQUIRE(0 == receiveTransfer(&ins, 51, CANARD_TRANSFER_PRIORITY_LOWEST, 3, false, 2002));
+    REQUIRE(!hasRxState(&ins, 32));
+    REQUIRE(hasRxState(&ins, 31));
+    REQUIRE(NumPoolBlocks + 3U == num_received);
+
+    const CanardRxEvictionStatistics evictions = canardGetRxEvictionStatistics(&ins);
+    REQUIRE(2 == evictions.idle_states);
+    REQUIRE(0 == evictions.in_progress_states);
+}
+
+TEST_CASE("RxEviction, LowerPriorityReceptionsAreAborted")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    unsigned num_received = 0;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptTransfer, &num_received);
+
+    // Incomplete transfers take a state and a buffer block each, the pool is full afterwards
+    REQUIRE(0 == receiveTransfer(&ins, 30, CANARD_TRANSFER_PRIORITY_MEDIUM, 20, true, 1000));
+    REQUIRE(0 == receiveTransfer(&ins, 31, CANARD_TRANSFER_PRIORITY_LOW, 20, true, 1001));
+    REQUIRE(0 == receiveTransfer(&ins, 32, CANARD_TRANSFER_PRIORITY_LOW, 20, true, 1002));
+    REQUIRE(0 == receiveTransfer(&ins, 33, CANARD_TRANSFER_PRIORITY_MEDIUM, 20, true, 1003));
+    REQUIRE(NumPoolBlocks == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+
+    // Nothing has lower priority than these transfers
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == receiveTransfer(&ins, 40, CANARD_TRANSFER_PRIORITY_LOW, 3, false, 1004));
+    REQUIRE(0 == canardGetRxEvictionStatistics(&ins).in_progress_states);
+
+    // A high priority transfer aborts the oldest of the lowest priority receptions
+    REQUIRE(0 == receiveTransfer(&ins, 41, CANARD_TRANSFER_PRIORITY_HIGH, 3, false, 1005));
+    REQUIRE(1 == num_received);
+    REQUIRE(!hasRxState(&ins, 31));
+    REQUIRE(hasRxState(&ins, 32));
+    REQUIRE(hasRxState(&ins, 41));
+    REQUIRE(1 == canardGetRxEvictionStatistics(&ins).in_progress_states);
+
+    // The new idle state goes before any reception in progress
+    REQUIRE(0 == receiveTransfer(&ins, 42, CANARD_TRANSFER_PRIORITY_HIGH, 3, false, 1006));
+    REQUIRE(0 == receiveTransfer(&ins, 43, CANARD_TRANSFER_PRIORITY_HIGH, 3, false, 1007));
+    REQUIRE(!hasRxState(&ins, 41));
+    REQUIRE(hasRxState(&ins, 32));
+    REQUIRE(3 == num_received);
+
+    const CanardRxEvictionStatistics evictions = canardGetRxEvictionStatistics(&ins);
+    REQUIRE(1 == evictions.idle_states);
+    REQUIRE(1 == evictions.in_progress_states);
+}
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+#include <catch.hpp>
+#include <canard.h>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#if CANARD_ENABLE_RX_RING
+
+/**
+ * Every frame carries its sequence number in the first four bytes, the other fields are derived from it.
+ */
+static CanardCANFrame makeFrame(uint32_t sequence)
+{
+    CanardCANFrame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.id = CANARD_CAN_FRAME_EFF | (sequence & CANARD_CAN_EXT_ID_MASK);
+    frame.data_len = CANARD_CAN_FRAME_MAX_DATA_LEN;
+    std::memcpy(frame.data, &sequence, sizeof(sequence));
+    for (uint8_t i = sizeof(sequence); i < frame.data_len; i++)
+    {
+        frame.data[i] = uint8_t(sequence + i);
+    }
+    frame.iface_id = uint8_t(sequence % 3U);
+    return frame;
+}
+
+static uint32_t checkFrame(const CanardCANFrame& frame, uint64_t timestamp_usec)
+{
+    uint32_t sequence = 0;
+    std::memcpy(&sequence, frame.data, sizeof(sequence));
+    const CanardCANFrame reference = makeFrame(sequence);
+    REQUIRE(frame.id == reference.id);
+    REQUIRE(frame.data_len == reference.data_len);
+    REQUIRE(0 == std::memcmp(frame.data, reference.data, frame.data_len));
+    REQUIRE(frame.iface_id == reference.iface_id);
+    REQUIRE(timestamp_usec == 1000000ULL + sequence);
+    return sequence;
+}
+
+static unsigned g_num_received = 0;
+static uint8_t g_last_source_node_id = 0;
+
+static void onTransferReceived(CanardInstance*, CanardRxTransfer* transfer)
+{
+    g_num_received++;
+    g_last_source_node_id = transfer->source_node_id;
+}
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t* out_data_type_signature,
+                                 uint16_t,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    *out_data_type_signature = 0;
+    return true;
+}
+
+TEST_CASE("RxRing, PushPop")
+{
+    static CanardRxRing ring;
+    canardRxRingInit(&ring);
+
+    CanardCANFrame frame;
+    uint64_t timestamp_usec = 0;
+    REQUIRE(!canardRxRingPop(&ring, &frame, &timestamp_usec));
+
+    // The ring takes exactly its capacity, then the frames are dropped and counted
+    for (uint32_t i = 0; i < CANARD_RX_RING_CAPACITY; i++)
+    {
+        const CanardCANFrame pushed = makeFrame(i);
+        REQUIRE(canardRxRingPush(&ring, &pushed, 1000000ULL + i));
+    }
+    const CanardCANFrame extra = makeFrame(12345);
+    REQUIRE(!canardRxRingPush(&ring, &extra, 0));
+    REQUIRE(!canardRxRingPush(&ring, &extra, 0));
+    REQUIRE(2 == canardRxRingGetOverflowCount(&ring));
+
+    // The frames come out in order, and the freed entries can be reused; the indices wrap around many times
+    uint32_t next_pushed = CANARD_RX_RING_CAPACITY;
+    for (uint32_t i = 0; i < 70000U; i++)
+    {
+        REQUIRE(canardRxRingPop(&ring, &frame, &timestamp_usec));
+        REQUIRE(i == checkFrame(frame, timestamp_usec));
+        const CanardCANFrame pushed = makeFrame(next_pushed);
+        REQUIRE(canardRxRingPush(&ring, &pushed, 1000000ULL + next_pushed));
+        next_pushed++;
+    }
+    for (uint32_t i = 0; i < CANARD_RX_RING_CAPACITY; i++)
+    {
+        REQUIRE(canardRxRingPop(&ring, &frame, &timestamp_usec));
+        REQUIRE(70000U + i == checkFrame(frame, timestamp_usec));
+    }
+    REQUIRE(!canardRxRingPop(&ring, &frame, &timestamp_usec));
+    REQUIRE(2 == canardRxRingGetOverflowCount(&ring));
+}
+
+TEST_CASE("RxRing, Drain")
+{
+    uint8_t canard_memory_pool[1024];
+    CanardInstance canard;
+    canardInit(&canard, canard_memory_pool, sizeof(canard_memory_pool),
+               onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&canard, 20);
+
+    static CanardRxRing ring;
+    canardRxRingInit(&ring);
+
+    // Single frame broadcasts from nodes 1 to 5
+    for (uint8_t i = 1; i <= 5; i++)
+    {
+        CanardCANFrame frame;
+        std::memset(&frame, 0, sizeof(frame));
+        frame.id = CANARD_CAN_FRAME_EFF | (1000U << 8U) | i;
+        frame.data_len = 2;
+        frame.data[0] = i;
+        frame.data[1] = 0xC0;       // Start and end of transfer, transfer ID 0
+        REQUIRE(canardRxRingPush(&ring, &frame, 1000U * i));
+    }
+
+    g_num_received = 0;
+    REQUIRE(2 == canardRxRingDrain(&ring, &canard, 2));
+    REQUIRE(2 == g_num_received);
+    REQUIRE(2 == g_last_source_node_id);
+
+    REQUIRE(3 == canardRxRingDrain(&ring, &canard, 100));
+    REQUIRE(5 == g_num_received);
+    REQUIRE(5 == g_last_source_node_id);
+
+    REQUIRE(0 == canardRxRingDrain(&ring, &canard, 100));
+    REQUIRE(0 == canardRxRingGetOverflowCount(&ring));
+}
+
+TEST_CASE("RxRing, ConcurrentStress")
+{
+    static const uint32_t NumFrames = 2000000;
+
+    static CanardRxRing ring;
+    canardRxRingInit(&ring);
+
+    // The producer never waits, so some frames are dropped whenever the consumer falls behind
+    std::atomic<uint32_t> num_dropped(0);
+    std::atomic<bool> producer_done(false);
+    std::thread producer([&num_dropped, &producer_done]()
+    {
+        for (uint32_t i = 0; i < NumFrames; i++)
+        {
+            const CanardCANFrame frame = makeFrame(i);
+            if (!canardRxRingPush(&ring, &frame, 1000000ULL + i))
+            {
+                num_dropped++;
+            }
+        }
+        producer_done = true;
+    });
+
+    // Every frame must arrive intact and in order, the gaps are the dropped frames
+    uint32_t num_received = 0;
+    uint32_t expected_at_least = 0;
+    bool valid = true;
+    for (;;)
+    {
+        const bool done = producer_done;
+        CanardCANFrame frame;
+        uint64_t timestamp_usec = 0;
+        while (canardRxRingPop(&ring, &frame, &timestamp_usec))
+        {
+            uint32_t sequence = 0;
+            std::memcpy(&sequence, frame.data, sizeof(sequence));
+            const CanardCANFrame reference = makeFrame(sequence);
+            valid = valid &&
+                    (sequence >= expected_at_least) &&
+                    (frame.id == reference.id) &&
+                    (0 == std::memcmp(frame.data, reference.data, frame.data_len)) &&
+                    (frame.iface_id == reference.iface_id) &&
+                    (timestamp_usec == 1000000ULL + sequence);
+            expected_at_least = sequence + 1U;
+            num_received++;
+        }
+        if (done)
+        {
+            break;
+        }
+    }
+    producer.join();
+
+    REQUIRE(valid);
+    REQUIRE(num_received > 0);
+    REQUIRE(num_received + num_dropped == NumFrames);
+    REQUIRE(num_dropped == canardRxRingGetOverflowCount(&ring));
+}
+
+#endif
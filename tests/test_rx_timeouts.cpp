@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+#include "test_helpers.hpp"
+
+static const uint16_t FastDataTypeID = DataTypeID;
+static const uint16_t SlowDataTypeID = DataTypeID + 1U;
+static const uint32_t FastTransferTimeoutUsec = 50000;
+
+static bool shouldAcceptFastAndSlow(const CanardInstance*,
+                                    uint64_t* out_data_type_signature,
+                                    uint16_t data_type_id,
+                                    CanardTransferType,
+                                    uint8_t)
+{
+    *out_data_type_signature = DataTypeSignature;
+    return (data_type_id == FastDataTypeID) || (data_type_id == SlowDataTypeID);
+}
+
+static void getRxTimeouts(const CanardInstance*,
+                          uint16_t data_type_id,
+                          CanardTransferType transfer_type,
+                          CanardRxTimeouts* inout_timeouts)
+{
+    REQUIRE(transfer_type == CanardTransferTypeBroadcast);
+    if (data_type_id == FastDataTypeID)
+    {
+        inout_timeouts->transfer_timeout_usec = FastTransferTimeoutUsec;
+    }
+}
+
+/**
+ * Returns a single frame broadcast transfer from node 30.
+ */
+static CanardCANFrame makeFrame(uint16_t data_type_id, uint8_t transfer_id, uint8_t iface_id)
+{
+    CanardCANFrame frame = {};
+    frame.id = CANARD_CAN_FRAME_EFF | (uint32_t(CANARD_TRANSFER_PRIORITY_LOW) << 24U) |
+               (uint32_t(data_type_id) << 8U) | 30U;
+    frame.data[0] = 42;
+    frame.data[1] = uint8_t(0xC0U | (transfer_id & 31U));
+    frame.data_len = 2;
+    frame.iface_id = iface_id;
+    return frame;
+}
+
+TEST_CASE("RxTimeouts, InstanceDefaults")
+{
+    static uint64_t arena[(16U * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    unsigned num_received = 0;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptFastAndSlow, &num_received);
+
+    CanardCANFrame frame = makeFrame(SlowDataTypeID, 5, 0);
+    REQUIRE(0 == canardHandleRxFrame(&ins, &frame, 1000));
+    REQUIRE(1000U + CANARD_DEFAULT_TRANSFER_TIMEOUT_USEC + 1U == canardGetNextDeadline(&ins));
+
+    // A shorter timeout applies to the existing states as well
+    CanardRxTimeouts timeouts = {};
+    timeouts.transfer_timeout_usec = 100000;
+    timeouts.iface_switch_delay_usec = CANARD_DEFAULT_IFACE_SWITCH_DELAY_USEC;
+    canardSetRxTimeouts(&ins, timeouts, nullptr);
+    REQUIRE(101001U == canardGetNextDeadline(&ins));
+
+    // Another interface is accepted once the transfer has timed out, long before the interface switch delay
+    REQUIRE(1 == num_received);
+    frame = makeFrame(SlowDataTypeID, 6, 1);
+    REQUIRE(0 == canardHandleRxFrame(&ins, &frame, 101000));
+    REQUIRE(1 == num_received);
+    REQUIRE(0 == canardHandleRxFrame(&ins, &frame, 101001));
+    REQUIRE(2 == num_received);
+
+    canardCleanupStaleTransfers(&ins, 201001);
+    REQUIRE(1 == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+    canardCleanupStaleTransfers(&ins, 201002);
+    REQUIRE(0 == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+}
+
+TEST_CASE("RxTimeouts, PerSubscription")
+{
+    static uint64_t arena[(16U * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptFastAndSlow, nullptr);
+    CanardRxTimeouts timeouts = {};
+    timeouts.transfer_timeout_usec = CANARD_DEFAULT_TRANSFER_TIMEOUT_USEC;
+    timeouts.iface_switch_delay_usec = CANARD_DEFAULT_IFACE_SWITCH_DELAY_USEC;
+    canardSetRxTimeouts(&ins, timeouts, getRxTimeouts);
+
+    CanardCANFrame fast = makeFrame(FastDataTypeID, 0, 0);
+    CanardCANFrame slow = makeFrame(SlowDataTypeID, 0, 0);
+    REQUIRE(0 == canardHandleRxFrame(&ins, &slow, 1000));
+    REQUIRE(0 == canardHandleRxFrame(&ins, &fast, 2000));
+    REQUIRE(2000U + FastTransferTimeoutUsec + 1U == canardGetNextDeadline(&ins));
+
+    // Only the state of the fast subscription is removed
+    canardCleanupStaleTransfers(&ins, 2000U + FastTransferTimeoutUsec + 1U);
+    REQUIRE(1 == canardGetPoolAllocatorStatistics(&ins).current_usage_blocks);
+    REQUIRE(1000U + CANARD_DEFAULT_TRANSFER_TIMEOUT_USEC + 1U == canardGetNextDeadline(&ins));
+}
+
+TEST_CASE("RxTimeouts, IfaceSwitchDelay")
+{
+    static uint64_t arena[(16U * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardInstance ins;
+    unsigned num_received = 0;
+    canardInit(&ins, arena, sizeof(arena), onTransferReceived, shouldAcceptFastAndSlow, &num_received);
+    CanardRxTimeouts timeouts = {};
+    timeouts.transfer_timeout_usec = CANARD_DEFAULT_TRANSFER_TIMEOUT_USEC;
+    timeouts.iface_switch_delay_usec = 20000;
+    canardSetRxTimeouts(&ins, timeouts, nullptr);
+
+    CanardCANFrame frame = makeFrame(SlowDataTypeID, 0, 0);
+    REQUIRE(0 == canardHandleRxFrame(&ins, &frame, 1000));
+    REQUIRE(1 == num_received);
+
+    // The redundant interface is ignored until the delay has passed
+    frame = makeFrame(SlowDataTypeID, 1, 1);
+    REQUIRE(0 == canardHandleRxFrame(&ins, &frame, 21000));
+    REQUIRE(1 == num_received);
+    frame = makeFrame(SlowDataTypeID, 2, 1);
+    REQUIRE(0 == canardHandleRxFrame(&ins, &frame, 21001));
+    REQUIRE(2 == num_received);
+}
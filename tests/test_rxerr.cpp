@@ -292,11 +292,11 @@ TEST_CASE("canardHandleRxFrame missed start handling, Correctness")
     err = canardHandleRxFrame(&canard, &frame, 4000000);
     REQUIRE(-CANARD_ERROR_RX_MISSED_START == err);
 
-    //Send a start packet, should pass
+    //Send a start packet after the timeout, should pass
     frame.data[7] = CONSTRUCT_TAIL_BYTE(1, 0, 0, 1);
     frame.id = CONSTRUCT_SVC_ID(0, 0, 1, 20, 0);
     frame.data_len = 8;                             //Data length MUST be full packet
-    err = canardHandleRxFrame(&canard, &frame, 1);
+    err = canardHandleRxFrame(&canard, &frame, 4000001);
     REQUIRE(CANARD_OK == err);
 
     //Send a middle packet, toggle, and use correct ID - but timestamp 0
@@ -306,11 +306,11 @@ TEST_CASE("canardHandleRxFrame missed start handling, Correctness")
     err = canardHandleRxFrame(&canard, &frame, 0);
     REQUIRE(-CANARD_ERROR_RX_MISSED_START == err);
 
-    //Send a start packet, should pass
+    //Send a start packet after the timeout, should pass
     frame.data[7] = CONSTRUCT_TAIL_BYTE(1, 0, 0, 1);
     frame.id = CONSTRUCT_SVC_ID(0, 0, 1, 20, 0);
     frame.data_len = 8;                             //Data length MUST be full packet
-    err = canardHandleRxFrame(&canard, &frame, 1);
+    err = canardHandleRxFrame(&canard, &frame, 8000002);
     REQUIRE(CANARD_OK == err);
 
     //Send a middle packet, toggle, and use an incorrect TID
@@ -372,3 +372,46 @@ TEST_CASE("canardHandleRxFrame OOM handling, Correctness")
     err = canardHandleRxFrame(&canard, &frame, 1);
     REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == err);
 }
+
+TEST_CASE("canardGetNextDeadline stale state handling, Correctness")
+{
+    uint8_t canard_memory_pool[1024];
+    CanardInstance canard;
+    CanardCANFrame frame;
+
+    g_should_accept = true;
+
+    canardInit(&canard, canard_memory_pool, sizeof(canard_memory_pool),
+               onTransferReceived, shouldAcceptTransfer, &canard);
+    canardSetLocalNodeID(&canard, 20);
+
+    //No states, nothing to wait for
+    REQUIRE(UINT64_MAX == canardGetNextDeadline(&canard));
+
+    //Every source creates a state that expires 2 seconds after its last update
+    frame.data[0] = CONSTRUCT_TAIL_BYTE(1, 1, 0, 0);
+    frame.id = CONSTRUCT_MSG_ID(0, 1000, 42);
+    frame.data_len = 1;
+    REQUIRE(CANARD_OK == canardHandleRxFrame(&canard, &frame, 5000000));
+    REQUIRE(7000001 == canardGetNextDeadline(&canard));
+
+    frame.id = CONSTRUCT_MSG_ID(0, 1000, 43);
+    REQUIRE(CANARD_OK == canardHandleRxFrame(&canard, &frame, 6000000));
+    REQUIRE(7000001 == canardGetNextDeadline(&canard));
+
+    //Updating the older state postpones the deadline
+    frame.data[0] = CONSTRUCT_TAIL_BYTE(1, 1, 0, 1);
+    frame.id = CONSTRUCT_MSG_ID(0, 1000, 42);
+    REQUIRE(CANARD_OK == canardHandleRxFrame(&canard, &frame, 6500000));
+    REQUIRE(8000001 == canardGetNextDeadline(&canard));
+
+    //Nothing is removed before the deadline
+    canardCleanupStaleTransfers(&canard, 8000000);
+    REQUIRE(8000001 == canardGetNextDeadline(&canard));
+
+    //The states are removed one by one at their deadlines
+    canardCleanupStaleTransfers(&canard, 8000001);
+    REQUIRE(8500001 == canardGetNextDeadline(&canard));
+    canardCleanupStaleTransfers(&canard, 8500001);
+    REQUIRE(UINT64_MAX == canardGetNextDeadline(&canard));
+}
@@ -126,7 +126,7 @@ TEST_CASE("ScalarDecode, MultiFrame")
     {
         x = 0b10100101;
     }
-    static_assert(CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE == 6, "Assumption is not met, are we on a 32-bit x86 machine?");
+    static_assert(CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE < 8, "The first 64 bits must span the head and the middle");
 
     auto middle_a = createBufferBlock(&allocator);
     auto middle_b = createBufferBlock(&allocator);
@@ -164,8 +164,13 @@ TEST_CASE("ScalarDecode, MultiFrame")
     REQUIRE_FALSE(read<bool>(&transfer, CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8, 1));
     REQUIRE(read<bool>(&transfer, CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE * 8 + 1, 1));
 
-    // 64 from beginning, 48 bits from head, 16 bits from the middle
-    REQUIRE(0b0101101001011010101001011010010110100101101001011010010110100101ULL == read<uint64_t>(&transfer, 0, 64));
+    // 64 from beginning, the whole head and the rest from the middle
+    uint64_t first_64 = 0;
+    for (unsigned i = 0; i < 8; i++)
+    {
+        first_64 |= uint64_t((i < CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE) ? 0b10100101U : 0b01011010U) << (i * 8U);
+    }
+    REQUIRE(first_64 == read<uint64_t>(&transfer, 0, 64));
 
     // 64 from two middle blocks, 32 from the first, 32 from the second
     REQUIRE(0b1100110011001100110011001100110001011010010110100101101001011010ULL ==
@@ -188,6 +193,139 @@ TEST_CASE("ScalarDecode, MultiFrame")
 }
 
 
+TEST_CASE("ByteArrayDecode, SingleFrame")
+{
+    auto transfer = CanardRxTransfer();
+
+    uint8_t buf[16];
+    for (uint8_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = uint8_t(i * 17U);
+    }
+    transfer.payload_head = &buf[0];
+    transfer.payload_len = sizeof(buf);
+
+    uint8_t arena[8];
+    uint8_t* arena_ptr = &arena[0];
+    uint8_t* data = nullptr;
+
+    // Aligned, zero copy - no arena memory is used
+    REQUIRE(5 * 8 == canardDecodeByteArray(&transfer, 16, 5, true, &data, &arena_ptr, &arena[sizeof(arena)]));
+    REQUIRE(data == &buf[2]);
+    REQUIRE(arena_ptr == &arena[0]);
+
+    // Aligned, copy
+    REQUIRE(5 * 8 == canardDecodeByteArray(&transfer, 16, 5, false, &data, &arena_ptr, &arena[sizeof(arena)]));
+    REQUIRE(data == &arena[0]);
+    REQUIRE(arena_ptr == &arena[5]);
+    REQUIRE(std::equal(&buf[2], &buf[7], data));
+
+    // Unaligned, copy even if zero copy is requested
+    arena_ptr = &arena[0];
+    REQUIRE(3 * 8 == canardDecodeByteArray(&transfer, 13, 3, true, &data, &arena_ptr, &arena[sizeof(arena)]));
+    REQUIRE(data == &arena[0]);
+    REQUIRE(arena_ptr == &arena[3]);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        REQUIRE(read<uint8_t>(&transfer, 13U + i * 8U, 8) == data[i]);
+    }
+
+    // Arena overflow
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY ==
+            canardDecodeByteArray(&transfer, 13, 6, true, &data, &arena_ptr, &arena[sizeof(arena)]));
+    REQUIRE(arena_ptr == &arena[3]);
+
+    // Out of range
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardDecodeByteArray(&transfer, 72, 8, true, &data, &arena_ptr, &arena[sizeof(arena)]));
+
+    // Nothing to copy into
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardDecodeByteArray(&transfer, 13, 2, true, &data, nullptr, nullptr));
+}
+
+
+TEST_CASE("ByteArrayDecode, MultiFrame")
+{
+    CanardPoolAllocatorBlock allocator_blocks[2];
+    CanardPoolAllocator allocator;
+    initPoolAllocator(&allocator, &allocator_blocks[0], 2);
+
+    /*
+     * The payload is a sequence of incrementing bytes spread over the head, two blocks, and the tail
+     */
+    auto transfer = CanardRxTransfer();
+
+    uint16_t counter = 0;
+    uint8_t head[CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE];
+    for (auto& x : head)
+    {
+        x = uint8_t(counter++);
+    }
+
+    auto middle_a = createBufferBlock(&allocator);
+    auto middle_b = createBufferBlock(&allocator);
+    for (unsigned i = 0; i < CANARD_BUFFER_BLOCK_DATA_SIZE; i++)
+    {
+        middle_a->data[i] = uint8_t(counter++);
+    }
+    for (unsigned i = 0; i < CANARD_BUFFER_BLOCK_DATA_SIZE; i++)
+    {
+        middle_b->data[i] = uint8_t(counter++);
+    }
+    middle_a->next = middle_b;
+    middle_b->next = nullptr;
+
+    uint8_t tail[4];
+    for (auto& x : tail)
+    {
+        x = uint8_t(counter++);
+    }
+
+    transfer.payload_head   = &head[0];
+    transfer.payload_middle = middle_a;
+    transfer.payload_tail   = &tail[0];
+    transfer.payload_len    = counter;
+
+    uint8_t arena[CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE + CANARD_BUFFER_BLOCK_DATA_SIZE * 2 + sizeof(tail)];
+    uint8_t* arena_ptr = &arena[0];
+    uint8_t* data = nullptr;
+
+    // Views into every segment
+    REQUIRE(8 == canardDecodeByteArray(&transfer, 8, 1, true, &data, &arena_ptr, nullptr));
+    REQUIRE(data == &head[1]);
+    REQUIRE(16 == canardDecodeByteArray(&transfer, (CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE + 1U) * 8U, 2, true,
+                                        &data, &arena_ptr, nullptr));
+    REQUIRE(data == &middle_a->data[1]);
+    REQUIRE(CANARD_BUFFER_BLOCK_DATA_SIZE * 8 ==
+            canardDecodeByteArray(&transfer, (CANARD_MULTIFRAME_RX_PAYLOAD_HEAD_SIZE + CANARD_BUFFER_BLOCK_DATA_SIZE) * 8U,
+                                  CANARD_BUFFER_BLOCK_DATA_SIZE, true, &data, &arena_ptr, nullptr));
+    REQUIRE(data == &middle_b->data[0]);
+    REQUIRE(32 == canardDecodeByteArray(&transfer, (transfer.payload_len - 4U) * 8U, 4, true,
+                                        &data, &arena_ptr, nullptr));
+    REQUIRE(data == &tail[0]);
+    REQUIRE(arena_ptr == &arena[0]);
+
+    // Aligned, spanning all segments
+    REQUIRE(transfer.payload_len * 8 ==
+            canardDecodeByteArray(&transfer, 0, transfer.payload_len, true, &data, &arena_ptr, &arena[sizeof(arena)]));
+    REQUIRE(data == &arena[0]);
+    for (uint16_t i = 0; i < transfer.payload_len; i++)
+    {
+        REQUIRE(uint8_t(i) == data[i]);
+    }
+
+    // Unaligned, spanning all segments
+    arena_ptr = &arena[0];
+    const uint16_t len = uint16_t(transfer.payload_len - 1U);
+    REQUIRE(len * 8 == canardDecodeByteArray(&transfer, 3, len, true, &data, &arena_ptr, &arena[sizeof(arena)]));
+    REQUIRE(arena_ptr == &arena[len]);
+    for (uint16_t i = 0; i < len; i++)
+    {
+        REQUIRE(read<uint8_t>(&transfer, 3U + i * 8U, 8) == data[i]);
+    }
+}
+
+
 TEST_CASE("ScalarEncode, Basic")
 {
     uint8_t buffer[32];
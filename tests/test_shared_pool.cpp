@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+#include "test_helpers.hpp"
+
+#if CANARD_ENABLE_SHARED_POOL
+
+static const size_t NumPoolBlocks = 32;
+
+/**
+ * Enqueues single frame transfers until the instance runs out of memory; returns their number.
+ */
+static unsigned fillTxQueue(CanardInstance* ins)
+{
+    const uint8_t payload[7] = {};
+    uint8_t transfer_id = 0;
+    unsigned count = 0;
+    for (;;)
+    {
+        const int16_t res = canardBroadcast(ins, DataTypeSignature, DataTypeID, &transfer_id,
+                                            CANARD_TRANSFER_PRIORITY_LOW, payload, sizeof(payload));
+        if (res < 0)
+        {
+            REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY == res);
+            return count;
+        }
+        count++;
+    }
+}
+
+static void flushTxQueue(CanardInstance* ins)
+{
+    while (canardPeekTxQueue(ins) != nullptr)
+    {
+        canardPopTxQueue(ins);
+    }
+}
+
+TEST_CASE("SharedPool, InstancesShareTheBlocks")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardSharedPool pool;
+    canardInitSharedPool(&pool, arena, sizeof(arena));
+    REQUIRE(NumPoolBlocks == canardGetSharedPoolStatistics(&pool).capacity_blocks);
+
+    CanardInstance a;
+    CanardInstance b;
+    canardInit(&a, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardInit(&b, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+    REQUIRE(0 == canardAttachSharedPool(&a, &pool, CANARD_POOL_MAX_BLOCKS));
+    REQUIRE(0 == canardAttachSharedPool(&b, &pool, CANARD_POOL_MAX_BLOCKS));
+    canardSetLocalNodeID(&a, 10);
+    canardSetLocalNodeID(&b, 11);
+    REQUIRE(NumPoolBlocks == canardGetPoolAllocatorStatistics(&a).capacity_blocks);
+
+    // The peaks of the instances take turns, each can use the whole pool
+    REQUIRE(NumPoolBlocks == fillTxQueue(&a));
+    REQUIRE(0 == fillTxQueue(&b));
+    flushTxQueue(&a);
+    REQUIRE(NumPoolBlocks == fillTxQueue(&b));
+    flushTxQueue(&b);
+
+    // Both at once
+    const uint8_t payload[20] = {};
+    uint8_t transfer_id = 0;
+    REQUIRE(3 == canardBroadcast(&a, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, 13));
+    REQUIRE(4 == canardBroadcast(&b, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, sizeof(payload)));
+
+    const CanardPoolAllocatorStatistics stats_a = canardGetPoolAllocatorStatistics(&a);
+    const CanardPoolAllocatorStatistics stats_b = canardGetPoolAllocatorStatistics(&b);
+    const CanardPoolAllocatorStatistics stats = canardGetSharedPoolStatistics(&pool);
+    REQUIRE(3 == stats_a.current_usage_blocks);
+    REQUIRE(NumPoolBlocks == stats_a.peak_usage_blocks);
+    REQUIRE(4 == stats_b.current_usage_blocks);
+    REQUIRE(NumPoolBlocks == stats_b.peak_usage_blocks);
+    REQUIRE(7 == stats.current_usage_blocks);
+    REQUIRE(NumPoolBlocks == stats.peak_usage_blocks);
+
+    flushTxQueue(&a);
+    flushTxQueue(&b);
+    REQUIRE(0 == canardGetSharedPoolStatistics(&pool).current_usage_blocks);
+}
+
+TEST_CASE("SharedPool, PerInstanceCap")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardSharedPool pool;
+    canardInitSharedPool(&pool, arena, sizeof(arena));
+
+    CanardInstance capped;
+    CanardInstance uncapped;
+    canardInit(&capped, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardInit(&uncapped, nullptr, 0, onTransferReceived, shouldAcceptTransfer, nullptr);
+    REQUIRE(0 == canardAttachSharedPool(&capped, &pool, 10));
+    REQUIRE(0 == canardAttachSharedPool(&uncapped, &pool, CANARD_POOL_MAX_BLOCKS));
+    canardSetLocalNodeID(&capped, 10);
+    canardSetLocalNodeID(&uncapped, 11);
+    REQUIRE(10 == canardGetPoolAllocatorStatistics(&capped).capacity_blocks);
+
+    // A flooded bus cannot take more than its cap, the rest of the pool is left to the others
+    REQUIRE(10 == fillTxQueue(&capped));
+    REQUIRE(NumPoolBlocks - 10U == fillTxQueue(&uncapped));
+#if CANARD_ENABLE_POOL_QUOTAS
+    REQUIRE(1 == canardGetPoolAllocatorStatistics(&capped).categories[CanardPoolCategoryTx].failed_allocations);
+#endif
+
+    flushTxQueue(&uncapped);
+    REQUIRE(0 == fillTxQueue(&capped));
+    flushTxQueue(&capped);
+    REQUIRE(0 == canardGetSharedPoolStatistics(&pool).current_usage_blocks);
+}
+
+TEST_CASE("SharedPool, AttachBeforeUse")
+{
+    static uint64_t arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    static uint64_t own_arena[(NumPoolBlocks * CANARD_MEM_BLOCK_SIZE) / 8U];
+    CanardSharedPool pool;
+    canardInitSharedPool(&pool, arena, sizeof(arena));
+
+    CanardInstance ins;
+    canardInit(&ins, own_arena, sizeof(own_arena), onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&ins, 10);
+    const uint8_t payload[7] = {};
+    uint8_t transfer_id = 0;
+    REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, sizeof(payload)));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT == canardAttachSharedPool(&ins, &pool, CANARD_POOL_MAX_BLOCKS));
+
+    flushTxQueue(&ins);
+    REQUIRE(0 == canardAttachSharedPool(&ins, &pool, CANARD_POOL_MAX_BLOCKS));
+    REQUIRE(1 == canardBroadcast(&ins, DataTypeSignature, DataTypeID, &transfer_id, CANARD_TRANSFER_PRIORITY_LOW,
+                                 payload, sizeof(payload)));
+    REQUIRE(1 == canardGetSharedPoolStatistics(&pool).current_usage_blocks);
+    flushTxQueue(&ins);
+}
+
+#endif
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2018 UAVCAN Team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Contributors: https://github.com/UAVCAN/libcanard/contributors
+ */
+
+
+#include <catch.hpp>
+#include <canard.h>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if CANARD_ENABLE_TX_STAGING
+
+static void onTransferReceived(CanardInstance*, CanardRxTransfer*) { }
+
+static bool shouldAcceptTransfer(const CanardInstance*,
+                                 uint64_t*,
+                                 uint16_t,
+                                 CanardTransferType,
+                                 uint8_t)
+{
+    return false;
+}
+
+/**
+ * Pops a single frame transfer from the TX queue, returning its payload length, or -1 if the queue is empty.
+ */
+static int popSingleFrameTransfer(CanardInstance* ins, uint32_t* out_id, uint8_t* out_payload, uint8_t* out_tail)
+{
+    const CanardCANFrame* const frame = canardPeekTxQueue(ins);
+    if (frame == nullptr)
+    {
+        return -1;
+    }
+    REQUIRE(frame->data_len > 0);
+    const int payload_len = frame->data_len - 1;
+    *out_id = frame->id;
+    std::memcpy(out_payload, frame->data, size_t(payload_len));
+    *out_tail = frame->data[payload_len];
+    canardPopTxQueue(ins);
+    return payload_len;
+}
+
+TEST_CASE("TxStaging, StageDrain")
+{
+    uint8_t canard_memory_pool[2048];
+    CanardInstance canard;
+    canardInit(&canard, canard_memory_pool, sizeof(canard_memory_pool),
+               onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&canard, 20);
+
+    static CanardTxStaging staging;
+    canardTxStagingInit(&staging);
+    REQUIRE(0 == canardTxStagingDrain(&staging, &canard, 100));
+
+    // Staging does not touch the instance, the transfer IDs are assigned right away
+    uint8_t message_tid = 31;
+    uint8_t request_tid = 5;
+    uint8_t response_tid = 9;
+    const uint8_t payload[3] = {1, 2, 3};
+    REQUIRE(0 == canardTxStagingBroadcast(&staging, 0, 1000, &message_tid, CANARD_TRANSFER_PRIORITY_LOW,
+                                          payload, sizeof(payload)));
+    REQUIRE(0 == message_tid);
+    REQUIRE(0 == canardTxStagingRequestOrRespond(&staging, 42, 0, 30, &request_tid, CANARD_TRANSFER_PRIORITY_LOW,
+                                                 CanardRequest, payload, 1));
+    REQUIRE(6 == request_tid);
+    REQUIRE(0 == canardTxStagingRequestOrRespond(&staging, 43, 0, 31, &response_tid, CANARD_TRANSFER_PRIORITY_LOW,
+                                                 CanardResponse, nullptr, 0));
+    REQUIRE(9 == response_tid);
+    REQUIRE(nullptr == canardPeekTxQueue(&canard));
+
+    // Invalid arguments are rejected without taking a slot
+    static const uint8_t big_payload[CANARD_TX_STAGING_MAX_PAYLOAD_SIZE + 1] = {};
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardTxStagingBroadcast(&staging, 0, 1000, &message_tid, CANARD_TRANSFER_PRIORITY_LOW,
+                                     big_payload, sizeof(big_payload)));
+    REQUIRE(-CANARD_ERROR_INVALID_ARGUMENT ==
+            canardTxStagingRequestOrRespond(&staging, CANARD_BROADCAST_NODE_ID, 0, 30, &request_tid,
+                                            CANARD_TRANSFER_PRIORITY_LOW, CanardRequest, payload, 1));
+    REQUIRE(0 == message_tid);
+    REQUIRE(6 == request_tid);
+
+    // Draining is limited, the transfers keep their staging order and transfer IDs
+    REQUIRE(2 == canardTxStagingDrain(&staging, &canard, 2));
+    uint32_t id = 0;
+    uint8_t data[CANARD_CAN_FRAME_MAX_DATA_LEN];
+    uint8_t tail = 0;
+    REQUIRE(3 == popSingleFrameTransfer(&canard, &id, data, &tail));
+    REQUIRE(id == (CANARD_CAN_FRAME_EFF | (uint32_t(CANARD_TRANSFER_PRIORITY_LOW) << 24U) | (1000U << 8U) | 20U));
+    REQUIRE(0 == std::memcmp(data, payload, sizeof(payload)));
+    REQUIRE(tail == (0xC0U | 31U));
+    REQUIRE(1 == popSingleFrameTransfer(&canard, &id, data, &tail));
+    REQUIRE(id == (CANARD_CAN_FRAME_EFF | (uint32_t(CANARD_TRANSFER_PRIORITY_LOW) << 24U) | (30U << 16U) |
+                   (1U << 15U) | (42U << 8U) | (1U << 7U) | 20U));
+    REQUIRE(tail == (0xC0U | 5U));
+    REQUIRE(-1 == popSingleFrameTransfer(&canard, &id, data, &tail));
+
+    REQUIRE(1 == canardTxStagingDrain(&staging, &canard, 100));
+    REQUIRE(0 == popSingleFrameTransfer(&canard, &id, data, &tail));
+    REQUIRE(id == (CANARD_CAN_FRAME_EFF | (uint32_t(CANARD_TRANSFER_PRIORITY_LOW) << 24U) | (31U << 16U) |
+                   (43U << 8U) | (1U << 7U) | 20U));
+    REQUIRE(tail == (0xC0U | 9U));
+
+    // The queue takes exactly its capacity, then the transfers are rejected and counted
+    for (uint32_t i = 0; i < CANARD_TX_STAGING_CAPACITY; i++)
+    {
+        REQUIRE(0 == canardTxStagingBroadcast(&staging, 0, 1000, &message_tid, CANARD_TRANSFER_PRIORITY_LOW,
+                                              payload, 1));
+    }
+    REQUIRE(-CANARD_ERROR_OUT_OF_MEMORY ==
+            canardTxStagingBroadcast(&staging, 0, 1000, &message_tid, CANARD_TRANSFER_PRIORITY_LOW, payload, 1));
+    REQUIRE(1 == canardTxStagingGetOverflowCount(&staging));
+    REQUIRE(int(CANARD_TX_STAGING_CAPACITY) == canardTxStagingDrain(&staging, &canard, 1000));
+    while (popSingleFrameTransfer(&canard, &id, data, &tail) >= 0) { }
+
+    // An error of the library drops the failing transfer only
+    canard.node_id = CANARD_BROADCAST_NODE_ID;
+    REQUIRE(0 == canardTxStagingBroadcast(&staging, 0, 1, &message_tid, CANARD_TRANSFER_PRIORITY_LOW, payload, 1));
+    REQUIRE(0 == canardTxStagingBroadcast(&staging, 0, 1, &message_tid, CANARD_TRANSFER_PRIORITY_LOW,
+                                          big_payload, 8));
+    REQUIRE(0 == canardTxStagingBroadcast(&staging, 0, 1, &message_tid, CANARD_TRANSFER_PRIORITY_LOW, payload, 2));
+    REQUIRE(-CANARD_ERROR_NODE_ID_NOT_SET == canardTxStagingDrain(&staging, &canard, 100));
+    REQUIRE(1 == canardTxStagingDrain(&staging, &canard, 100));
+    // Anonymous transfers are ordered by their random discriminators
+    const int first_len = popSingleFrameTransfer(&canard, &id, data, &tail);
+    const int second_len = popSingleFrameTransfer(&canard, &id, data, &tail);
+    REQUIRE(3 == first_len + second_len);
+    REQUIRE(-1 == popSingleFrameTransfer(&canard, &id, data, &tail));
+}
+
+TEST_CASE("TxStaging, ConcurrentProducers")
+{
+    static const unsigned NumProducers = 4;
+    static const uint32_t NumTransfersPerProducer = 50000;
+
+    static uint8_t canard_memory_pool[4096];
+    CanardInstance canard;
+    canardInit(&canard, canard_memory_pool, sizeof(canard_memory_pool),
+               onTransferReceived, shouldAcceptTransfer, nullptr);
+    canardSetLocalNodeID(&canard, 20);
+
+    static CanardTxStaging staging;
+    canardTxStagingInit(&staging);
+
+    // Every producer publishes its own data type, with a running counter as the payload; it retries when full
+    std::atomic<unsigned> num_producers_done(0);
+    std::vector<std::thread> producers;
+    for (unsigned p = 0; p < NumProducers; p++)
+    {
+        producers.emplace_back([p, &num_producers_done]()
+        {
+            uint8_t transfer_id = 0;
+            for (uint32_t i = 0; i < NumTransfersPerProducer; i++)
+            {
+                while (canardTxStagingBroadcast(&staging, 0, uint16_t(100U + p), &transfer_id,
+                                                CANARD_TRANSFER_PRIORITY_LOW, &i, sizeof(i)) < 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            num_producers_done++;
+        });
+    }
+
+    // The transfers of every producer must arrive intact and in order
+    uint32_t next_counter[NumProducers] = {};
+    uint32_t num_received = 0;
+    bool valid = true;
+    for (;;)
+    {
+        const bool done = (num_producers_done == NumProducers);
+        int16_t res = 0;
+        while ((res = canardTxStagingDrain(&staging, &canard, 16)) > 0)
+        {
+            uint32_t id = 0;
+            uint8_t data[CANARD_CAN_FRAME_MAX_DATA_LEN];
+            uint8_t tail = 0;
+            int len = 0;
+            while ((len = popSingleFrameTransfer(&canard, &id, data, &tail)) >= 0)
+            {
+                const unsigned p = ((id >> 8U) & 0xFFFFU) - 100U;
+                uint32_t counter = 0;
+                std::memcpy(&counter, data, sizeof(counter));
+                valid = valid &&
+                        (len == int(sizeof(counter))) &&
+                        (p < NumProducers) &&
+                        (counter == next_counter[p]) &&
+                        (tail == (0xC0U | (counter & 31U)));
+                if (p < NumProducers)
+                {
+                    next_counter[p]++;
+                }
+                num_received++;
+            }
+        }
+        valid = valid && (res == 0);
+        if (done)
+        {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+
+    REQUIRE(valid);
+    REQUIRE(num_received == NumProducers * NumTransfersPerProducer);
+}
+
+#endif